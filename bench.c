@@ -31,6 +31,17 @@
     #include <time.h>
 #endif
 
+#if defined(__linux__)
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+#if defined(__x86_64__)
+    #include <cpuid.h>
+#endif
+
 #include "bench.h"
 
 /* Get CPU cycles */
@@ -50,9 +61,12 @@ unsigned long long cpucycles(void)
     return clock_cycles;
 
 #elif defined(__aarch64__)
+    // The virtual counter (at a fixed frequency), since PMCCNTR_EL0 traps 
+    // unless the kernel enables it. The core cycles are counted by the
+    // counters of bench_init instead.
     unsigned long long cycles;
     __asm__ __volatile__(
-        "mrs %0, PMCCNTR_EL0"
+        "mrs %0, CNTVCT_EL0"
         : "=r"(cycles));
     return cycles;
 
@@ -61,6 +75,235 @@ unsigned long long cpucycles(void)
 #endif
 }
 
+/******************************************************************
+ * Hardware Counters
+ *
+ * A group of perf_event counters of the calling thread (in user 
+ * mode), led by the core cycles: the samples of BENCHFUNC are the 
+ * core cycles, read by rdpmc from the mapping of the leader (x86), 
+ * or by a read of the leader otherwise, and the group is read at 
+ * the start and the stop of a run for the averages of the counters.
+ * Without the counters (e.g. perf_event_paranoid, a virtual machine, 
+ * or POLYINV_PERF=0 in the environment), the samples are cpucycles().
+ ******************************************************************/
+
+static const char *counter_names[BENCH_NUM_COUNTERS] = {
+    "cycles", "instructions", "L1D misses", "L2 misses", "branch misses"
+};
+
+#if defined(__linux__)
+
+// Raw event of the L2 misses of the host, or 0 if unknown
+static unsigned long long l2_miss_event(void) {
+#if defined(__x86_64__)
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid(0, &eax, &ebx, &ecx, &edx)) {
+        if (ebx == 0x756e6547 && edx == 0x49656e69 && ecx == 0x6c65746e) {
+            return 0x3f24;      // GenuineIntel: L2_RQSTS.MISS
+        }
+        if (ebx == 0x68747541 && edx == 0x69746e65 && ecx == 0x444d4163) {
+            return 0x0964;      // AuthenticAMD: L2_CACHE_REQ_STAT.IC_DC_MISS_IN_L2
+        }
+    }
+    return 0;
+#elif defined(__aarch64__)
+    return 0x17;                // L2D_CACHE_REFILL
+#else
+    return 0;
+#endif
+}
+
+static int counter_open(int counter, int leader) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID |
+                       PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    switch (counter) {
+    case BENCH_CYCLES:
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+    case BENCH_INSTRUCTIONS:
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+    case BENCH_L1D_MISSES:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        break;
+    case BENCH_L2_MISSES:
+        attr.type = PERF_TYPE_RAW;
+        attr.config = l2_miss_event();
+        if (attr.config == 0) return -1;
+        break;
+    case BENCH_BRANCH_MISSES:
+        attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+        break;
+    }
+    return (int) syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+}
+
+// The counters of the group (and their times): values[counter], 
+// values[BENCH_NUM_COUNTERS] = enabled and values[BENCH_NUM_COUNTERS + 1] = running
+static int counters_read(counters_t *c, unsigned long long *values) {
+    uint64_t buf[3 + 2 * BENCH_NUM_COUNTERS];
+    if (read(c->fd[BENCH_CYCLES], buf, sizeof(buf)) < (ssize_t) (3 * sizeof(uint64_t))) {
+        return 0;
+    }
+    // { nr, time_enabled, time_running, { value, id }[nr] }
+    for (int k = 0; k < BENCH_NUM_COUNTERS; k++) {
+        values[k] = 0;
+        for (uint64_t j = 0; j < buf[0] && c->fd[k] >= 0; j++) {
+            if (buf[4 + 2 * j] == c->id[k]) values[k] = buf[3 + 2 * j];
+        }
+    }
+    values[BENCH_NUM_COUNTERS] = buf[1];
+    values[BENCH_NUM_COUNTERS + 1] = buf[2];
+    return 1;
+}
+
+#endif
+
+static void counters_close(counters_t *c) {
+#if defined(__linux__)
+    if (c->page != NULL) {
+        munmap(c->page, sysconf(_SC_PAGESIZE));
+    }
+    for (int k = 0; k < BENCH_NUM_COUNTERS; k++) {
+        if (c->fd[k] >= 0) close(c->fd[k]);
+    }
+#endif
+    for (int k = 0; k < BENCH_NUM_COUNTERS; k++) {
+        c->fd[k] = -1;
+        c->per_call[k] = -1;
+    }
+    c->page = NULL;
+    c->num = 0;
+}
+
+static void counters_open(counters_t *c) {
+    counters_close(c);
+
+#if defined(__linux__)
+    const char *env = getenv("POLYINV_PERF");
+    if (env != NULL && strcmp(env, "0") == 0) {
+        return;
+    }
+
+    // The leader, and the other counters which the host has
+    c->fd[BENCH_CYCLES] = counter_open(BENCH_CYCLES, -1);
+    if (c->fd[BENCH_CYCLES] < 0) {
+        return;
+    }
+    for (int k = 0; k < BENCH_NUM_COUNTERS; k++) {
+        if (k != BENCH_CYCLES) {
+            c->fd[k] = counter_open(k, c->fd[BENCH_CYCLES]);
+        }
+        if (c->fd[k] >= 0) {
+            uint64_t id = 0;
+            ioctl(c->fd[k], PERF_EVENT_IOC_ID, &id);
+            c->id[k] = id;
+            c->num++;
+        }
+    }
+
+    // The group must be scheduled (e.g. not too many counters)
+    unsigned long long v[BENCH_NUM_COUNTERS + 2];
+    if (!counters_read(c, v) || v[BENCH_NUM_COUNTERS + 1] == 0 || v[BENCH_CYCLES] == 0) {
+        counters_close(c);
+        return;
+    }
+
+    #if defined(__x86_64__)
+    void *page = mmap(NULL, sysconf(_SC_PAGESIZE), PROT_READ, MAP_SHARED, c->fd[BENCH_CYCLES], 0);
+    if (page != MAP_FAILED) {
+        struct perf_event_mmap_page *pc = page;
+        if (pc->cap_user_rdpmc) c->page = page; else munmap(page, sysconf(_SC_PAGESIZE));
+    }
+    #endif
+#endif
+}
+
+// Ticks of the samples, i.e. core cycles by the counters, or cpucycles()
+unsigned long long bench_cycles(bench_t *bench) {
+    counters_t *c = &bench->counters;
+
+#if defined(__linux__)
+    #if defined(__x86_64__)
+    if (c->page != NULL) {
+        // The seqlock of the mapping, see linux/perf_event.h
+        volatile struct perf_event_mmap_page *pc = c->page;
+        uint32_t seq, idx;
+        uint64_t count;
+        do {
+            seq = pc->lock;
+            __asm__ __volatile__("" ::: "memory");
+            idx = pc->index;
+            count = pc->offset;
+            if (pc->cap_user_rdpmc && idx) {
+                uint32_t lo, hi;
+                __asm__ __volatile__("rdpmc" : "=a"(lo), "=d"(hi) : "c"(idx - 1));
+                int64_t pmc = (int64_t) (((uint64_t) hi << 32) | lo);
+                pmc <<= 64 - pc->pmc_width;
+                pmc >>= 64 - pc->pmc_width;
+                count += pmc;
+            }
+            __asm__ __volatile__("" ::: "memory");
+        } while (pc->lock != seq);
+        return count;
+    }
+    #endif
+    if (c->num > 0) {
+        uint64_t buf[3 + 2 * BENCH_NUM_COUNTERS];
+        if (read(c->fd[BENCH_CYCLES], buf, sizeof(buf)) >= (ssize_t) (5 * sizeof(uint64_t))) {
+            return buf[3];      // the leader is the first value of the group
+        }
+    }
+#endif
+    return cpucycles();
+}
+
+void bench_counters_start(bench_t *bench) {
+#if defined(__linux__)
+    counters_t *c = &bench->counters;
+    if (c->num > 0 && !counters_read(c, c->start)) {
+        counters_close(c);
+    }
+#endif
+}
+
+// Averages of the counters of the run (scaled if they were multiplexed)
+void bench_counters_stop(bench_t *bench) {
+#if defined(__linux__)
+    counters_t *c = &bench->counters;
+    unsigned long long v[BENCH_NUM_COUNTERS + 2];
+    if (c->num == 0 || !counters_read(c, v)) {
+        return;
+    }
+
+    double enabled = (double) (v[BENCH_NUM_COUNTERS] - c->start[BENCH_NUM_COUNTERS]);
+    double running = (double) (v[BENCH_NUM_COUNTERS + 1] - c->start[BENCH_NUM_COUNTERS + 1]);
+    for (int k = 0; k < BENCH_NUM_COUNTERS; k++) {
+        c->per_call[k] = (c->fd[k] >= 0 && running > 0) 
+            ? (double) (v[k] - c->start[k]) * (enabled / running) / bench->ntests : -1;
+    }
+#else
+    (void) bench;
+#endif
+}
+
+// Source of the ticks
+const char *bench_clock_name(bench_t *bench) {
+    if (bench->counters.num == 0) {
+        return "cpucycles";
+    }
+    return (bench->counters.page != NULL) ? "perf_event (rdpmc)" : "perf_event (read)";
+}
+
 /******************************************************************
  * Benchmarking Functions
  ******************************************************************/
@@ -72,6 +315,13 @@ void bench_init(bench_t *bench, int ntests, FILE *logger) {
         printf("Error: Memory allocation failed\n");
         return;
     }
+
+    bench->counters.page = NULL;
+    bench->counters.num = 0;
+    for (int k = 0; k < BENCH_NUM_COUNTERS; k++) {
+        bench->counters.fd[k] = -1;
+    }
+    counters_open(&bench->counters);
 }
 
 
@@ -82,6 +332,7 @@ void bench_free(bench_t *bench) {
     }
 
     free(bench->t);
+    counters_close(&bench->counters);
 }
 
 
@@ -227,6 +478,22 @@ void print_results(bench_t *bench) {
     printfalignedcomma(bench->stats.max, 12);
     printf(" cc \n");
 
+    // Hardware counters per call
+    counters_t *c = &bench->counters;
+    if (c->num > 0) {
+        printf("\tCounters per call (%s)\n", bench_clock_name(bench));
+        for (int k = 0; k < BENCH_NUM_COUNTERS; k++) {
+            if (c->per_call[k] >= 0) {
+                printf("\t\t%-12s:", counter_names[k]);
+                printfalignedcomma((unsigned long long) c->per_call[k], 12);
+                printf("\n");
+            }
+        }
+        if (c->per_call[BENCH_CYCLES] > 0 && c->per_call[BENCH_INSTRUCTIONS] >= 0) {
+            printf("\t\tIPC         : %12.2f\n", c->per_call[BENCH_INSTRUCTIONS] / c->per_call[BENCH_CYCLES]);
+        }
+    }
+
     // print to logger
     if (logger != NULL)
     {
@@ -236,6 +503,9 @@ void print_results(bench_t *bench) {
         fprintf(logger, "    median: %llu\n", bench->stats.med);
         fprintf(logger, "    q3: %llu\n", bench->stats.q3);
         fprintf(logger, "    max: %llu\n", bench->stats.max);
+        for (int k = 0; k < BENCH_NUM_COUNTERS && c->num > 0; k++) {
+            if (c->per_call[k] >= 0) fprintf(logger, "    %s: %.0f\n", counter_names[k], c->per_call[k]);
+        }
     }
     else
     {
@@ -32,6 +32,25 @@
 
 unsigned long long cpucycles(void);
 
+/* Hardware counters (perf_event_open on Linux, see bench.c) */
+enum {
+    BENCH_CYCLES = 0,           // core cycles (the leader of the group)
+    BENCH_INSTRUCTIONS,
+    BENCH_L1D_MISSES,
+    BENCH_L2_MISSES,
+    BENCH_BRANCH_MISSES,
+    BENCH_NUM_COUNTERS
+};
+
+typedef struct {
+    int fd[BENCH_NUM_COUNTERS];             // -1 if not counted
+    unsigned long long id[BENCH_NUM_COUNTERS];  // of the counters in a read of the group
+    int num;                                // counters of the group (0 for rdtsc)
+    void *page;                             // mapping of the leader (rdpmc), or NULL
+    unsigned long long start[BENCH_NUM_COUNTERS + 2];
+    double per_call[BENCH_NUM_COUNTERS];    // averages of a run, -1 if not counted
+} counters_t;
+
 typedef struct {
     unsigned long long ave;
     // Five-number summary
@@ -50,6 +69,7 @@ typedef struct {
     double result;              // Stop - Start
     stat_t stats;               // Statistic Summary
     FILE *logger;               // Logger file
+    counters_t counters;        // Hardware counters of the run
 } bench_t;
 
 /******************************************************************
@@ -61,14 +81,22 @@ void bench_stats(bench_t *bench);
 // void print_results(FILE *logger, unsigned long long *t, size_t tlen);
 void print_results(bench_t *bench);
 
+// Ticks of the samples, i.e. core cycles by the counters, or cpucycles()
+unsigned long long bench_cycles(bench_t *bench);
+void bench_counters_start(bench_t *bench);
+void bench_counters_stop(bench_t *bench);
+const char *bench_clock_name(bench_t *bench);
+
 
 #define BENCHFUNC(bench, func) \
     clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &bench.start); \
+    bench_counters_start(&bench); \
     for (int i = 0; i < bench.ntests; i++) { \
-        bench.t[i] = cpucycles(); \
+        bench.t[i] = bench_cycles(&bench); \
         func; \
     } \
-    bench.t[bench.ntests] = cpucycles(); \
+    bench.t[bench.ntests] = bench_cycles(&bench); \
+    bench_counters_stop(&bench); \
     clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &bench.stop); \
     bench.result = (bench.stop.tv_sec - bench.start.tv_sec) * 1e6 + (bench.stop.tv_nsec - bench.start.tv_nsec) / 1e3; \
     bench.result = bench.result / (bench.ntests + 1); \
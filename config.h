@@ -49,6 +49,132 @@
 #define LAST_BLOCK_IDX      FLOOR(EXT_DEG, 64)
 #define LAST_BLOCK_BITSIZE  (EXT_DEG % 64)
 
+/* Number of 64-bit blocks handled by the BYI divstep base case,
+ * i.e. the BYI recursion stops at n <= 64 * BYI_BASE_BLOCKS divsteps */
+#if !defined(BYI_BASE_BLOCKS)
+    #define BYI_BASE_BLOCKS (2)
+#endif
+#if (BYI_BASE_BLOCKS != 1) && (BYI_BASE_BLOCKS != 2) && (BYI_BASE_BLOCKS != 4)
+    #error "BYI_BASE_BLOCKS must be 1, 2 or 4"
+#endif
+#define BYI_MAX_BASE_BLOCKS (4)
+
+/* Share of the left child in the split of a BYI node, in 1/16 of its
+ * blocks, from 8 (the balanced split) to 15 */
+#if !defined(BYI_SPLIT)
+    #define BYI_SPLIT       (8)
+#endif
+
+/* Number of divsteps of BYI for f = x^d - 1 and g of degree < d.
+ * 2d - 1 divsteps are enough for the inverse (Bernstein and Yang), 
+ * and it is tight, i.e. about half of the inputs swap at the 
+ * (2d-1)-th divstep, after which the inverse does not change 
+ * anymore (see test_byi.c) */
+#define BYI_DIVSTEPS(d)     (2 * (d) - 1)
+
+/* Polynomials of at most GF2X_KARA_THRESHOLD blocks are multiplied
+ * by schoolbook in the Karatsuba transform */
+#if !defined(GF2X_KARA_THRESHOLD)
+    #define GF2X_KARA_THRESHOLD (8)
+#endif
+
+/* Products of at least GF2X_TASK_BLOCKS blocks are split into OpenMP 
+ * tasks (when compiled with -fopenmp, see BYI_PARALLEL in the Makefile),
+ * and the smaller ones are computed serially by the running task */
+#if !defined(GF2X_TASK_BLOCKS)
+    #define GF2X_TASK_BLOCKS (32)
+#endif
+
+/* Window of gf2x_mod_pow in bits, i.e. a table of 2^GF2X_POW_WINDOW powers */
+#if !defined(GF2X_POW_WINDOW)
+    #define GF2X_POW_WINDOW     (4)
+#endif
+
+/* gf2x_mod_sqr_k permutes the coefficients (the Frobenius map) instead of
+ * squaring for k >= GF2X_FROB_MIN_K, i.e. about the cost of the permutation */
+#if !defined(GF2X_FROB_MIN_K)
+    #define GF2X_FROB_MIN_K     (64)
+#endif
+
+/* Block squaring of gf2x_mod_sqr, i.e. GF2X_SQR_CLMUL or GF2X_SQR_PDEP */
+#if !defined(GF2X_SQR_KERNEL)
+    #define GF2X_SQR_KERNEL     (0)
+#endif
+
+/* Number of runs of each candidate measured by gf2x_plan_create, and
+ * the number of entries of the wisdom (see gf2x_plan.c) */
+#if !defined(GF2X_PLAN_RUNS)
+    #define GF2X_PLAN_RUNS      (5)
+#endif
+#define GF2X_WISDOM_MAX         (64)
+
+/* Lanes of gf2x_mod_inv_lanes (see gf2x_lanes.c), i.e. the inputs 
+ * inverted together in a vector register: 4 in zmm or 2 in ymm by
+ * VPCLMULQDQ, and 1 in xmm otherwise */
+#if !defined(GF2X_LANES)
+    #if defined(__VPCLMULQDQ__) && defined(__AVX512F__) && defined(__AVX512BW__)
+        #define GF2X_LANES  4
+    #elif defined(__VPCLMULQDQ__) && defined(__AVX2__)
+        #define GF2X_LANES  2
+    #else
+        #define GF2X_LANES  1
+    #endif
+#endif
+
+/* Lanes of the BYI divsteps of gf2x_mod_inv_byi_lanes (see gf2x_inv_byi.c),
+ * i.e. the inputs in the 64-bit lanes of a vector register: 8 in zmm,
+ * 4 in ymm, and 2 otherwise */
+#if !defined(GF2X_BYI_LANES)
+    #if defined(__AVX512F__)
+        #define GF2X_BYI_LANES  8
+    #elif defined(__AVX2__)
+        #define GF2X_BYI_LANES  4
+    #else
+        #define GF2X_BYI_LANES  2
+    #endif
+#endif
+
+/* Inversion service (see gf2x_service.c), i.e. the size of the submission
+ * ring, and the largest batch inverted by a worker at a time */
+#if !defined(GF2X_SVC_DEPTH)
+    #define GF2X_SVC_DEPTH      (1024)
+#endif
+#if !defined(GF2X_SVC_BATCH)
+    #define GF2X_SVC_BATCH      (16)
+#endif
+
+/* Inversion daemon (see gf2x_shm.c), i.e. the maximum numbers of worker
+ * processes and of clients, the maximum depth of a client, and the largest
+ * number of requests of a client served by a worker at a time */
+#define GF2X_SHM_MAX_WORKERS    (64)
+#define GF2X_SHM_MAX_CLIENTS    (256)
+#define GF2X_SHM_MAX_DEPTH      (4096)
+#if !defined(GF2X_SHM_BATCH)
+    #define GF2X_SHM_BATCH      (16)
+#endif
+
+/* Thread pool (see gf2x_pool.c), i.e. the maximum number of workers, 
+ * and the largest chunk of a batch inverted by a worker at a time */
+#define GF2X_POOL_MAX_THREADS   (256)
+#if !defined(GF2X_POOL_CHUNK)
+    #define GF2X_POOL_CHUNK     (16)
+#endif
+
+/* Number of inversions of each method, benchmarked by gf2x_mod_inv 
+ * for selecting the fastest one */
+#if !defined(GF2X_SELECT_RUNS)
+    #define GF2X_SELECT_RUNS    (5)
+#endif
+
+/* Parameter search of CEA, TYT and SAC (see gf2x_params.c), i.e. 
+ * p - 2 = r_0 * ... * r_(k-1) + h (TYT) for k <= GF2X_PARAMS_TYT_MAX_K,
+ * under the cost of gf2x_mod_sqr/gf2x_mod_mul from GF2X_PARAMS_CALIB_RUNS runs */
+#if !defined(GF2X_PARAMS_TYT_MAX_K)
+    #define GF2X_PARAMS_TYT_MAX_K   (3)
+#endif
+#define GF2X_PARAMS_MAX_DIV         (256)
+#define GF2X_PARAMS_CALIB_RUNS      (31)
+
 /* Print a polynomial */
 #define POLY_PRINT_DELIM    4   // Number of 64-bit blocks to print in a single line
 #define POLY_PRINT_PAD_TYPE 1   // 0:Zero 1:Dot 2:Short+Zero 3:Short+Dot
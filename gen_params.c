@@ -0,0 +1,121 @@
+/* 
+ * MIT License
+ *
+ * Copyright (c) 2024 Emrah Karagoz, Pakize Sanal, Abhraneel Dutta, Edoardo Persichetti
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+
+#include "gf2x.h"
+#include "params.h"
+
+// Searched parameters (ctx_t holds the BYI schedule, i.e. not on the stack)
+static ctx_t found;
+
+typedef void (*chain_func_t)(ctx_t *ctx, chain_t *chain);
+
+static void print_chain_row(char *name, chain_func_t func, cost_model_t *cost, int shipped) {
+    cost_model_t nsqr = {1, 0};
+    cost_model_t nmul = {0, 1};
+    chain_t chain;
+
+    printf("| %-5s |", name);
+
+    if (shipped) {
+        func(&ctx, &chain);
+        printf(" %5.0f %6.0f %9.3f |", gf2x_chain_cost(&chain, &nmul), 
+            gf2x_chain_cost(&chain, &nsqr), gf2x_chain_cost(&chain, cost) / 1e6);
+    } else {
+        printf(" %5s %6s %9s |", "-", "-", "-");
+    }
+
+    func(&found, &chain);
+    printf(" %5.0f %6.0f %9.3f |\n", gf2x_chain_cost(&chain, &nmul), 
+        gf2x_chain_cost(&chain, &nsqr), gf2x_chain_cost(&chain, cost) / 1e6);
+}
+
+static void print_list(char *name, int *list, int len) {
+    printf("%s = {", name);
+    for (int i = 0; i < len; i++) {
+        printf((i == 0) ? "%d" : ", %d", list[i]);
+    }
+    printf("}");
+}
+
+int main(void)
+{
+    // Print the test info
+    printf("Parameter Search:\n");
+    printf("- EXT_DEG               : %d\n", EXT_DEG);
+    printf("- TYT_MAX_K             : %d\n", GF2X_PARAMS_TYT_MAX_K);
+
+    // Cost model of the host
+    srand(time(NULL));
+    cost_model_t cost;
+    gf2x_cost_calibrate(&cost);
+    printf("- Cost of gf2x_mod_sqr  : %.0f cc\n", cost.sqr);
+    printf("- Cost of gf2x_mod_mul  : %.0f cc\n", cost.mul);
+
+    // Search
+    found.p = EXT_DEG;
+    gf2x_params_search(&found, &cost);
+
+    // Shipped (params.h) vs searched parameters, i.e. the number of 
+    // multiplications, squarings, and the cost in Mcc of their chains
+    int shipped = (ctx.cea_a != 0);
+
+    printf("\n");
+    printf("+-------+-------------------------+-------------------------+\n");
+    printf("|       |    params.h             |    searched             |\n");
+    printf("|       |   mul    sqr       Mcc |   mul    sqr       Mcc |\n");
+    printf("+-------+-------------------------+-------------------------+\n");
+    print_chain_row("FLT", gf2x_chain_flt, &cost, shipped);
+    print_chain_row("CEA", gf2x_chain_cea, &cost, shipped);
+    print_chain_row("TYT", gf2x_chain_tyt, &cost, shipped);
+    print_chain_row("SAC", gf2x_chain_sac, &cost, shipped);
+    printf("+-------+-------------------------+-------------------------+\n");
+
+    // Entry of params.h
+    printf("\n");
+    printf("    #elif EXT_DEG == %d\n", EXT_DEG);
+    printf("        ctx_t ctx = { \n");
+    printf("            .p = %d, \n", EXT_DEG);
+    printf("            .cea_a = %d,  .cea_b = %d,\n", found.cea_a, found.cea_b);
+    printf("            .tyt_h = %d,  .tyt_k = %d,  ", found.tyt_h, found.tyt_k);
+    print_list(".tyt_r", found.tyt_r, found.tyt_k);
+    printf(",\n");
+    printf("            .sac_r = %d,  .sac_n = %d,  .sac_h = %d, .sac_h_idx = %d,\n", 
+        found.sac_r, found.sac_n, found.sac_h, found.sac_h_idx);
+    printf("            .sac_lenC = %d,\n", found.sac_lenC);
+    printf("            ");
+    print_list(".sac_C", found.sac_C, found.sac_lenC);
+    printf(",\n");
+    printf("            ");
+    print_list(".sac_A", found.sac_A, 2 * (found.sac_lenC - 1));
+    printf(",\n");
+    printf("            };\n");
+
+    return 0;
+}
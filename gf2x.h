@@ -25,6 +25,7 @@
 #ifndef GF2X_H
 #define GF2X_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <assert.h>
 
@@ -94,12 +95,35 @@ void gf2x_poly_add(IN poly_t *f, IN poly_t *g, OUT poly_t *h);
 // h <- f * g
 void gf2x_poly_mul(IN poly_t *f, IN poly_t *g, OUT poly_t *h);
 
+// c <- c + a * b, for na-block a and nb-block b
+void gf2x_mul_words(IN uint64_t *a, IN int na, IN uint64_t *b, IN int nb, INPLACE uint64_t *c);
+
+// Karatsuba transform of n-block polynomials down to kt blocks (see gf2x_mul.c)
+// a * b = interp(eval(a) (.) eval(b)), summable before interpolation
+int  gf2x_kara_size(IN int n, IN int kt);
+int  gf2x_kara_prod_size(IN int n, IN int kt);
+void gf2x_kara_eval(IN uint64_t *a, IN int alen, IN int n, IN int kt, OUT uint64_t *ea);
+void gf2x_kara_mul_acc(IN uint64_t *ea, IN uint64_t *eb, IN int n, IN int kt, INPLACE uint64_t *ec);
+void gf2x_kara_interp(INPLACE uint64_t *ec, IN int n, IN int kt);
+
+// Middle product of n-block a and (2n-1)-block b (see gf2x_mul.c)
+// m_k <- m_k + sum_i a_i * b_(k+n-1-i) in m[2k], m[2k+1], for 0 <= k < n
+// by the Karatsuba threshold kt, using scratch of gf2x_mul_middle_scratch(n) blocks
+int  gf2x_mul_middle_scratch(IN int n);
+void gf2x_mul_middle(IN uint64_t *a, IN uint64_t *b, IN int n, IN int kt, INPLACE uint64_t *m, uint64_t *scratch);
+
+// m <- m + sum_i a_i * b_(n-1-i) in m[0], m[1] (i.e. a single m_k)
+void gf2x_mul_dot(IN uint64_t *a, IN uint64_t *b, IN int n, INPLACE uint64_t *m);
+
 // c = a+b mod (x^r - 1)
 void gf2x_mod_add(OUT poly_t *c, IN poly_t *a, IN poly_t *b);
 
 // c = a*b mod (x^r - 1) 
 void gf2x_mod_mul(IN poly_t *a, IN poly_t *b, OUT poly_t *c);
 
+// c = a*b mod (x^r - 1), by the Karatsuba transform
+void gf2x_mod_mul_kara(IN poly_t *a, IN poly_t *b, OUT poly_t *c);
+
 // c <- a^2 mod (x^r - 1)
 void gf2x_mod_sqr(IN  poly_t *a, OUT poly_t *c);
 
@@ -109,6 +133,48 @@ void gf2x_mod_sqr_k_inplace(INPLACE poly_t *c, IN int k);
 // c <- h mod x^r - 1
 void gf2x_red(IN  poly_t *h, OUT poly_t *c);
 
+// c <- a^(2^k) mod (x^r - 1) for any integer k (k < 0 for the roots), 
+// by the Frobenius map a(x) -> a(x^2), i.e. a permutation of the coefficients
+void gf2x_mod_frob(IN poly_t *a, IN int k, OUT poly_t *c);
+
+// c <- a^(1/2) mod (x^r - 1)
+void gf2x_mod_sqrt(IN poly_t *a, OUT poly_t *c);
+
+// c <- a^(2^k) mod (x^r - 1), by squarings or by gf2x_mod_frob for large k
+void gf2x_mod_sqr_k(IN poly_t *a, IN int k, OUT poly_t *c);
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Tunables of the Arithmetic                                          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* Block squaring kernels of gf2x_mod_sqr */
+#define GF2X_SQR_CLMUL  0   // carry-less square (PCLMULQDQ, PMULL)
+#define GF2X_SQR_PDEP   1   // bit deposit of the halves (BMI2)
+
+/* Knobs of the kernels, i.e. the defaults of config.h, or the winners 
+ * of gf2x_plan_create (see gf2x_plan.c). The kernels read the process-wide
+ * gf2x_tune, or the tunables passed to them (e.g. those of a plan). */
+typedef struct {
+    int kara_threshold;     // blocks of the schoolbook products of the Karatsuba transform
+    int sqr_kernel;         // GF2X_SQR_*
+    int frob_min_k;         // k from which gf2x_mod_sqr_k is the Frobenius map
+    int byi_base_blocks;    // blocks of the BYI base case (1, 2 or 4)
+    int byi_split;          // share of the left child of a BYI node, in 1/16 (8 to 15)
+} gf2x_tune_t;
+
+extern gf2x_tune_t gf2x_tune;
+
+// gf2x_mod_mul_kara, gf2x_mod_sqr and gf2x_mod_sqr_k_inplace by tune, in the
+// scratch ws of gf2x_mod_scratch(tune, size64) blocks (or an allocated one for NULL)
+void gf2x_mod_mul_kara_tune(IN gf2x_tune_t *tune, IN poly_t *a, IN poly_t *b, OUT poly_t *c, uint64_t *ws);
+void gf2x_mod_sqr_tune(IN gf2x_tune_t *tune, IN poly_t *a, OUT poly_t *c, uint64_t *ws);
+void gf2x_mod_sqr_k_inplace_tune(IN gf2x_tune_t *tune, INPLACE poly_t *c, IN int k, uint64_t *ws);
+int  gf2x_mod_scratch(IN gf2x_tune_t *tune, IN int n);
+
+// Whether a squaring kernel is available on the host
+int gf2x_sqr_kernel_ok(IN int kernel);
+
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
  * Polynomial Inversions                                               *
@@ -117,6 +183,96 @@ void gf2x_red(IN  poly_t *h, OUT poly_t *c);
 #define POLY_INV_SAC_MAX_C  20
 #define POLY_INV_SAC_MAX_A  (2 * POLY_INV_SAC_MAX_C)
 
+/* BYI schedule, i.e. the jumpdivstep tree of n divsteps in post-order,
+ * with the blocks of all the polynomials in a single workspace 
+ * (see gf2x_inv_byi.c). It only depends on n, so it is computed once. */
+#define BYI_MAX_NODES   (2 * MAX_POLY_SIZE)
+#define BYI_MAX_OPS     (3 * BYI_MAX_NODES)
+
+#define BYI_OP_BASE     0   // delta, P <- divsteps on f, g of a leaf
+#define BYI_OP_UPDATE   1   // f, g of the right child <- P1 * (f, g)
+#define BYI_OP_MERGE    2   // P <- P2 * P1
+
+typedef struct {
+    int n;                  // number of divsteps
+    int s;                  // number of blocks, i.e. ceil(n/64)
+    int need;               // entries of P needed by the parent
+    int left;               // left child (-1 for a leaf)
+    int right;              // right child (-1 for a leaf)
+    int f;                  // offset of f (s blocks) in the workspace
+    int g;                  // offset of g (s blocks) in the workspace
+    int P;                  // offset of P (4 entries, and 2 masks)
+    int size64;             // number of blocks of each entry of P
+} byi_node_t;
+
+typedef struct {
+    int type;               // BYI_OP_*
+    int node;               // index of the node
+    int ws;                 // offset of the scratch in the workspace
+} byi_op_t;
+
+typedef struct {
+    int n;                  // number of divsteps (0 if not computed)
+    gf2x_tune_t tune;       // tunables of the schedule, i.e. the base case, the
+                            // split of the nodes, and the Karatsuba threshold
+    int team;               // whether gf2x_byi_run opens an OpenMP team (BYI_PARALLEL)
+    int num_nodes;          // node[0] is the top node
+    int num_ops;
+    int ws_size;            // number of 64-bit blocks of the workspace
+    byi_node_t node[BYI_MAX_NODES];
+    byi_op_t   op[BYI_MAX_OPS];
+} byi_plan_t;
+
+/* Exponentiation program of an addition chain (see gf2x_chain.c),
+ * where the i-th operation defines the value
+ *     v_(i+1) <- v_src^(2^k) * v_mul    (or v_src^(2^k) for mul < 0)
+ * from the input v_0, and the last value is the output. */
+#define CHAIN_MAX_OPS   128
+#define CHAIN_REG_IN    0   // register of the input
+#define CHAIN_REG_OUT   1   // register of the output
+
+typedef struct {
+    int src;                // values
+    int k;
+    int mul;
+    int rdst;               // registers (by gf2x_chain_compile)
+    int rsrc;
+    int rmul;
+} chain_op_t;
+
+typedef struct {
+    int num_ops;
+    int num_regs;           // including the input and output
+    chain_op_t op[CHAIN_MAX_OPS];
+} chain_t;
+
+void gf2x_chain_init(OUT chain_t *chain);
+int  gf2x_chain_op(INPLACE chain_t *chain, IN int src, IN int k, IN int mul);
+void gf2x_chain_compile(INPLACE chain_t *chain);
+void gf2x_chain_run(IN chain_t *chain, IN poly_t *g, OUT poly_t *out);
+// The same by tune, with the num_regs - 2 temporaries in tmp, and the
+// products by the Karatsuba transform in the scratch ws of gf2x_mod_scratch 
+// blocks (or by gf2x_mod_mul, as gf2x_chain_run, for NULL)
+void gf2x_chain_exec(IN chain_t *chain, IN gf2x_tune_t *tune, IN poly_t *g, OUT poly_t *out, 
+                     poly_t *tmp, uint64_t *ws);
+
+/* Cost model of the chains, e.g. in cycles of gf2x_mod_sqr and
+ * gf2x_mod_mul on the host (see gf2x_cost_calibrate) */
+typedef struct {
+    double sqr;
+    double mul;
+} cost_model_t;
+
+double gf2x_chain_cost(IN chain_t *chain, IN cost_model_t *cost);
+void gf2x_chain_exponent(IN chain_t *chain, OUT uint64_t *e, IN int nwords);
+
+/* Inversion methods (INVERSE_METHOD, and ctx_t.inv_method) */
+#define BYI 1
+#define FLT 2
+#define CEA 3
+#define TYT 4
+#define SAC 5
+
 typedef struct _ctx_t {
     // f = x^p - 1
     int p;
@@ -130,15 +286,111 @@ typedef struct _ctx_t {
     int sac_lenC;
     int sac_C[POLY_INV_SAC_MAX_C];
     int sac_A[POLY_INV_SAC_MAX_A];
+    // BYI schedule of BYI_DIVSTEPS(p) divsteps
+    byi_plan_t byi;
+    // Fastest inversion method of the host (see gf2x_mod_inv), or 0
+    int inv_method;
 } ctx_t;
 
-// g^-1 mod (x^p - 1) using Euclid's GCD algorithm 
-void gf2x_mod_inv_eea(IN ctx_t *ctx, IN poly_t *g, OUT poly_t *ginv);
+// Precomputations for ctx (i.e. the BYI schedule), 
+// otherwise done on the first use of ctx
+void gf2x_ctx_init(INPLACE ctx_t *ctx);
+
+// BYI schedule of n divsteps for x^p - 1 by tune (e.g. &gf2x_tune)
+void gf2x_byi_plan(OUT byi_plan_t *plan, IN gf2x_tune_t *tune, IN int p, IN int n);
+
+// Whether a BYI schedule was computed for other tunables than tune
+int gf2x_byi_plan_stale(IN byi_plan_t *plan, IN gf2x_tune_t *tune);
+
+// g^-1 mod (x^p - 1) by the divsteps of the schedule, in the workspace ws
+// of plan->ws_size blocks
+void gf2x_byi_run(IN byi_plan_t *plan, IN int p, IN poly_t *g, OUT poly_t *ginv, uint64_t *ws);
+
+// The same in parts: load (f, g), run the operations from the k-th one until 
+// cpucycles() reaches deadline (and return the next one), and store ginv
+void gf2x_byi_load(IN byi_plan_t *plan, IN int p, IN poly_t *g, uint64_t *ws);
+int  gf2x_byi_resume(IN byi_plan_t *plan, uint64_t *ws, IN int k, INPLACE int *delta, 
+                     IN unsigned long long deadline);
+void gf2x_byi_store(IN byi_plan_t *plan, IN int p, uint64_t *ws, OUT poly_t *ginv);
+
+// gf2x_byi_run for GF2X_BYI_LANES inputs *g[l] together (in the lanes of vectors),
+// in GF2X_BYI_LANES workspaces of plan->ws_size blocks, one after the other
+void gf2x_byi_run_lanes(IN byi_plan_t *plan, IN int p, IN poly_t **g, OUT poly_t **ginv, uint64_t *ws);
+
+// g^-1 mod (x^p - 1) in constant time, by the fastest method of the host,
+// i.e. the one of the wisdom, or otherwise the first call on ctx runs a 
+// benchmark of all the methods (see gf2x_inv.c)
+void gf2x_mod_inv(IN ctx_t *ctx, IN poly_t *g, OUT poly_t *ginv);
+
+// Select ctx->inv_method for gf2x_mod_inv, and return it
+int gf2x_inv_select(INPLACE ctx_t *ctx);
+
+// g^-1 mod (x^p - 1) by a given method (BYI, FLT, CEA, TYT or SAC)
+void gf2x_mod_inv_method(IN ctx_t *ctx, IN int method, IN poly_t *g, OUT poly_t *ginv);
+
+// Name of a method, e.g. "BYI" for BYI
+const char *gf2x_inv_name(IN int method);
+
+// ginv[i] <- g[i]^-1 mod (x^p - 1) for n polynomials by a single inversion
+// (Montgomery's trick, see gf2x_inv_batch.c) in constant time, where 
+// ginv[i] = 0 for a non-invertible g[i]. Returns the number of invertible g[i].
+// If 2 is not primitive modulo p, a non-invertible g[i] of odd weight is only
+// seen in the product, and then each g[i] is inverted alone.
+int gf2x_mod_inv_batch(IN ctx_t *ctx, IN int n, IN poly_t *g, OUT poly_t *ginv);
+
+// The same, with the inversion by a given method (or the fastest one for 0)
+int gf2x_mod_inv_batch_method(IN ctx_t *ctx, IN int method, IN int n, IN poly_t *g, OUT poly_t *ginv);
+
+// ginv[i] <- g[i]^-1 mod (x^p - 1) for n polynomials using BYI, where the
+// divsteps of GF2X_BYI_LANES inputs are run in the lanes of vector registers
+void gf2x_mod_inv_byi_lanes(IN ctx_t *ctx, IN int n, IN poly_t *g, OUT poly_t *ginv);
+
+// ginv[i] <- g[i]^-1 mod (x^p - 1) for n polynomials by a chain method (or 
+// the one of the fewest multiplications for 0) in constant time, where
+// GF2X_LANES inputs are run in the lanes of vector registers (see gf2x_lanes.c),
+// or by gf2x_mod_inv_byi_lanes for BYI
+void gf2x_mod_inv_lanes(IN ctx_t *ctx, IN int method, IN int n, IN poly_t *g, OUT poly_t *ginv);
+
+// g^-1 mod (x^p - 1) using Euclid's GCD algorithm, in VARIABLE time. 
+// Returns 1, or 0 (and ginv = 0) if g is not invertible.
+int gf2x_mod_inv_eea(IN ctx_t *ctx, IN poly_t *g, OUT poly_t *ginv);
+
+// g^-1 mod (x^p - 1) for PUBLIC g only (e.g. test vectors, public keys),
+// i.e. the fastest inversion, which is not in constant time. Returns 1,
+// or 0 (and ginv = 0) if g is not invertible, e.g. an invalid public key.
+int gf2x_mod_inv_public(IN ctx_t *ctx, IN poly_t *g, OUT poly_t *ginv);
 
 // g^-1 mod (x^p - 1) using Bernstein and Yang's Polynomial Inversion
 // void gf2x_mod_inv_by(IN int d, IN poly_t *f, IN poly_t *g, OUT poly_t *ginv); 
 void gf2x_mod_inv_byi(IN ctx_t *ctx, IN poly_t *g, OUT poly_t *ginv); 
 
+// g^-1 mod (x^p - 1) using n divsteps of BYI, i.e. correct for all g 
+// if n >= BYI_DIVSTEPS(p), and for fewer divsteps only for some g
+void gf2x_mod_inv_byi_steps(IN ctx_t *ctx, IN int n, IN poly_t *g, OUT poly_t *ginv); 
+
+// c <- g^e mod (x^p - 1) for e of ebits bits (e[0] is the lowest block), 
+// by a fixed window, in constant time for secret g and e
+void gf2x_mod_pow(IN ctx_t *ctx, IN poly_t *g, IN uint64_t *e, IN int ebits, OUT poly_t *c);
+
+// Addition chains of g^-1 = g^(2^(p-1)-2) of the FLT-based algorithms
+void gf2x_chain_flt(IN ctx_t *ctx, OUT chain_t *chain);
+void gf2x_chain_cea(IN ctx_t *ctx, OUT chain_t *chain);
+void gf2x_chain_tyt(IN ctx_t *ctx, OUT chain_t *chain);
+void gf2x_chain_sac(IN ctx_t *ctx, OUT chain_t *chain);
+// The chain of a method (FLT, CEA, TYT or SAC)
+void gf2x_chain_method(IN ctx_t *ctx, IN int method, OUT chain_t *chain);
+
+// Cycles of gf2x_mod_sqr and gf2x_mod_mul on the host
+void gf2x_cost_calibrate(OUT cost_model_t *cost);
+
+// The cheapest parameters of CEA, TYT and SAC for ctx->p (see gf2x_params.c),
+// which return the cost of their chains
+double gf2x_params_cea(INPLACE ctx_t *ctx, IN cost_model_t *cost);
+double gf2x_params_tyt(INPLACE ctx_t *ctx, IN cost_model_t *cost);
+double gf2x_params_sac(INPLACE ctx_t *ctx, IN cost_model_t *cost);
+// All of them, for the cost model of the host if cost = NULL
+void gf2x_params_search(INPLACE ctx_t *ctx, IN cost_model_t *cost);
+
 // g^-1 mod (x^p - 1) using FLT-based Inversion
 void gf2x_mod_inv_flt(IN ctx_t *ctx, IN poly_t *g, OUT poly_t *ginv); 
 
@@ -151,6 +403,244 @@ void gf2x_mod_inv_tyt(IN ctx_t *ctx, IN poly_t *g, OUT poly_t *ginv);
 // g^-1 mod (x^p - 1) using SAC Inversion
 void gf2x_mod_inv_sac(IN ctx_t *ctx, IN poly_t *g, OUT poly_t *ginv);
 
+/* Division h * g^-1 mod (x^p - 1), i.e. BIKE's h = h1 * h0^-1.
+ * It is the inversion of g and a single multiplication by the Karatsuba
+ * transform in all the algorithms: h cannot be folded into the inversion
+ * for free, e.g. seeding the Bezout column of BYI with h, or the last
+ * multiplication of the FLT chains with h, needs a product with h as well. */
+
+// h * g^-1 mod (x^p - 1) in constant time (by gf2x_mod_inv)
+void gf2x_mod_div(IN ctx_t *ctx, IN poly_t *h, IN poly_t *g, OUT poly_t *out);
+
+// h * g^-1 mod (x^p - 1) for PUBLIC h and g only, in variable time (by EEA).
+// Returns 1, or 0 (and out = 0) if g is not invertible.
+int gf2x_mod_div_public(IN ctx_t *ctx, IN poly_t *h, IN poly_t *g, OUT poly_t *out);
+
+void gf2x_mod_div_byi(IN ctx_t *ctx, IN poly_t *h, IN poly_t *g, OUT poly_t *out);
+int  gf2x_mod_div_eea(IN ctx_t *ctx, IN poly_t *h, IN poly_t *g, OUT poly_t *out);
+void gf2x_mod_div_flt(IN ctx_t *ctx, IN poly_t *h, IN poly_t *g, OUT poly_t *out);
+void gf2x_mod_div_cea(IN ctx_t *ctx, IN poly_t *h, IN poly_t *g, OUT poly_t *out);
+void gf2x_mod_div_tyt(IN ctx_t *ctx, IN poly_t *h, IN poly_t *g, OUT poly_t *out);
+void gf2x_mod_div_sac(IN ctx_t *ctx, IN poly_t *h, IN poly_t *g, OUT poly_t *out);
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Resumable Inversion                                                 *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* State of an inversion run in slices (see gf2x_inv_step.c), owned by
+ * the caller between gf2x_inv_begin and gf2x_inv_finish (or abort) */
+typedef struct {
+    ctx_t       *ctx;
+    int         method;         // BYI, FLT, CEA, TYT or SAC
+    int         pos;            // next operation of the chain or the schedule
+    int         sub;            // next unit of the chain operation
+    int         delta;          // BYI
+    chain_t     chain;          // program of FLT, CEA, TYT or SAC
+    poly_t      *reg;           // chain.num_regs registers (with g and ginv)
+    byi_plan_t  *byi;           // copy of the BYI schedule of ctx
+    uint64_t    *ws;            // workspace of BYI, of byi->ws_size blocks
+} gf2x_inv_state_t;
+
+// Start g^-1 mod (x^p - 1) by a method (or the fastest one for 0)
+void gf2x_inv_begin(OUT gf2x_inv_state_t *st, IN ctx_t *ctx, IN int method, IN poly_t *g);
+
+// Run the inversion for about budget cycles (at least a single unit of work),
+// and return 1 if it is done
+int  gf2x_inv_step(INPLACE gf2x_inv_state_t *st, IN unsigned long long budget);
+
+// Run the rest of the inversion (if any), ginv <- g^-1, and free the state
+void gf2x_inv_finish(INPLACE gf2x_inv_state_t *st, OUT poly_t *ginv);
+
+// Free the state of an unfinished inversion
+void gf2x_inv_abort(INPLACE gf2x_inv_state_t *st);
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Plans and Wisdom                                                    *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* Flags of gf2x_plan_create */
+#define GF2X_PLAN_ESTIMATE      0x0     // the defaults of config.h, without measuring
+#define GF2X_PLAN_MEASURE       0x1     // measure the candidates of each tunable
+#define GF2X_PLAN_WISDOM_ONLY   0x2     // only from the wisdom, or NULL
+#define GF2X_PLAN_WORKER        0x4     // for a worker thread, i.e. BYI without an OpenMP team
+
+/* Inversion plan of a ring, i.e. the tunables and the inversion method
+ * (BYI or a chain) with their scratch, so that gf2x_plan_inv and
+ * gf2x_mod_inv_batch_plan allocate nothing and only read the plan
+ * (not gf2x_tune nor ctx->byi). A plan is used by a single thread at a time. */
+typedef struct {
+    ctx_t       *ctx;
+    gf2x_tune_t tune;
+    int         inv_method;
+    byi_plan_t  byi;            // schedule of BYI by tune
+    chain_t     chain;          // program of FLT, CEA, TYT or SAC
+    poly_t      *tmp;           // chain.num_regs - 2 temporaries
+    uint64_t    *ws;            // byi.ws_size blocks for BYI
+    uint64_t    *scratch;       // gf2x_mod_scratch blocks of the products and squarings
+    poly_t      batch[4];       // temporaries of gf2x_mod_inv_batch_plan
+} gf2x_plan_t;
+
+// Plan of ctx->p for the host, from the wisdom if it has an entry of p,
+// or by the flags (recorded in the wisdom for GF2X_PLAN_MEASURE).
+// Neither gf2x_tune nor ctx->inv_method and ctx->byi are changed.
+gf2x_plan_t *gf2x_plan_create(INPLACE ctx_t *ctx, IN int flags);
+void gf2x_plan_destroy(INPLACE gf2x_plan_t *plan);
+
+// Apply the tunables and the method of the plan to gf2x_tune and ctx,
+// for the inversions without a plan (the only change of the globals)
+void gf2x_plan_apply(IN gf2x_plan_t *plan);
+
+// g^-1 mod (x^p - 1) in constant time by the plan
+void gf2x_plan_inv(INPLACE gf2x_plan_t *plan, IN poly_t *g, OUT poly_t *ginv);
+
+// gf2x_mod_inv_batch by the plan, i.e. its single inversion in its scratch
+int  gf2x_mod_inv_batch_plan(INPLACE gf2x_plan_t *plan, IN int n, IN poly_t *g, OUT poly_t *ginv);
+
+// Save or load the wisdom, i.e. the tunables and the methods measured
+// for each p and CPU, and return the number of entries (-1 on failure)
+int  gf2x_wisdom_export(IN const char *path);
+int  gf2x_wisdom_import(IN const char *path);
+void gf2x_wisdom_forget(void);
+
+// Inversion method of the wisdom of p for the host (see gf2x_mod_inv), or 0
+int  gf2x_wisdom_method(IN int p);
+
+// Name of the CPU (without spaces), as the key of the wisdom
+void gf2x_cpu_name(OUT char name[49]);
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Thread Pool                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* Persistent workers, each pinned to a CPU with a plan of its own
+ * (see gf2x_pool.c) */
+typedef struct gf2x_pool_s gf2x_pool_t;
+
+// Pool of num_threads workers (one per CPU of the process for 0), whose
+// plans are created by the flags of gf2x_plan_create (NULL if there is none)
+gf2x_pool_t *gf2x_pool_create(INPLACE ctx_t *ctx, IN int num_threads, IN int flags);
+void gf2x_pool_destroy(INPLACE gf2x_pool_t *pool);
+int  gf2x_pool_threads(IN gf2x_pool_t *pool);
+
+// ginv[i] <- g[i]^-1 for 0 <= i < n by the workers, in constant time,
+// and the number of invertible g[i] (zero ginv[i] for the others).
+// Thread-safe, i.e. the calls of any number of threads are queued.
+int gf2x_pool_inv_batch(INPLACE gf2x_pool_t *pool, IN int n, IN poly_t *g, OUT poly_t *ginv);
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Inversion Service                                                   *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* Asynchronous inversions, by a submission ring of the clients and a
+ * completion ring of each client (see gf2x_service.c) */
+typedef struct gf2x_svc_s gf2x_svc_t;
+typedef struct gf2x_svc_client_s gf2x_svc_client_t;
+
+/* Request, and then its completion */
+typedef struct {
+    uint64_t            user_data;
+    poly_t              *g;
+    poly_t              *ginv;          // g^-1 (or 0), written by the service
+    int                 invertible;
+    gf2x_svc_client_t   *client;
+    uint64_t            t_submit;       // time stamps in nanoseconds
+    uint64_t            t_start;
+    uint64_t            t_done;
+} gf2x_svc_cqe_t;
+
+// Service of num_threads workers, whose plans are created by the flags of
+// gf2x_plan_create (NULL if there is none). It is destroyed after the
+// requests already submitted.
+gf2x_svc_t *gf2x_svc_create(INPLACE ctx_t *ctx, IN int num_threads, IN int flags);
+void gf2x_svc_destroy(INPLACE gf2x_svc_t *svc);
+
+// Client of at most depth requests in flight, used by a single thread
+gf2x_svc_client_t *gf2x_svc_client_create(INPLACE gf2x_svc_t *svc, IN int depth);
+void gf2x_svc_client_destroy(INPLACE gf2x_svc_client_t *c);
+
+// Submit ginv <- g^-1 without blocking, i.e. 1, or 0 if the client or 
+// the service is full (g and ginv are owned by the service until the completion)
+int gf2x_svc_submit(INPLACE gf2x_svc_client_t *c, IN poly_t *g, OUT poly_t *ginv, IN uint64_t user_data);
+
+// At most max completions of the client, waiting for one if wait is set
+// (and a request is in flight), and their number
+int gf2x_svc_reap(INPLACE gf2x_svc_client_t *c, OUT gf2x_svc_cqe_t *cqe, IN int max, IN int wait);
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Inversion Daemon                                                    *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* Inversions and multiplications by worker processes, through a Unix
+ * socket and the shared-memory rings of each client (see gf2x_shm.c) */
+typedef struct gf2x_shm_client_s gf2x_shm_client_t;
+
+#define GF2X_SHM_INV    1       // out <- a^-1
+#define GF2X_SHM_MUL    2       // out <- a * b
+
+/* Request, and then its completion */
+typedef struct {
+    uint64_t            user_data;
+    uint32_t            op;
+    uint32_t            slot;
+    uint32_t            seq;
+    int32_t             status;         // 0, 1 if a is not invertible (out is zero),
+                                        // or -1 for an invalid request
+    uint64_t            t_submit;       // time stamps in nanoseconds (CLOCK_MONOTONIC)
+    uint64_t            t_done;
+} gf2x_shm_cqe_t;
+
+// Serve on the Unix socket path by num_workers processes, pinned to the
+// NUMA nodes (numa) or to the CPUs, whose plans are created by the flags 
+// of gf2x_plan_create, until SIGTERM or SIGINT (-1 on an error)
+int gf2x_shm_serve(INPLACE ctx_t *ctx, IN const char *path, IN int num_workers, IN int flags, IN int numa);
+
+// Client of at most depth requests in flight (NULL if the daemon refuses 
+// it, and always off Linux), used by a single thread
+gf2x_shm_client_t *gf2x_shm_connect(IN const char *path, IN int depth);
+void gf2x_shm_close(INPLACE gf2x_shm_client_t *c);
+int gf2x_shm_depth(IN gf2x_shm_client_t *c);
+int gf2x_shm_worker(IN gf2x_shm_client_t *c);
+
+// Polynomial a (0), b (1) or out (2) of a slot, in the shared memory
+poly_t *gf2x_shm_poly(INPLACE gf2x_shm_client_t *c, IN int slot, IN int which);
+
+// Submit the operation of a slot without blocking, i.e. 1, or 0 if the 
+// client is full or the slot is in flight
+int gf2x_shm_submit(INPLACE gf2x_shm_client_t *c, IN int op, IN int slot, IN uint64_t user_data);
+
+// At most max completions, waiting for one if wait is set (and a request
+// is in flight), and their number
+int gf2x_shm_reap(INPLACE gf2x_shm_client_t *c, OUT gf2x_shm_cqe_t *cqe, IN int max, IN int wait);
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Serialization                                                       *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* Packed form of a polynomial, i.e. ceil(r/8) little-endian bytes whose
+ * bits from r on are zero (the BIKE format), and its hex form (see gf2x_codec.c) */
+#define GF2X_PACKED_BYTES   ((EXT_DEG + 7) / 8)
+#define GF2X_HEX_CHARS      (2 * GF2X_PACKED_BYTES)
+
+// bytes <- the packed form of f (GF2X_PACKED_BYTES bytes)
+void gf2x_poly_pack(IN poly_t *f, OUT uint8_t *bytes);
+
+// f <- the polynomial of the packed form, and whether its padding is zero
+int gf2x_poly_unpack(OUT poly_t *f, IN const uint8_t *bytes);
+
+// hex <- the 2n hex digits of n bytes (without a terminating zero)
+void gf2x_hex_encode(IN const uint8_t *in, IN size_t n, OUT char *hex);
+
+// out <- the n bytes of 2n hex digits (of either case), and whether they are all digits
+int gf2x_hex_decode(IN const char *hex, IN size_t n, OUT uint8_t *out);
+
+// hex <- the hex form of f (GF2X_HEX_CHARS digits and a terminating zero)
+void gf2x_poly_to_hex(IN poly_t *f, OUT char *hex);
+
+// f <- the polynomial of a hex form, and whether it is valid (f = 0 if not all digits)
+int gf2x_poly_from_hex(OUT poly_t *f, IN const char *hex);
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
  * Helper functions                                                    *
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
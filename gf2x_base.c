@@ -111,3 +111,19 @@ void gf2x_poly_copy(OUT poly_t *b, IN poly_t *a) {
         b->data[i] = a->data[i];
     }
 }
+
+
+/************************************
+ * Context Initialization
+ ************************************/
+
+// Precomputations for ctx, i.e. the BYI schedule 
+// of BYI_DIVSTEPS(p) divsteps, and the parameters of 
+// CEA, TYT and SAC if p has no entry in params.h
+void gf2x_ctx_init(INPLACE ctx_t *ctx) {
+    gf2x_byi_plan(&(ctx->byi), &gf2x_tune, ctx->p, BYI_DIVSTEPS(ctx->p));
+
+    if (ctx->cea_a == 0) {
+        gf2x_params_search(ctx, NULL);
+    }
+}
@@ -0,0 +1,279 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Emrah Karagoz, Pakize Sanal, Abhraneel Dutta, Edoardo Persichetti
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gf2x.h"
+
+/*********************************************************
+ * Exponentiation programs of addition chains
+ *
+ * A chain is a list of values, where v_0 is the input g and
+ *     v_(i+1) <- v_src^(2^k) * v_mul    (or v_src^(2^k) for mul < 0)
+ * is defined by the i-th operation, and the last value is the output.
+ *
+ * The chain is compiled to registers (polynomials) by liveness:
+ * a value is kept in a register until its last use, and the
+ * register is then reused. The register of src is squared in-place
+ * at its last use, and otherwise the first squaring writes into a
+ * new register, so that no value is ever copied.
+ *
+ * Registers: CHAIN_REG_IN (the input, never written),
+ *            CHAIN_REG_OUT (the output, only for the last value),
+ *            and the temporaries.
+**********************************************************/
+
+// Empty chain, i.e. the input v_0 only
+void gf2x_chain_init(OUT chain_t *chain) {
+    chain->num_ops = 0;
+    chain->num_regs = 2;
+}
+
+// Append v <- v_src^(2^k) * v_mul, and return v
+int gf2x_chain_op(
+    INPLACE chain_t *chain,
+    IN int src,
+    IN int k,
+    IN int mul
+) {
+    assert(chain->num_ops < CHAIN_MAX_OPS);
+    assert(src <= chain->num_ops && mul <= chain->num_ops);
+    assert(k >= 0);
+
+    chain_op_t *op = &chain->op[chain->num_ops];
+    op->src = src;
+    op->k   = k;
+    op->mul = mul;
+
+    chain->num_ops += 1;
+    return chain->num_ops;
+}
+
+// Register allocation of the values by their last uses
+void gf2x_chain_compile(INPLACE chain_t *chain) {
+    int n = chain->num_ops;
+    assert(n > 0);
+
+    // Last use of each value (n for the output)
+    int last[CHAIN_MAX_OPS + 1];
+    for (int v = 0; v <= n; v++) {
+        last[v] = -1;
+    }
+    for (int i = 0; i < n; i++) {
+        last[chain->op[i].src] = i;
+        if (chain->op[i].mul >= 0) {
+            last[chain->op[i].mul] = i;
+        }
+    }
+
+    // Register of each value, and the stack of free temporaries
+    int reg[CHAIN_MAX_OPS + 1];
+    int free_regs[CHAIN_MAX_OPS + 2];
+    int num_free = 0;
+    int num_regs = 2;
+
+    reg[0] = CHAIN_REG_IN;
+
+    for (int i = 0; i < n; i++) {
+        chain_op_t *op = &chain->op[i];
+        int dst;
+
+        op->rsrc = reg[op->src];
+        op->rmul = (op->mul >= 0) ? reg[op->mul] : -1;
+
+        if (i == n - 1) {
+            dst = CHAIN_REG_OUT;
+        } else if (last[op->src] == i && op->src != 0 && op->mul != op->src) {
+            // In-place at the last use of src
+            dst = op->rsrc;
+        } else if (num_free > 0) {
+            dst = free_regs[--num_free];
+        } else {
+            dst = num_regs++;
+        }
+        op->rdst = dst;
+        reg[i + 1] = dst;
+
+        // Release the registers of src and mul at their last use
+        if (last[op->src] == i && op->src != 0 && op->rsrc != dst) {
+            free_regs[num_free++] = op->rsrc;
+        }
+        if (op->mul >= 0 && op->mul != op->src && last[op->mul] == i && op->mul != 0) {
+            free_regs[num_free++] = op->rmul;
+        }
+
+        // A value which is never used does not keep its register
+        if (last[i + 1] < 0 && i < n - 1) {
+            free_regs[num_free++] = dst;
+        }
+    }
+
+    chain->num_regs = num_regs;
+}
+
+// c <- a * b by the Karatsuba transform of tune in the scratch ws, 
+// or by the schoolbook gf2x_mod_mul without a scratch (i.e. the 
+// multiplications counted by test_count)
+static inline void chain_mul(
+    IN  gf2x_tune_t *tune,
+    IN  poly_t *a,
+    IN  poly_t *b,
+    OUT poly_t *c,
+    uint64_t *ws
+) {
+    if (ws != NULL) {
+        gf2x_mod_mul_kara_tune(tune, a, b, c, ws);
+    } else {
+        gf2x_mod_mul(a, b, c);
+    }
+}
+
+// out <- the last value of the compiled chain for v_0 = g, by the
+// kernels of tune, with the temporary registers in tmp (num_regs - 2 polynomials),
+// and the scratch ws of the kernels (see chain_mul), which may be NULL
+void gf2x_chain_exec(
+    IN  chain_t *chain,
+    IN  gf2x_tune_t *tune,
+    IN  poly_t *g,
+    OUT poly_t *out,
+    poly_t *tmp,
+    uint64_t *ws
+) {
+    poly_t *R[CHAIN_MAX_OPS + 2];
+
+    R[CHAIN_REG_IN]  = g;
+    R[CHAIN_REG_OUT] = out;
+    for (int i = 0; i < chain->num_regs - 2; i++) {
+        R[2 + i] = &tmp[i];
+    }
+
+    for (int i = 0; i < chain->num_ops; i++) {
+        chain_op_t *op = &chain->op[i];
+        poly_t *dst = R[op->rdst];
+        poly_t *src = R[op->rsrc];
+
+        if (op->rsrc == op->rdst) {
+            gf2x_mod_sqr_k_inplace_tune(tune, dst, op->k, ws);
+        } else if (op->k > 0) {
+            gf2x_mod_sqr_tune(tune, src, dst, ws);
+            if (op->k > 1) {
+                gf2x_mod_sqr_k_inplace_tune(tune, dst, op->k - 1, ws);
+            }
+        } else if (op->mul >= 0) {
+            chain_mul(tune, src, R[op->rmul], dst, ws);
+            continue;
+        } else {
+            gf2x_poly_copy(dst, src);
+        }
+
+        if (op->mul >= 0) {
+            chain_mul(tune, dst, R[op->rmul], dst, ws);
+        }
+    }
+}
+
+// out <- the last value of the compiled chain for v_0 = g
+void gf2x_chain_run(
+    IN  chain_t *chain,
+    IN  poly_t *g,
+    OUT poly_t *out
+) {
+    int num_tmp = chain->num_regs - 2;
+    poly_t tmp[num_tmp > 0 ? num_tmp : 1];
+
+    for (int i = 0; i < num_tmp; i++) {
+        gf2x_poly_init(&tmp[i], EXT_DEG - 1);
+    }
+
+    gf2x_chain_exec(chain, &gf2x_tune, g, out, tmp, NULL);
+
+    for (int i = 0; i < num_tmp; i++) {
+        gf2x_poly_free(&tmp[i]);
+    }
+}
+
+// Cost of the chain, i.e. its squarings and multiplications
+double gf2x_chain_cost(
+    IN chain_t *chain,
+    IN cost_model_t *cost
+) {
+    double c = 0;
+    for (int i = 0; i < chain->num_ops; i++) {
+        c += chain->op[i].k * cost->sqr;
+        if (chain->op[i].mul >= 0) {
+            c += cost->mul;
+        }
+    }
+    return c;
+}
+
+// e <- the exponent of the last value (mod 2^(64 * nwords)), 
+// i.e. the chain computes g^e
+void gf2x_chain_exponent(
+    IN  chain_t *chain,
+    OUT uint64_t *e,
+    IN  int nwords
+) {
+    int n = chain->num_ops;
+    uint64_t *E = calloc((size_t) (n + 1) * nwords, sizeof(uint64_t));
+    assert(E != NULL);
+
+    // v_0 = g^1
+    E[0] = 1;
+
+    for (int i = 0; i < n; i++) {
+        chain_op_t *op = &chain->op[i];
+        uint64_t *dst = &E[(i + 1) * nwords];
+        uint64_t *src = &E[op->src * nwords];
+        int bs = op->k / 64;
+        int k  = op->k % 64;
+
+        // dst <- src * 2^k
+        for (int j = nwords - 1; j >= bs; j--) {
+            uint64_t w = src[j - bs] << k;
+            if (k > 0 && j - bs > 0) {
+                w |= src[j - bs - 1] >> (64 - k);
+            }
+            dst[j] = w;
+        }
+
+        // dst <- dst + mul
+        if (op->mul >= 0) {
+            uint64_t *mul = &E[op->mul * nwords];
+            uint64_t carry = 0;
+            for (int j = 0; j < nwords; j++) {
+                uint64_t s = dst[j] + mul[j];
+                uint64_t c = (s < dst[j]);
+                dst[j] = s + carry;
+                carry = c | (dst[j] < s);
+            }
+        }
+    }
+
+    memcpy(e, &E[n * nwords], nwords * sizeof(uint64_t));
+    free(E);
+}
@@ -0,0 +1,269 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Emrah Karagoz, Pakize Sanal, Abhraneel Dutta, Edoardo Persichetti
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "gf2x.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/*********************************************************
+ * Serialization of polynomials
+ *
+ * The packed form of a polynomial of degree < r is its 
+ * GF2X_PACKED_BYTES = ceil(r/8) bytes, where the coefficient of x^i 
+ * is the bit i % 8 of the byte i / 8 (the BIKE wire format), and the 
+ * bits from r on (the padding) are zero. On a little-endian host,
+ * it is the prefix of the blocks of poly_t in memory, so that packing
+ * and unpacking are copies with a mask of the last byte.
+ *
+ * The hex form is 2 lowercase digits for each byte of the packed 
+ * form, in its order (i.e. the first byte first, its high nibble 
+ * first), and both cases are decoded. The hex codecs convert 32
+ * (AVX-512) or 16 (AVX2) bytes at a time:
+ *     encode  each byte is widened to 16 bits, whose low byte is its
+ *             high nibble and high byte its low nibble, i.e. the
+ *             digits in order, which a byte shuffle maps to ASCII
+ *     decode  the value of each digit is selected by the range 
+ *             checks of '0'-'9' and 'a'-'f' (of c | 0x20), and the 
+ *             pairs are combined by multiply-add (16 * hi + lo) and 
+ *             narrowed back to bytes
+**********************************************************/
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    #define CODEC_BIG_ENDIAN
+#endif
+
+// Mask of the last packed byte, i.e. of the bits below r
+#define PAD_MASK    ((EXT_DEG % 8) ? (uint8_t) ((1u << (EXT_DEG % 8)) - 1) : (uint8_t) 0xff)
+
+static const char hex_digits[16] = {
+    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'
+};
+
+/************************************
+ * PACKED BYTES
+ ************************************/
+
+// bytes <- the packed form of f
+void gf2x_poly_pack(
+    IN  poly_t *f,
+    OUT uint8_t *bytes
+) {
+    assert(f->size64 == NUM_BLOCKS);
+
+#if !defined(CODEC_BIG_ENDIAN)
+    memcpy(bytes, f->data, GF2X_PACKED_BYTES - 1);
+    bytes[GF2X_PACKED_BYTES - 1] = ((const uint8_t *) f->data)[GF2X_PACKED_BYTES - 1] & PAD_MASK;
+#else
+    for (int j = 0; j < GF2X_PACKED_BYTES; j++) {
+        bytes[j] = (uint8_t) (f->data[j / 8] >> (8 * (j % 8)));
+    }
+    bytes[GF2X_PACKED_BYTES - 1] &= PAD_MASK;
+#endif
+}
+
+// f <- the polynomial of the packed form, and whether its padding is zero
+// (otherwise the padding is dropped)
+int gf2x_poly_unpack(
+    OUT poly_t *f,
+    IN  const uint8_t *bytes
+) {
+    assert(f->size64 == NUM_BLOCKS);
+
+#if !defined(CODEC_BIG_ENDIAN)
+    f->data[NUM_BLOCKS - 1] = 0;
+    memcpy(f->data, bytes, GF2X_PACKED_BYTES);
+    ((uint8_t *) f->data)[GF2X_PACKED_BYTES - 1] &= PAD_MASK;
+#else
+    memset(f->data, 0, NUM_BLOCKS * sizeof(uint64_t));
+    for (int j = 0; j < GF2X_PACKED_BYTES; j++) {
+        uint8_t b = (j == GF2X_PACKED_BYTES - 1) ? (bytes[j] & PAD_MASK) : bytes[j];
+        f->data[j / 8] |= (uint64_t) b << (8 * (j % 8));
+    }
+#endif
+    return (bytes[GF2X_PACKED_BYTES - 1] & ~PAD_MASK) == 0;
+}
+
+/************************************
+ * HEX
+ ************************************/
+
+// hex <- the 2n digits of the n bytes of in (without a terminating zero)
+void gf2x_hex_encode(
+    IN  const uint8_t *in,
+    IN  size_t n,
+    OUT char *hex
+) {
+    size_t j = 0;
+
+#if defined(__AVX512BW__)
+    const __m512i digits = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *) hex_digits));
+    const __m512i low = _mm512_set1_epi16(0x0f);
+    for (; j + 32 <= n; j += 32) {
+        __m512i w = _mm512_cvtepu8_epi16(_mm256_loadu_si256((const __m256i *) (in + j)));
+        w = _mm512_or_si512(_mm512_srli_epi16(w, 4), _mm512_slli_epi16(_mm512_and_si512(w, low), 8));
+        _mm512_storeu_si512((void *) (hex + 2 * j), _mm512_shuffle_epi8(digits, w));
+    }
+#endif
+#if defined(__AVX2__)
+    const __m256i digits2 = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) hex_digits));
+    const __m256i low2 = _mm256_set1_epi16(0x0f);
+    for (; j + 16 <= n; j += 16) {
+        __m256i w = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *) (in + j)));
+        w = _mm256_or_si256(_mm256_srli_epi16(w, 4), _mm256_slli_epi16(_mm256_and_si256(w, low2), 8));
+        _mm256_storeu_si256((__m256i *) (hex + 2 * j), _mm256_shuffle_epi8(digits2, w));
+    }
+#endif
+    for (; j < n; j++) {
+        hex[2 * j]     = hex_digits[in[j] >> 4];
+        hex[2 * j + 1] = hex_digits[in[j] & 0x0f];
+    }
+}
+
+// Value of a hex digit (without branches, since digits and letters
+// are mixed at random), and whether it is one
+static inline unsigned hex_value(char c, unsigned *valid) {
+    unsigned x = (unsigned char) c;
+    unsigned d = x - '0';
+    unsigned a = (x | 0x20) - 'a';
+    *valid &= (d < 10) | (a < 6);
+    return (x & 0x0f) + 9 * ((x >> 6) & 1);
+}
+
+#if defined(__AVX2__)
+// Values of the 32 digits of c, and the mask of the valid ones
+static inline __m256i hex_values_avx2(__m256i c, uint32_t *valid) {
+    __m256i d = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+    __m256i a = _mm256_sub_epi8(_mm256_or_si256(c, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    __m256i is_d = _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(9)), d);
+    __m256i is_a = _mm256_cmpeq_epi8(_mm256_min_epu8(a, _mm256_set1_epi8(5)), a);
+    *valid = (uint32_t) _mm256_movemask_epi8(_mm256_or_si256(is_d, is_a));
+    return _mm256_blendv_epi8(d, _mm256_add_epi8(a, _mm256_set1_epi8(10)), is_a);
+}
+#endif
+
+// out <- the n bytes of the 2n digits of hex, and whether they are all
+// hex digits (otherwise out is undefined)
+int gf2x_hex_decode(
+    IN  const char *hex,
+    IN  size_t n,
+    OUT uint8_t *out
+) {
+    size_t j = 0;
+
+#if defined(__AVX512BW__)
+    const __m512i zero = _mm512_set1_epi8('0');
+    const __m512i case_bit = _mm512_set1_epi8(0x20);
+    const __m512i alpha = _mm512_set1_epi8('a');
+    const __m512i pairs = _mm512_set1_epi16(0x0110);
+    for (; j + 32 <= n; j += 32) {
+        __m512i c = _mm512_loadu_si512((const void *) (hex + 2 * j));
+        __m512i d = _mm512_sub_epi8(c, zero);
+        __m512i a = _mm512_sub_epi8(_mm512_or_si512(c, case_bit), alpha);
+        __mmask64 is_d = _mm512_cmplt_epu8_mask(d, _mm512_set1_epi8(10));
+        __mmask64 is_a = _mm512_cmplt_epu8_mask(a, _mm512_set1_epi8(6));
+        if ((is_d | is_a) != ~0ULL) {
+            return 0;
+        }
+        __m512i v = _mm512_mask_add_epi8(d, is_a, a, _mm512_set1_epi8(10));
+        __m512i w = _mm512_maddubs_epi16(v, pairs);
+        _mm256_storeu_si256((__m256i *) (out + j), _mm512_cvtepi16_epi8(w));
+    }
+#endif
+#if defined(__AVX2__)
+    const __m256i pairs2 = _mm256_set1_epi16(0x0110);
+    for (; j + 16 <= n; j += 16) {
+        uint32_t valid;
+        __m256i v = hex_values_avx2(_mm256_loadu_si256((const __m256i *) (hex + 2 * j)), &valid);
+        if (valid != 0xffffffffu) {
+            return 0;
+        }
+        __m256i w = _mm256_maddubs_epi16(v, pairs2);
+        w = _mm256_permute4x64_epi64(_mm256_packus_epi16(w, w), 0xd8);
+        _mm_storeu_si128((__m128i *) (out + j), _mm256_castsi256_si128(w));
+    }
+#endif
+    unsigned valid = 1;
+    for (; j < n; j++) {
+        unsigned hi = hex_value(hex[2 * j], &valid);
+        unsigned lo = hex_value(hex[2 * j + 1], &valid);
+        out[j] = (uint8_t) (16 * hi + lo);
+    }
+    return (int) valid;
+}
+
+// hex <- the 2 * GF2X_PACKED_BYTES digits of the packed form of f, 
+// and a terminating zero
+void gf2x_poly_to_hex(
+    IN  poly_t *f,
+    OUT char *hex
+) {
+    assert(f->size64 == NUM_BLOCKS);
+
+#if !defined(CODEC_BIG_ENDIAN)
+    uint8_t last = ((const uint8_t *) f->data)[GF2X_PACKED_BYTES - 1] & PAD_MASK;
+    gf2x_hex_encode((const uint8_t *) f->data, GF2X_PACKED_BYTES - 1, hex);
+    hex[2 * GF2X_PACKED_BYTES - 2] = hex_digits[last >> 4];
+    hex[2 * GF2X_PACKED_BYTES - 1] = hex_digits[last & 0x0f];
+#else
+    uint8_t bytes[GF2X_PACKED_BYTES];
+    gf2x_poly_pack(f, bytes);
+    gf2x_hex_encode(bytes, GF2X_PACKED_BYTES, hex);
+#endif
+    hex[2 * GF2X_PACKED_BYTES] = '\0';
+}
+
+// f <- the polynomial of the 2 * GF2X_PACKED_BYTES digits of hex, and
+// whether they are hex digits of a packed form (i.e. of a zero padding)
+int gf2x_poly_from_hex(
+    OUT poly_t *f,
+    IN  const char *hex
+) {
+    assert(f->size64 == NUM_BLOCKS);
+
+#if !defined(CODEC_BIG_ENDIAN)
+    f->data[NUM_BLOCKS - 1] = 0;
+    uint8_t *bytes = (uint8_t *) f->data;
+    if (!gf2x_hex_decode(hex, GF2X_PACKED_BYTES, bytes)) {
+        gf2x_poly_zeroize(f);
+        return 0;
+    }
+    int canonical = (bytes[GF2X_PACKED_BYTES - 1] & ~PAD_MASK) == 0;
+    bytes[GF2X_PACKED_BYTES - 1] &= PAD_MASK;
+    return canonical;
+#else
+    uint8_t bytes[GF2X_PACKED_BYTES];
+    if (!gf2x_hex_decode(hex, GF2X_PACKED_BYTES, bytes)) {
+        gf2x_poly_zeroize(f);
+        return 0;
+    }
+    return gf2x_poly_unpack(f, bytes);
+#endif
+}
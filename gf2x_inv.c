@@ -0,0 +1,201 @@
+/* 
+ * MIT License
+ *
+ * Copyright (c) 2024 Emrah Karagoz, Pakize Sanal, Abhraneel Dutta, Edoardo Persichetti
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#endif
+
+#include "bench.h"
+#include "gf2x.h"
+
+/*********************************************************
+ * Inversion by the fastest algorithm of the host
+ *
+ * On the first use of ctx, gf2x_mod_inv takes the method of the
+ * wisdom of p and the CPU (see gf2x_plan.c), or otherwise benchmarks
+ * BYI, FLT, CEA, TYT and SAC (the median of GF2X_SELECT_RUNS 
+ * inversions each), and keeps the fastest one in ctx->inv_method.
+ * A plan measured by GF2X_PLAN_MEASURE records the method in the
+ * wisdom, so that the later runs do not benchmark anything.
+**********************************************************/
+
+typedef void (*inv_func_t)(ctx_t *ctx, poly_t *g, poly_t *ginv);
+
+static const struct {
+    int method;
+    const char *name;
+    inv_func_t inv;
+} inv_methods[] = {
+    { BYI, "BYI", gf2x_mod_inv_byi },
+    { FLT, "FLT", gf2x_mod_inv_flt },
+    { CEA, "CEA", gf2x_mod_inv_cea },
+    { TYT, "TYT", gf2x_mod_inv_tyt },
+    { SAC, "SAC", gf2x_mod_inv_sac },
+};
+
+#define NUM_INV_METHODS ((int) (sizeof(inv_methods) / sizeof(inv_methods[0])))
+
+// Name of an inversion method (BYI, FLT, ...), or NULL
+const char *gf2x_inv_name(IN int method) {
+    for (int i = 0; i < NUM_INV_METHODS; i++) {
+        if (inv_methods[i].method == method) {
+            return inv_methods[i].name;
+        }
+    }
+    return NULL;
+}
+
+// g^-1 mod (x^p - 1) by the given method
+void gf2x_mod_inv_method(
+    IN  ctx_t *ctx,
+    IN  int method,
+    IN  poly_t *g,
+    OUT poly_t *ginv
+) {
+    for (int i = 0; i < NUM_INV_METHODS; i++) {
+        if (inv_methods[i].method == method) {
+            inv_methods[i].inv(ctx, g, ginv);
+            return;
+        }
+    }
+    assert(0 && "Invalid inversion method!");
+}
+
+// Chain of an FLT-based method (FLT, CEA, TYT or SAC) of ctx
+void gf2x_chain_method(
+    IN  ctx_t *ctx,
+    IN  int method,
+    OUT chain_t *chain
+) {
+    // Parameters of a prime without its entry in params.h
+    if (method != FLT && ctx->cea_a == 0) {
+        gf2x_params_search(ctx, NULL);
+    }
+
+    switch (method) {
+        case FLT: gf2x_chain_flt(ctx, chain); break;
+        case CEA: gf2x_chain_cea(ctx, chain); break;
+        case TYT: gf2x_chain_tyt(ctx, chain); break;
+        case SAC: gf2x_chain_sac(ctx, chain); break;
+        default:  assert(0 && "Not a chain method!");
+    }
+}
+
+// Name of the CPU (without spaces), as the key of the wisdom
+void gf2x_cpu_name(OUT char name[49]) {
+    strcpy(name, "unknown");
+
+    #if defined(__x86_64__)
+    unsigned int r[12];
+    if (__get_cpuid(0x80000002, &r[0], &r[1], &r[2],  &r[3]) &&
+        __get_cpuid(0x80000003, &r[4], &r[5], &r[6],  &r[7]) &&
+        __get_cpuid(0x80000004, &r[8], &r[9], &r[10], &r[11])) {
+        memcpy(name, r, 48);
+        name[48] = '\0';
+    }
+    #elif defined(__aarch64__)
+    strcpy(name, "aarch64");
+    #endif
+
+    // Trim, and replace the spaces by '_'
+    char *s = name;
+    while (*s == ' ') s++;
+    memmove(name, s, strlen(s) + 1);
+    for (int i = strlen(name) - 1; i >= 0 && name[i] == ' '; i--) {
+        name[i] = '\0';
+    }
+    for (s = name; *s; s++) {
+        if (*s == ' ') *s = '_';
+    }
+}
+
+// Select the fastest inversion method for ctx (see above)
+int gf2x_inv_select(INPLACE ctx_t *ctx) {
+    ctx->inv_method = gf2x_wisdom_method(ctx->p);
+    if (ctx->inv_method) {
+        return ctx->inv_method;
+    }
+
+    poly_t g, ginv;
+    gf2x_poly_init(&g, ctx->p - 1);
+    gf2x_poly_init(&ginv, ctx->p - 1);
+    gf2x_poly_random_coprime(&g);
+
+    bench_t bench;
+    bench_init(&bench, GF2X_SELECT_RUNS, NULL);
+
+    // (BENCHFUNC loops over i)
+    unsigned long long best = 0;
+    for (int m = 0; m < NUM_INV_METHODS; m++) {
+        inv_func_t inv = inv_methods[m].inv;
+
+        // The first run computes the precomputations of ctx (if any)
+        inv(ctx, &g, &ginv);
+
+        BENCHFUNC(bench, inv(ctx, &g, &ginv));
+        if (m == 0 || bench.stats.med < best) {
+            best = bench.stats.med;
+            ctx->inv_method = inv_methods[m].method;
+        }
+    }
+
+    bench_free(&bench);
+    gf2x_poly_free(&g);
+    gf2x_poly_free(&ginv);
+    return ctx->inv_method;
+}
+
+// g^-1 mod (x^p - 1) in constant time, by the fastest algorithm
+void gf2x_mod_inv(
+    IN  ctx_t *ctx,
+    IN  poly_t *g,
+    OUT poly_t *ginv
+) {
+    if (ctx->inv_method == 0) {
+        gf2x_inv_select(ctx);
+    }
+    gf2x_mod_inv_method(ctx, ctx->inv_method, g, ginv);
+}
+
+// h * g^-1 mod (x^p - 1) in constant time, by the fastest algorithm
+void gf2x_mod_div(
+    IN ctx_t *ctx,
+    IN poly_t *h,
+    IN poly_t *g,
+    OUT poly_t *out
+) {
+    poly_t ginv;
+    gf2x_poly_init(&ginv, ctx->p - 1);
+    gf2x_poly_zeroize(&ginv);
+
+    gf2x_mod_inv(ctx, g, &ginv);
+    gf2x_mod_mul_kara(h, &ginv, out);
+
+    gf2x_poly_free(&ginv);
+}
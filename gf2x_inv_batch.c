@@ -0,0 +1,232 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Emrah Karagoz, Pakize Sanal, Abhraneel Dutta, Edoardo Persichetti
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gf2x.h"
+
+/*********************************************************
+ * Batch inversion (Montgomery's simultaneous inversion)
+ *
+ * The n inverses of g_0, ..., g_(n-1) are computed from a single
+ * inversion of their product:
+ *     a_i = g_0 * ... * g_i,   b = a_(n-1)^-1,
+ *     g_i^-1 = b * a_(i-1),    b <- b * g_i    (i = n-1, ..., 1)
+ * i.e. 3(n-1) multiplications and one inversion by any method.
+ *
+ * A single non-invertible g_i would make the product non-invertible,
+ * so that each g_i is replaced by 1 (in constant time) unless its mask 
+ * says it is invertible. For f = x^p - 1 = (x - 1) * Phi_p, where Phi_p
+ * is irreducible if 2 is primitive modulo p (i.e. for BIKE's primes),
+ * g is invertible if and only if g(1) = 1, i.e. of odd weight, and g is
+ * not Phi_p = 1 + x + ... + x^(p-1). For the other primes, Phi_p has
+ * several factors, which the mask does not see: the product is then 
+ * checked once, and each g_i is inverted alone if it is not invertible
+ * (which only tells that one of them is not invertible).
+**********************************************************/
+
+// 0xFF..FF if x = 0, and 0 otherwise, in constant time
+static inline uint64_t mask_zero(IN uint64_t x) {
+    return ((x | (0 - x)) >> 63) - 1;
+}
+
+// Whether 2 is primitive modulo p, i.e. Phi_p is irreducible
+static int two_is_primitive(IN int p) {
+    int x = 2, ord = 1;
+    while (x != 1) {
+        x = (2 * x) % p;
+        ord++;
+    }
+    return ord == p - 1;
+}
+
+// 0xFF..FF if g is invertible (see above), and 0 otherwise
+static uint64_t inv_mask(IN poly_t *g, IN int p, IN int primitive) {
+    uint64_t parity = 0, ones = 0;
+    int n = (p + 63) / 64;
+
+    for (int i = 0; i < n; i++) {
+        uint64_t full = (i < p / 64) ? ~0ULL : (1ULL << (p % 64)) - 1;
+        parity ^= g->data[i];
+        ones |= g->data[i] ^ full;
+    }
+
+    uint64_t odd = 0 - (uint64_t) (__builtin_popcountll(parity) & 1);
+    uint64_t phi = mask_zero(ones) & (0 - (uint64_t) primitive);
+    return odd & ~phi;
+}
+
+// c <- a if mask, and b otherwise
+static inline void poly_select(OUT poly_t *c, IN poly_t *a, IN poly_t *b, IN uint64_t mask) {
+    for (int i = 0; i < c->size64; i++) {
+        c->data[i] = (a->data[i] & mask) | (b->data[i] & ~mask);
+    }
+}
+
+// c <- c if mask, and 0 otherwise
+static inline void poly_mask(INPLACE poly_t *c, IN uint64_t mask) {
+    for (int i = 0; i < c->size64; i++) {
+        c->data[i] &= mask;
+    }
+}
+
+// Single inversion of the batch, by a method or by a plan,
+// and the tunables, the temporaries and the scratch of the products
+typedef struct {
+    ctx_t       *ctx;
+    int         method;
+    gf2x_plan_t *plan;
+    gf2x_tune_t *tune;
+    poly_t      *tmp;           // one, h, b and t
+    uint64_t    *ws;
+} batch_inv_t;
+
+static inline void batch_inv(IN batch_inv_t *inv, IN poly_t *g, OUT poly_t *ginv) {
+    if (inv->plan != NULL) {
+        gf2x_plan_inv(inv->plan, g, ginv);
+    } else {
+        gf2x_mod_inv_method(inv->ctx, inv->method, g, ginv);
+    }
+}
+
+// ginv[i] <- g[i]^-1 by the single inversion inv, 
+// and the number of invertible g[i]
+static int inv_batch(
+    IN  batch_inv_t *inv,
+    IN  int n,
+    IN  poly_t *g,
+    OUT poly_t *ginv
+) {
+    int p = inv->ctx->p;
+    assert(n >= 1);
+
+    int primitive = two_is_primitive(p);
+    poly_t *one = &inv->tmp[0], *h = &inv->tmp[1], *b = &inv->tmp[2], *t = &inv->tmp[3];
+    gf2x_poly_zeroize(one);
+    one->data[0] = 1;
+
+    // ginv[i] <- a_i, the products of h_i = (g_i if invertible, else 1)
+    for (int i = 0; i < n; i++) {
+        poly_select(h, &g[i], one, inv_mask(&g[i], p, primitive));
+        if (i == 0) {
+            gf2x_poly_copy(&ginv[0], h);
+        } else {
+            gf2x_mod_mul_kara_tune(inv->tune, &ginv[i - 1], h, &ginv[i], inv->ws);
+        }
+    }
+
+    // b <- a_(n-1)^-1, and whether it is the inverse
+    batch_inv(inv, &ginv[n - 1], b);
+    gf2x_mod_mul_kara_tune(inv->tune, &ginv[n - 1], b, t, inv->ws);
+
+    uint64_t acc = t->data[0] ^ 1;
+    for (int i = 1; i < t->size64; i++) {
+        acc |= t->data[i];
+    }
+    uint64_t ok = mask_zero(acc);
+
+    // A hidden non-invertible g_i (see above): each one alone
+    if (n > 1 && !ok) {
+        int count = 0;
+        for (int i = 0; i < n; i++) {
+            count += inv_batch(inv, 1, &g[i], &ginv[i]);
+        }
+        return count;
+    }
+
+    // g_i^-1 = b * a_(i-1), and b <- b * h_i
+    for (int i = n - 1; i > 0; i--) {
+        gf2x_mod_mul_kara_tune(inv->tune, b, &ginv[i - 1], &ginv[i], inv->ws);
+        poly_select(h, &g[i], one, inv_mask(&g[i], p, primitive));
+        gf2x_mod_mul_kara_tune(inv->tune, b, h, b, inv->ws);
+    }
+    gf2x_poly_copy(&ginv[0], b);
+
+    // Zero for the non-invertible inputs (or the single one, see above)
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+        uint64_t mask = inv_mask(&g[i], p, primitive) & ok;
+        poly_mask(&ginv[i], mask);
+        count += (int) (mask & 1);
+    }
+
+    return count;
+}
+
+// ginv[i] <- g[i]^-1 by method (or the fastest one for 0), 
+// and the number of invertible g[i]
+int gf2x_mod_inv_batch_method(
+    IN  ctx_t *ctx,
+    IN  int method,
+    IN  int n,
+    IN  poly_t *g,
+    OUT poly_t *ginv
+) {
+    if (method == 0) {
+        method = ctx->inv_method ? ctx->inv_method : gf2x_inv_select(ctx);
+    }
+
+    // The temporaries and the scratch of the products, once for the batch
+    poly_t tmp[4];
+    for (int k = 0; k < 4; k++) {
+        gf2x_poly_init(&tmp[k], ctx->p - 1);
+    }
+    uint64_t *ws = malloc(gf2x_mod_scratch(&gf2x_tune, tmp[0].size64) * sizeof(uint64_t));
+
+    batch_inv_t inv = { .ctx = ctx, .method = method, .plan = NULL, .tune = &gf2x_tune, .tmp = tmp, .ws = ws };
+    int count = inv_batch(&inv, n, g, ginv);
+
+    free(ws);
+    for (int k = 0; k < 4; k++) {
+        gf2x_poly_free(&tmp[k]);
+    }
+    return count;
+}
+
+// ginv[i] <- g[i]^-1 by the plan (i.e. in its scratch), 
+// and the number of invertible g[i]
+int gf2x_mod_inv_batch_plan(
+    INPLACE gf2x_plan_t *plan,
+    IN  int n,
+    IN  poly_t *g,
+    OUT poly_t *ginv
+) {
+    batch_inv_t inv = { .ctx = plan->ctx, .method = plan->inv_method, .plan = plan, .tune = &plan->tune, 
+                        .tmp = plan->batch, .ws = plan->scratch };
+    return inv_batch(&inv, n, g, ginv);
+}
+
+// ginv[i] <- g[i]^-1 by the fastest method, and the number of invertible g[i]
+int gf2x_mod_inv_batch(
+    IN  ctx_t *ctx,
+    IN  int n,
+    IN  poly_t *g,
+    OUT poly_t *ginv
+) {
+    return gf2x_mod_inv_batch_method(ctx, 0, n, g, ginv);
+}
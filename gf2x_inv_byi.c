@@ -23,12 +23,18 @@
  */
 
 #include <assert.h>
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "bench.h"
 #include "gf2x.h"
 
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
 /*********************************************************
  * Bernstein and Yang's Polynomial Inversion for GF(2^m)
  * Input: f(x) irreducible polynomial of GF(2^m), m >= 2,
@@ -38,488 +44,1020 @@
  * 
 **********************************************************/
 
-/* 2x2 matrix of polynomials */
+/* 2x2 matrix of polynomials, as a view into the workspace
+ * p[k]'s hold M * x^(64*denom - n) for the transition matrix M of n divsteps, 
+ * in size64 >= denom blocks each. 
+ * The entries of the first row of M can be of degree n, so that their 
+ * coefficient of x^(64*denom) is kept separately in hi[0] and hi[1] as a mask
+ * (0 or 0xFFFFFFFFFFFFFFFF). The second row of M is of degree < n. */
 typedef struct { 
     int         denom;
-    poly_t      p0;
-    poly_t      p1;
-    poly_t      p2;
-    poly_t      p3;
+    int         size64;
+    uint64_t    *p[4];
+    uint64_t    *hi;
 } polymat_t;
 
-/* JumpDivStep Nodes (as a binary tree) */
-typedef struct jnode {
-    int         n;
-    int         delta;
-    poly_t      f;
-    poly_t      g;
-    polymat_t   P;
-    struct jnode *left;
-    struct jnode *right;
-} jnode;
-
-// Block-shifted polynomial addition
-// r <- (p + q) >> (block-shift)
-// Assumed that p.size64 = q.size64
-static void gf2x_poly_add_blockshift(
-    IN poly_t *p, 
-    IN poly_t *q,
-    IN int bshift,
-    OUT poly_t *r
-) {
-    assert(p->size64 == q->size64);
-    assert(bshift <= p->size64);
-    assert(r->size64 >= (p->size64-bshift));
-
-    for (int i = bshift; i < p->size64; i++) {
-        r->data[i-bshift] = p->data[i] ^ q->data[i];
-    }
-
-    // zeroize the remaining blocks
-    for (int i = p->size64; i < r->size64; i++) {
-        r->data[i] = 0;
-    }
+/* Entries of P needed by the parent of a node */
+#define NEED_ALL    0   // P, to update f and g by the left child
+#define NEED_ROW0   1   // (p0, p1), on the rightmost spine
+#define NEED_P1     2   // p1, at the top node
+
+// Split point of n divsteps for the left child, i.e. 
+// split/16 >= 1/2 of the s blocks of n (rounded up), so that both 
+// children have balanced block sizes for split = 8, and the left 
+// child is the larger one otherwise
+static inline int split_point(int n, int split) {
+    int s  = (n + 63) / 64;
+    int s1 = (s * split + 15) / 16;
+    s1 = (s1 < (s + 1) / 2) ? (s + 1) / 2 : (s1 > s - 1) ? s - 1 : s1;
+    return 64 * s1;
 }
 
-static inline void free_jnode(jnode *node) {
-    if (node != NULL) {
-        // gf2x_poly_free(&node->f);
-        gf2x_poly_free(&node->g);
-        gf2x_poly_free(&node->P.p0);
-        gf2x_poly_free(&node->P.p1);
-        gf2x_poly_free(&node->P.p2);
-        gf2x_poly_free(&node->P.p3);
+// t <- t + mask * a, for n-block a
+static inline void add_hi(
+    INPLACE uint64_t *t,
+    IN uint64_t mask,
+    IN uint64_t *a,
+    IN int n
+) {
+    for (int i = 0; i < n; i++) {
+        t[i] ^= mask & a[i];
     }
 }
 
-// Return n, the maximum power of 2
-// so that n < x for a given number x
-static inline uint64_t maxpow2(uint64_t x) {
-    uint64_t n = 1;
-    while (x > n) {
-        n <<= 1;
-    }
-    return (uint64_t) (n >> 1);
+// Number of blocks of scratch for MatPolyMul with s-block P,
+// i.e. the output and the scratch of each of the 4 middle products,
+// and the zero padded f and g
+static inline int update_scratch(int s) {
+    return 4 * (2 * (s + 1) + gf2x_mul_middle_scratch(s)) + 2 * (2 * s - 1);
 }
 
-static inline void truncate(poly_t *f, int n) {
-    for (int i = f->size64 - 1; i >= n; i--) {
-        f->data[i] = 0;
-    }
-    f->size64 = n;
+// Number of blocks of scratch for MatMatMul with P1 of s1 >= s2 blocks
+// by the Karatsuba threshold kt, i.e. the images of the 8 entries, 
+// and of the 4 entries of P
+static inline int merge_scratch(int s1, int kt) {
+    return 8 * gf2x_kara_size(s1, kt) + 4 * gf2x_kara_prod_size(s1, kt);
 }
 
-
-// In-place left multiplication of a polynomial vector 
-// of length 2 with a 2x2 polynomial matrix 
-// vec(f, g) <- P * vec(f, g)
+// Left multiplication of a polynomial vector of length 2 
+// with a 2x2 polynomial matrix, truncated to the r blocks 
+// above the s = P.denom blocks of P
+// vec(fout, gout) <- ( P * vec(f, g) >> (block-shift) ) mod x^(64r)
+// 
+// Only the first s + r blocks of f and g are read (r <= s), and the 
+// r blocks are computed by middle products, at the cost of a single 
+// s-block product for each entry of P (by the Karatsuba threshold kt).
+// The 4 products are independent, i.e. tasks for large s.
 static inline void MatPolyMul (
     IN polymat_t *P,
-    INPLACE poly_t *f, 
-    INPLACE poly_t *g
+    IN uint64_t *f, 
+    IN uint64_t *g,
+    IN int r,
+    IN int kt,
+    OUT uint64_t *fout,
+    OUT uint64_t *gout,
+    uint64_t *scratch           // update_scratch(s) blocks
 ) {
-    // Check if the sizes of the polynomials in the matrix
-    int s64 = P->p0.size64;
-    assert(s64 == P->p1.size64);
-    assert(s64 == P->p2.size64);
-    assert(s64 == P->p3.size64);
-    
-    int sizet = P->p0.size64 + f->size64;
-    poly_t t0 = { .data = malloc(sizet * sizeof(uint64_t)), .size64 = sizet };
-    poly_t t1 = { .data = malloc(sizet * sizeof(uint64_t)), .size64 = sizet };
-    poly_t t2 = { .data = malloc(sizet * sizeof(uint64_t)), .size64 = sizet };
-    poly_t t3 = { .data = malloc(sizet * sizeof(uint64_t)), .size64 = sizet };
-
-    gf2x_poly_zeroize(&t0);
-    gf2x_poly_zeroize(&t1);
-    gf2x_poly_zeroize(&t2);
-    gf2x_poly_zeroize(&t3);
-
-    gf2x_poly_mul(&(P->p0), f, &t0);
-    gf2x_poly_mul(&(P->p1), g, &t1);
-    gf2x_poly_mul(&(P->p2), f, &t2);
-    gf2x_poly_mul(&(P->p3), g, &t3);
-
-    gf2x_poly_add_blockshift(&t0, &t1, P->denom, f);
-    gf2x_poly_add_blockshift(&t2, &t3, P->denom, g);
+    int s = P->denom;
+    assert(r <= s);
+
+    // m[k] <- (m_(s-1), ..., m_(2s-1)) of P[k] * (f or g), where 
+    // m_k is the sum of the 2-block products a_i * b_(k-i)
+    int mlen = 2 * (s + 1) + gf2x_mul_middle_scratch(s);
+    uint64_t *m[4];
+
+    // f and g zero padded to the 2s - 1 blocks read by the middle
+    // products for r < s - 1 (i.e. after an unbalanced split)
+    if (r < s - 1) {
+        uint64_t *fp = &scratch[4 * mlen];
+        uint64_t *gp = &fp[2 * s - 1];
+        memcpy(fp, f, (s + r) * sizeof(uint64_t));
+        memcpy(gp, g, (s + r) * sizeof(uint64_t));
+        memset(&fp[s + r], 0, (s - 1 - r) * sizeof(uint64_t));
+        memset(&gp[s + r], 0, (s - 1 - r) * sizeof(uint64_t));
+        f = fp;
+        g = gp;
+    }
 
-    // Free ti's
-    // gf2x_poly_free(&t0);
-    // gf2x_poly_free(&t1);
-    // gf2x_poly_free(&t2);
-    // gf2x_poly_free(&t3);
+    for (int k = 0; k < 4; k++) {
+        m[k] = &scratch[k * mlen];
+    }
+    for (int k = 0; k < 4; k++) {
+        #pragma omp task if(s >= GF2X_TASK_BLOCKS)
+        {
+            uint64_t *b  = (k & 1) ? g : f;
+            uint64_t *mk = &scratch[k * mlen];
+            memset(mk, 0, 2 * (s + 1) * sizeof(uint64_t));
+            gf2x_mul_middle(P->p[k], b, s, kt, mk, &mk[2 * (s + 1)]);
+
+            // The low block of m_(2s-1) is only needed for r = s
+            if (r == s) {
+                gf2x_mul_dot(P->p[k], &b[s], s, &mk[2 * s]);
+            }
+        }
+    }
+    #pragma omp taskwait
+
+    // Block s + w of the product is m_(s+w).lo + m_(s+w-1).hi, 
+    // and the first row also has the coefficients of x^(64s)
+    for (int w = 0; w < r; w++) {
+        uint64_t fw = m[0][2 * (w + 1)] ^ m[0][2 * w + 1] ^ m[1][2 * (w + 1)] ^ m[1][2 * w + 1];
+        uint64_t gw = m[2][2 * (w + 1)] ^ m[2][2 * w + 1] ^ m[3][2 * (w + 1)] ^ m[3][2 * w + 1];
+        fw ^= (P->hi[0] & f[w]) ^ (P->hi[1] & g[w]);
+        fout[w] = fw;
+        gout[w] = gw;
+    }
 }
 
-// P <- P2 * P1
+// P <- P2 * P1, only on the entries given by need
+// 
+// The needed entries of P1 and P2 are transformed once (down to the 
+// Karatsuba threshold kt), and
+// each needed entry of P is interpolated once. The transforms,
+// and then the entries of P, are independent (i.e. tasks for large n).
 static inline void MatMatMul (
     polymat_t *P,           // out
     polymat_t *P1,          // in
-    polymat_t *P2           // in
+    polymat_t *P2,          // in
+    int need,               // NEED_ALL, NEED_ROW0 or NEED_P1
+    int kt,                 // Karatsuba threshold
+    uint64_t *scratch       // merge_scratch(max(s1, s2), kt) blocks
 ) {
-    // Check if the sizes of the polynomials in the matrix
-    assert(P1->p0.size64 == P1->p1.size64);
-    assert(P1->p0.size64 == P1->p2.size64);
-    assert(P1->p0.size64 == P1->p3.size64);
-
-    assert(P2->p0.size64 == P2->p1.size64);
-    assert(P2->p0.size64 == P2->p2.size64);
-    assert(P2->p0.size64 == P2->p3.size64);
-   
-    // Temporary polynomials   
-    int sizet = P1->p0.size64 + P2->p0.size64;
-    poly_t t0 = { .data = malloc(sizet * sizeof(uint64_t)), .size64 = sizet };
-    poly_t t1 = { .data = malloc(sizet * sizeof(uint64_t)), .size64 = sizet };    
-    P->denom = t0.size64;
-
-    // p0 <-- (P20, P21) * (P10, P12)
-    gf2x_poly_zeroize(&t0);
-    gf2x_poly_zeroize(&t1);
-    gf2x_poly_mul(&(P2->p0), &(P1->p0), &t0);
-    gf2x_poly_mul(&(P2->p1), &(P1->p2), &t1);
-    gf2x_poly_add_blockshift(&t0, &t1, 0, &(P->p0));
-    
-    // p1 <-- (P20, P21) * (P11, P13)
-    gf2x_poly_zeroize(&t0);
-    gf2x_poly_zeroize(&t1);
-    gf2x_poly_mul(&(P2->p0), &(P1->p1), &t0);
-    gf2x_poly_mul(&(P2->p1), &(P1->p3), &t1);
-    gf2x_poly_add_blockshift(&t0, &t1, 0, &(P->p1));
-
-    // p2 <-- (P22, P23) * (P10, P12)
-    gf2x_poly_zeroize(&t0);
-    gf2x_poly_zeroize(&t1);
-    gf2x_poly_mul(&(P2->p2), &(P1->p0), &t0);
-    gf2x_poly_mul(&(P2->p3), &(P1->p2), &t1);
-    gf2x_poly_add_blockshift(&t0, &t1, 0, &(P->p2));
-
-    // p3 <-- (P22, P23) * (P11, P13)
-    gf2x_poly_zeroize(&t0);
-    gf2x_poly_zeroize(&t1);
-    gf2x_poly_mul(&(P2->p2), &(P1->p1), &t0);
-    gf2x_poly_mul(&(P2->p3), &(P1->p3), &t1);
-    gf2x_poly_add_blockshift(&t0, &t1, 0, &(P->p3));
-
-    gf2x_poly_free(&t0);
-    gf2x_poly_free(&t1);
+    int s1 = P1->denom;
+    int s2 = P2->denom;
+    P->denom = s1 + s2;
+    assert(P->size64 >= P->denom);
+
+    // Needed rows of P2, and columns of P1
+    int rows = (need == NEED_ALL) ? 2 : 1;
+    int col0 = (need == NEED_P1)  ? 1 : 0;
+
+    uint64_t **a1 = P1->p;
+    uint64_t **a2 = P2->p;
+    uint64_t *h1 = P1->hi;
+    uint64_t *h2 = P2->hi;
+
+    // Transform of the (zero padded) entries
+    int n  = (s1 > s2) ? s1 : s2;
+    int tn = gf2x_kara_size(n, kt);
+    int qn = gf2x_kara_prod_size(n, kt);
+
+    uint64_t *e1[4], *e2[4], *e[4];
+    for (int k = 0; k < 4; k++) {
+        e1[k] = &scratch[k * tn];
+        e2[k] = &scratch[(4 + k) * tn];
+        e[k]  = &scratch[8 * tn + k * qn];
+    }
+
+    for (int k = 0; k < 4; k++) {
+        if ((k & 1) >= col0) {
+            #pragma omp task if(n >= GF2X_TASK_BLOCKS)
+            gf2x_kara_eval(a1[k], s1, n, kt, e1[k]);
+        }
+        if ((k >> 1) < rows) {
+            #pragma omp task if(n >= GF2X_TASK_BLOCKS)
+            gf2x_kara_eval(a2[k], s2, n, kt, e2[k]);
+        }
+    }
+    #pragma omp taskwait
+
+    // P[i][j] <- P2[i][0] * P1[0][j] + P2[i][1] * P1[1][j]
+    for (int i = 0; i < rows; i++) {
+        for (int j = col0; j < 2; j++) {
+            #pragma omp task if(n >= GF2X_TASK_BLOCKS)
+            {
+                uint64_t *c  = P->p[2 * i + j];
+                uint64_t *ec = e[2 * i + j];
+
+                memset(ec, 0, qn * sizeof(uint64_t));
+                gf2x_kara_mul_acc(e2[2 * i],     e1[j],     n, kt, ec);
+                gf2x_kara_mul_acc(e2[2 * i + 1], e1[2 + j], n, kt, ec);
+                gf2x_kara_interp(ec, n, kt);
+                memcpy(c, ec, P->denom * sizeof(uint64_t));
+                memset(&c[P->denom], 0, (P->size64 - P->denom) * sizeof(uint64_t));
+
+                // Coefficients of x^(64*s1) and x^(64*s2), in the
+                // first row of P1 and P2
+                add_hi(&c[s1], h1[j], a2[2 * i], s2);
+                if (i == 0) {
+                    add_hi(&c[s2], h2[0], a1[j],     s1);
+                    add_hi(&c[s2], h2[1], a1[2 + j], s1);
+                }
+            }
+        }
+    }
+    #pragma omp taskwait
+
+    // Coefficients of x^(64*(s1+s2)) in the first row
+    P->hi[0] = h2[0] & h1[0];
+    P->hi[1] = h2[0] & h1[1];
 }
 
+// Bit reversal of each byte by GF2P8AFFINEQB with the anti-diagonal
+// bit matrix, and of the bytes of each 64-bit block by a byte shuffle
+#if defined(__GFNI__)
+#include <immintrin.h>
+#define REV8_MATRIX     0x8040201008040201ULL
+#endif
+
 // Reverse 64-bit blocks
-uint64_t rev64(uint64_t n) {
+static inline uint64_t rev64(uint64_t n) {
+#if defined(__GFNI__)
+    __m128i v = _mm_cvtsi64_si128((long long) n);
+    v = _mm_gf2p8affine_epi64_epi8(v, _mm_set1_epi64x(REV8_MATRIX), 0);
+    return __builtin_bswap64((uint64_t) _mm_cvtsi128_si64(v));
+#else
+    n = __builtin_bswap64(n);
     n = ((n >> 1) & 0x5555555555555555) | ((n & 0x5555555555555555) << 1);
     n = ((n >> 2) & 0x3333333333333333) | ((n & 0x3333333333333333) << 2);
     n = ((n >> 4) & 0x0F0F0F0F0F0F0F0F) | ((n & 0x0F0F0F0F0F0F0F0F) << 4);
-    n = ((n >> 8) & 0x00FF00FF00FF00FF) | ((n & 0x00FF00FF00FF00FF) << 8);
-    n = ((n >> 16) & 0x0000FFFF0000FFFF) | ((n & 0x0000FFFF0000FFFF) << 16);
-    n = (n >> 32) | (n << 32);
     return n;
+#endif
 }
 
-// Reverse p in terms of d
-// (i.e. r = p.reverse(d) )
-static inline void reverse(poly_t *p, poly_t *r, int d) {
-
-    assert(p->data != NULL && "Input polynomial is not initialized!");
-    assert(r->data != NULL && "Output polynomial is not initialized!");
-    assert((p->size64 >= r->size64) && "The size of input and output polynomial do not match!");
-
-    // n = number of 64-bit blocks for length/degree = d
-    // k = number of remaning bits
-    // (d+1) = 64 * n + k
-    int n = ( (d+1) >> 6  );
-    int k = ( (d+1) & 0x3f);
-    
-    // if k = 0, just reverse each block, and reverse the block order
-    if(k == 0) {
-        for(int i = n-1; i >= 0; i--) {
-            r->data[i] = rev64(p->data[n-1-i]);
-        }        
-    } 
-    // Construct new blocks by bitshifts, and reverse them in the new block 
-    else {
-        int shift = 64 - k;     // Number of right shift
-        
-        uint64_t hi, lo;
-
-        for(int i = n; i > 0; i--) {
-            hi = (p->data[i]   << shift);
-            lo = (p->data[i-1] >> k);
-            r->data[n-i] = rev64(hi | lo);
-        }
-        r->data[n] = rev64(p->data[0] << shift);
+// Bits [64q + k, 64q + k + 64) of p, for 0 <= k < 64, 
+// where the bits of p below 0 are zero
+static inline uint64_t bits64(IN uint64_t *p, int q, int k) {
+    uint64_t lo = (q >= 0) ? p[q] : 0;
+    if (k == 0) {
+        return lo;
     }
-
+    uint64_t hi = (q + 1 >= 0) ? p[q + 1] : 0;
+    return (lo >> k) | (hi << (64 - k));
 }
 
-// Polynomial division by x^d, which is
-// performed by shifting the blocks to right by d bits
-static inline void poly_right_shift(poly_t *p, int shift) {
-    assert( (shift < 64) && (shift > 0) && "Shift bits (d) should be between 1 and 63 (inclusive)");
+// Reverse (p / x^off) in terms of d, for off >= 0, or (p * x^(-off)) 
+// for off < 0, i.e. r_i = p_(off+d-i) for 0 <= i <= d, on the blocks 
+// of degree d (i.e. r = (p >> off).reverse(d) in a single pass)
+static inline void reverse(IN uint64_t *p, IN int off, OUT uint64_t *r, IN int d) {
+
+    // Block j of r is the reverse of the bits [b - 64j, b - 64j + 64) of p
+    // for b = off + d - 63, i.e. bits64(p, q - j, k) for b = 64q + k
+    int n = (d + 64) / 64;
+    int b = off + d - 63;
+    int q = (b >= 0) ? (b / 64) : -((63 - b) / 64);
+    int k = b - 64 * q;
+    int j = 0;
+
+#if defined(__GFNI__) && defined(__AVX512F__) && defined(__AVX512BW__)
+    // 8 blocks at once, on the blocks q-j-7, ..., q-j (and q-j+1) of p
+    const __m512i rev8 = _mm512_set1_epi64(REV8_MATRIX);
+    const __m512i bswap = _mm512_set4_epi32(
+        0x08090a0b, 0x0c0d0e0f, 0x00010203, 0x04050607);
+    const __m512i qrev = _mm512_set_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m128i sr = _mm_cvtsi32_si128(k);
+    const __m128i sl = _mm_cvtsi32_si128(64 - k);
+
+    for (; j + 8 <= n && q - j - 7 >= 0; j += 8) {
+        __m512i v = _mm512_loadu_si512((const void *) &p[q - j - 7]);
+        if (k != 0) {
+            __m512i h = _mm512_loadu_si512((const void *) &p[q - j - 6]);
+            v = _mm512_or_si512(_mm512_srl_epi64(v, sr), _mm512_sll_epi64(h, sl));
+        }
+        v = _mm512_gf2p8affine_epi64_epi8(v, rev8, 0);
+        v = _mm512_shuffle_epi8(v, bswap);
+        v = _mm512_permutexvar_epi64(qrev, v);
+        _mm512_storeu_si512((void *) &r[j], v);
+    }
+#endif
 
-    uint64_t mask_shift = ((uint64_t)(0x1) << shift) - 1;
+    for (; j < n; j++) {
+        r[j] = rev64(bits64(p, q - j, k));
+    }
 
-    uint64_t hi, lo;
-    for(int i = 0; i < p->size64 - 1; i++) {
-        lo = p->data[i] >> shift;
-        hi = p->data[i+1] & mask_shift;
-        p->data[i] = (hi << (64-shift)) | lo;
+    // The bits of r above d are of p below off
+    if ((d + 1) & 0x3f) {
+        r[n - 1] &= (1ULL << ((d + 1) & 0x3f)) - 1;
     }
-    p->data[p->size64-1] >>= shift;
 }
 
 /************************************
  * BY FUNCTIONS
  ************************************/
 
-// returns delta
+// Maximum number of 64-bit blocks (and divsteps) handled by the base case,
+// whose number is plan->tune.byi_base_blocks
+#define BASE_BLOCKS     BYI_MAX_BASE_BLOCKS
+
+/*
+    n <= 64 divsteps on the lowest blocks of f and g, 
+    computed in registers and in constant time.
+    Returns delta.
+
+    The matrix entries u, v, q, r are kept as M * x^(64 - i) after
+    i divsteps (in 65 bits), so that each divstep only shifts q and r 
+    to the right, and the output is M * x^(64 - n) in one block 
+    together with the coefficients of x^64 of u and v (as masks).
+*/
 static inline int divstepx_64(
     int n, int delta,
-    uint64_t *f, uint64_t *g,  // input
-    uint64_t P[4]  // output matrix
+    uint64_t f, uint64_t g,     // input
+    uint64_t m[4],              // output matrix
+    uint64_t mhi[2]             // output x^64 coefficients of m[0], m[1]
 ) {
-    // Copy Values
-    uint64_t ff = *(f + 0);
-    uint64_t gg = *(g + 0);
-    int dd = delta;
-
-    // temp
-    uint64_t tmp;
-
-    // Masking for truncating f and g
-    uint64_t mask = (0 - 1ULL) >> (64-n);
-
-    // masking for f0 and g0
-    // if f0 = 1, mask_f0 = 0xFFFFFFFFFFFFFFFF
-    // if f0 = 0, mask_f0 = 0x0000000000000000
-    uint64_t mask_f0;
-    uint64_t mask_g0;
-
-    // fractional polynomials
-    // u, v, q, r
-    // [0, 1] = [num, denom]
-    uint64_t u[2] = {1, 0};
-    uint64_t v[2] = {0, 0};
-    uint64_t q[2] = {0, 0};
-    uint64_t r[2] = {1, 0};
-    int maxdenom;
-
-    // Start
-    for(int i = 0; i < n; i ++) {
-
-        // Truncate f
-        ff &= mask; 
-        
-        // Swap
-        if ( (dd > 0) && (gg & 0x01) ) {
-            dd = -dd;
-
-            tmp = ff; ff = gg; gg = tmp;
-
-            tmp = u[0]; u[0] = q[0]; q[0] = tmp;
-            tmp = u[1]; u[1] = q[1]; q[1] = tmp;
-
-            tmp = v[0]; v[0] = r[0]; r[0] = tmp;
-            tmp = v[1]; v[1] = r[1]; r[1] = tmp;
-        }
+    typedef unsigned __int128 uint128_t;
+
+    // u = r = x^64, v = q = 0
+    uint128_t u = (uint128_t) 1 << 64;
+    uint128_t v = 0;
+    uint128_t q = 0;
+    uint128_t r = (uint128_t) 1 << 64;
 
-        // TODO: g0 is always 1, so we can fix the mask
-        mask_f0 = (0 - (ff & 0x01));
-        mask_g0 = (0 - (gg & 0x01));
+    uint64_t mask_swap, mask_g0, t;
+    uint128_t mask128, t128;
 
-        dd += 1;
-        
-        // (f0*g-g0*f)/x
-        gg = (mask_f0 & gg) ^ (mask_g0 & ff);
-        assert( (gg & 0x01) == 0);
-        gg = gg >> 1;
+    for (int i = 0; i < n; i++) {
+        // Swap if delta > 0 and g0 = 1 (f0 is always 1)
+        mask_swap = 0 - ((((uint64_t) (int64_t) -delta) >> 63) & g & 1);
+        mask128 = ((uint128_t) mask_swap << 64) | mask_swap;
 
-        // (g0*u0/x^j + f0*q0/x^k)/x = (g0*u0*x^(m-j) + f0*q0*x^(m-k)) / x^(m+1) 
-        // (f0*q-g0*u)/x       
-        maxdenom = u[1] > q[1] ? (int) u[1] : (int) q[1];
-        q[0] = (
-            (mask_f0 & q[0]) << (maxdenom - (int) q[1]) ^
-            (mask_g0 & u[0]) << (maxdenom - (int) u[1])
-            );
-        q[1] = maxdenom + 1;
-        
-        // (f0*r-g0*v)/x
-        maxdenom = r[1] > v[1] ? (int) r[1] : (int) v[1];
-        r[0] = (
-            (mask_f0 & r[0]) << (maxdenom - (int) r[1]) ^ 
-            (mask_g0 & v[0]) << (maxdenom - (int) v[1])
-            );
-        r[1] = maxdenom + 1;
+        delta = (delta ^ (int) mask_swap) - (int) mask_swap;
+        t = mask_swap & (f ^ g);      f ^= t; g ^= t;
+        t128 = mask128 & (u ^ q);     u ^= t128; q ^= t128;
+        t128 = mask128 & (v ^ r);     v ^= t128; r ^= t128;
 
-        mask >>= 1;
-        gg &= mask;
+        delta += 1;
+
+        // g <- (g + g0*f)/x, q <- (q + g0*u)/x, r <- (r + g0*v)/x
+        mask_g0 = 0 - (g & 1);
+        mask128 = ((uint128_t) mask_g0 << 64) | mask_g0;
+
+        g = (g ^ (mask_g0 & f)) >> 1;
+        q = (q ^ (mask128 & u)) >> 1;
+        r = (r ^ (mask128 & v)) >> 1;
     }
 
-    P[0] = u[0] << (n - u[1]); 
-    P[1] = v[0] << (n - v[1]);
-    P[2] = q[0] << (n - q[1]); 
-    P[3] = r[0] << (n - r[1]);
+    m[0] = (uint64_t) u;
+    m[1] = (uint64_t) v;
+    m[2] = (uint64_t) q;
+    m[3] = (uint64_t) r;
+    mhi[0] = 0 - (uint64_t) (u >> 64);
+    mhi[1] = 0 - (uint64_t) (v >> 64);
 
-    P[0] <<= (64-n);
-    P[1] <<= (64-n);
-    P[2] <<= (64-n);
-    P[3] <<= (64-n);
+    return delta;
+}
 
-    return dd;
+// f, g <- m * (f, g) / x^64 on len blocks (i.e. the next 64 divsteps
+// are on the lowest blocks)
+static inline void divstepx_shift(
+    IN uint64_t m[4], IN uint64_t mhi[2],
+    INPLACE uint64_t *ff, INPLACE uint64_t *gg,
+    IN int len
+) {
+    uint64_t t0[BASE_BLOCKS + 2], t1[BASE_BLOCKS + 2];
+
+    memset(t0, 0, (len + 1) * sizeof(uint64_t));
+    memset(t1, 0, (len + 1) * sizeof(uint64_t));
+    gf2x_mul_words(&m[0], 1, ff, len, t0);
+    gf2x_mul_words(&m[1], 1, gg, len, t0);
+    add_hi(&t0[1], mhi[0], ff, len);
+    add_hi(&t0[1], mhi[1], gg, len);
+    gf2x_mul_words(&m[2], 1, ff, len, t1);
+    gf2x_mul_words(&m[3], 1, gg, len, t1);
+    for (int k = 0; k < len - 1; k++) {
+        ff[k] = t0[k + 1];
+        gg[k] = t1[k + 1];
+    }
 }
 
+// P <- A of s blocks, zero padded to P->size64 blocks
+static inline void divstepx_store(IN polymat_t *A, IN int s, OUT polymat_t *P) {
+    for (int k = 0; k < 4; k++) {
+        memcpy(P->p[k], A->p[k], s * sizeof(uint64_t));
+        memset(&P->p[k][s], 0, (P->size64 - s) * sizeof(uint64_t));
+    }
+    P->denom = s;
+    P->hi[0] = A->hi[0];
+    P->hi[1] = A->hi[1];
+}
 
 /*
-    Return the new delta. 
-
-    input:
-        int n, delta;
-        poly_t f, g;
-    output:
-        int delta;
-        polymat_t   P;
+    Base case: n <= 64 * BASE_BLOCKS divsteps on f and g of s = ceil(n/64) blocks.
+    Returns delta, and P of s blocks.
+
+    Every 64 divsteps are computed by divstepx_64 on the lowest blocks,
+    whose 1-block matrix is then applied to (f, g) and accumulated 
+    in P on the stack, without going through the recursion.
 */
-static int jumpdivstepx(jnode *parent) { 
-    
-    if (parent->n <= 64) {        
-        // Compute DivStepx64
-        uint64_t P[4];
-        uint64_t *fp = parent->f.data;
-        uint64_t *gp = parent->g.data;
-        
-        parent->delta = divstepx_64(parent->n, parent->delta, fp, gp, P);
-
-        // Copy P values
-        memcpy(parent->P.p0.data, &P[0], sizeof(uint64_t));
-        memcpy(parent->P.p1.data, &P[1], sizeof(uint64_t));
-        memcpy(parent->P.p2.data, &P[2], sizeof(uint64_t));
-        memcpy(parent->P.p3.data, &P[3], sizeof(uint64_t));
-
-        // return new delta
-        return parent->delta;
-    }
-
-    // Compute j as the max power of 2 so that n < j
-    int j = maxpow2(parent->n);
-    
-    // Construct left child and pass values
-    parent->left = malloc(sizeof(jnode));
-    parent->left->n = j;
-    parent->left->delta = parent->delta;
-    parent->left->f.data = malloc(parent->f.size64 * sizeof(uint64_t));
-    parent->left->f.size64 = parent->f.size64;
-    memcpy(parent->left->f.data, parent->f.data, parent->f.size64 * sizeof(uint64_t));   
-    parent->left->g.data = malloc(parent->g.size64 * sizeof(uint64_t));
-    parent->left->g.size64 = parent->g.size64;
-    memcpy(parent->left->g.data, parent->g.data, parent->g.size64 * sizeof(uint64_t));
-
-    int sizeP1 = (parent->left->n + 63) / 64;
-    polymat_t P1= {
-        .p0 = { .data = calloc(sizeP1, sizeof(uint64_t)), .size64 = sizeP1 },
-        .p1 = { .data = calloc(sizeP1, sizeof(uint64_t)), .size64 = sizeP1 },
-        .p2 = { .data = calloc(sizeP1, sizeof(uint64_t)), .size64 = sizeP1 },
-        .p3 = { .data = calloc(sizeP1, sizeof(uint64_t)), .size64 = sizeP1 },
-        .denom = sizeP1
+static inline int divstepx_base(
+    int n, int delta,
+    uint64_t *f, uint64_t *g,   // input
+    polymat_t *P,               // output matrix
+    int kt,                     // Karatsuba threshold
+    uint64_t *scratch           // merge_scratch(s, kt) blocks
+) {
+    int s = (n + 63) / 64;
+    assert(s <= BASE_BLOCKS);
+
+    // Local copies of f and g 
+    uint64_t ff[BASE_BLOCKS + 1] = {0};
+    uint64_t gg[BASE_BLOCKS + 1] = {0};
+    memcpy(ff, f, s * sizeof(uint64_t));
+    memcpy(gg, g, s * sizeof(uint64_t));
+
+    // 64-step matrix m, and the accumulated matrices A[0], A[1]
+    uint64_t m[4], mhi[2];
+    uint64_t a[2][4][BASE_BLOCKS], ah[2][2];
+
+    polymat_t M = {
+        .denom = 1, .size64 = 1,
+        .p = { &m[0], &m[1], &m[2], &m[3] },
+        .hi = mhi
     };
-    parent->left->P = P1;
-    
-    // delta, P1 <- jumpdivstepsx(j, delta, f, g)
-    parent->delta = jumpdivstepx(parent->left);
+    polymat_t A[2];
+    for (int k = 0; k < 2; k++) {
+        for (int e = 0; e < 4; e++) {
+            A[k].p[e] = a[k][e];
+        }
+        A[k].hi = ah[k];
+    }
 
-    // f, g <- P1 * (f, g)
-    MatPolyMul(&(parent->left->P), &(parent->f), &(parent->g));
+    // First 64 divsteps: A[0] <- m
+    delta = divstepx_64((n < 64 ? n : 64), delta, ff[0], gg[0], m, mhi);
+    for (int k = 0; k < 4; k++) {
+        a[0][k][0] = m[k];
+    }
+    A[0].denom = A[0].size64 = 1;
+    ah[0][0] = mhi[0];
+    ah[0][1] = mhi[1];
 
-    // f <- kx(f).truncate(n-j)
-    // g <- kx(g).truncate(n-j)
-    truncate( &(parent->f), (parent->n - j + 63) / 64);
-    truncate( &(parent->g), (parent->n - j + 63) / 64);
+    for (int c = 1; c < s; c++) {
+        // f, g <- m * (f, g) / x^64 on the remaining (s - c + 1) blocks
+        divstepx_shift(m, mhi, ff, gg, s - c + 1);
 
-    // Construct right child and pass values
-    parent->right = malloc(sizeof(jnode));
-    parent->right->n = parent->n - j;
-    parent->right->delta = parent->delta;
+        // Next (at most) 64 divsteps
+        delta = divstepx_64((n - 64*c < 64 ? n - 64*c : 64), delta, ff[0], gg[0], m, mhi);
 
-    parent->right->f.data = malloc(parent->f.size64 * sizeof(uint64_t));
-    parent->right->f.size64 = parent->f.size64;
-    memcpy(parent->right->f.data, parent->f.data, parent->f.size64 * sizeof(uint64_t));
-    
-    parent->right->g.data = malloc(parent->g.size64 * sizeof(uint64_t));
-    parent->right->g.size64 = parent->g.size64;
-    memcpy(parent->right->g.data, parent->g.data, parent->g.size64 * sizeof(uint64_t));
-
-    int sizeP2 = (parent->right->n + 63) / 64;
-    polymat_t P2= {
-        .p0 = { .data = calloc(sizeP2, sizeof(uint64_t)), .size64 = sizeP2, },
-        .p1 = { .data = calloc(sizeP2, sizeof(uint64_t)), .size64 = sizeP2, },
-        .p2 = { .data = calloc(sizeP2, sizeof(uint64_t)), .size64 = sizeP2, },
-        .p3 = { .data = calloc(sizeP2, sizeof(uint64_t)), .size64 = sizeP2, },
-        .denom = sizeP2
-    };
-    parent->right->P = P2;
-    
-    // delta, P2 <- jumpdivstepsx(n-j, delta, f, g)
-    parent->delta = jumpdivstepx(parent->right);
-    
-    // f, g <- P2 * (f, g)
-    MatPolyMul(&(parent->right->P), &(parent->f), &(parent->g));
+        // A[c%2] <- m * A[(c-1)%2]
+        polymat_t *Aout = &A[c & 1];
+        Aout->size64 = c + 1;
+        MatMatMul(Aout, &A[(c - 1) & 1], &M, NEED_ALL, kt, scratch);
+    }
+
+    // P <- A[(s-1)%2]
+    divstepx_store(&A[(s - 1) & 1], s, P);
+
+    return delta;
+}
 
-    // P <- P2 * P1
-    MatMatMul(&(parent->P), &(parent->left->P), &(parent->right->P));
+/************************************
+ * BYI SCHEDULE
+ ************************************/
 
-    // Free left and right nodes
-    // free_jnode(parent->left);
-    // free_jnode(parent->right);
+/*
+    The jumpdivstep tree of n divsteps only depends on n, so that it 
+    is flattened once into a list of operations in post-order:
+
+        BASE    delta, P <- divsteps on (f, g) of a leaf
+        UPDATE  (f, g) of the right child <- P1 * (f, g), after the left child
+        MERGE   P <- P2 * P1, after the right child
+
+    All the polynomials live in a single workspace of ws_size blocks,
+    which is allocated as a stack while the tree is flattened:
+    a left child works on the lowest blocks of (f, g) of its parent, 
+    and the blocks of the children are released after MERGE.
+    A node is stored with P (4 entries of size64 blocks and 2 masks).
+*/
 
-    return parent->delta;
+// Reserve k blocks on top of the workspace stack
+static inline int plan_alloc(byi_plan_t *plan, int *sp, int k) {
+    int off = *sp;
+    *sp += k;
+    if (*sp > plan->ws_size) {
+        plan->ws_size = *sp;
+    }
+    return off;
 }
 
-// void gf2x_mod_inv_by(int d, poly_t *f, poly_t *g, poly_t *ginv) {
-void gf2x_mod_inv_byi(
-    IN ctx_t *ctx, 
-    poly_t *g, 
-    poly_t *ginv
+// Append an operation with its scratch at ws
+static inline void plan_op(byi_plan_t *plan, int type, int node, int ws, int scratch) {
+    assert(plan->num_ops < BYI_MAX_OPS);
+    plan->op[plan->num_ops].type = type;
+    plan->op[plan->num_ops].node = node;
+    plan->op[plan->num_ops].ws   = ws;
+    plan->num_ops++;
+
+    if (ws + scratch > plan->ws_size) {
+        plan->ws_size = ws + scratch;
+    }
+}
+
+// Node of n divsteps on (f, g) with its P, and its subtree
+static int plan_node(
+    byi_plan_t *plan, int *sp,
+    int n, int need, 
+    int f, int g, int P, int size64
 ) {
-    
-    int d = ctx->p; 
+    assert(plan->num_nodes < BYI_MAX_NODES);
+    int id = plan->num_nodes++;
+    int s  = (n + 63) / 64;
+
+    byi_node_t *node = &plan->node[id];
+    node->n      = n;
+    node->s      = s;
+    node->need   = need;
+    node->left   = -1;
+    node->right  = -1;
+    node->f      = f;
+    node->g      = g;
+    node->P      = P;
+    node->size64 = size64;
+
+    int kt = plan->tune.kara_threshold;
+
+    if (n <= 64 * plan->tune.byi_base_blocks) {
+        plan_op(plan, BYI_OP_BASE, id, *sp, merge_scratch(s, kt));
+        return id;
+    }
+
+    // Split point, and blocks of j and (n-j) divsteps
+    int j  = split_point(n, plan->tune.byi_split);
+    int s1 = j / 64;
+    int s2 = s - s1;
+    int base = *sp;
 
-    // Reverse of f (i.e. f_rev = f.reverse(d) = f for f = x^d - 1)    
-    poly_t f_rev;
-    gf2x_poly_init(&f_rev, d);
-    gf2x_poly_zeroize(&f_rev);
-    gf2x_poly_setcoef(&f_rev, d, 1);
-    gf2x_poly_setcoef(&f_rev, 0, 1);
+    // Left child on the lowest blocks of f and g, 
+    // whose full matrix is needed to update f and g
+    int P1 = plan_alloc(plan, sp, 4 * s1 + 2);
+    int left = plan_node(plan, sp, j, NEED_ALL, f, g, P1, s1);
 
-    // Reverse g (i.e. g_rev = g.reverse(d-1) )
-    poly_t g_rev;
-    gf2x_poly_init(&g_rev, g->deg);
-    reverse(g, &g_rev, d-1);
+    // f, g <- kx(P1 * (f, g)).truncate(n-j)
+    int f2 = plan_alloc(plan, sp, s2);
+    int g2 = plan_alloc(plan, sp, s2);
+    plan_op(plan, BYI_OP_UPDATE, id, *sp, update_scratch(s1));
 
-    // JumpStep
-    int Psize64 = g->size64;
+    // Right child, where only the first row of P2 is needed 
+    // for the first row of P (i.e. on the rightmost spine)
+    int need2 = (need == NEED_ALL) ? NEED_ALL : NEED_ROW0;
+    int P2 = plan_alloc(plan, sp, 4 * s2 + 2);
+    int right = plan_node(plan, sp, n - j, need2, f2, g2, P2, s2);
 
+    // P <- P2 * P1, and release the blocks of the children
+    plan_op(plan, BYI_OP_MERGE, id, *sp, merge_scratch(s1 > s2 ? s1 : s2, kt));
+    *sp = base;
+
+    plan->node[id].left  = left;
+    plan->node[id].right = right;
+
+    return id;
+}
+
+// BYI schedule of n divsteps for x^p - 1 by tune
+void gf2x_byi_plan(
+    OUT byi_plan_t *plan, 
+    IN gf2x_tune_t *tune,
+    IN int p, 
+    IN int n
+) {
+    int s = (n + 63) / 64;
+    assert(s <= MAX_POLY_SIZE);
+
+    plan->n = 0;
+    plan->tune = *tune;
+    plan->team = 1;
+    plan->num_nodes = 0;
+    plan->num_ops = 0;
+    plan->ws_size = 0;
+
+    // The top node reads f and g on the blocks of n divsteps,
+    // and P[0][1] is also read on the blocks of ginv
+    int size64 = (s > p / 64 + 1) ? s : (p / 64 + 1);
+
+    int sp = 0;
+    int f = plan_alloc(plan, &sp, s);
+    int g = plan_alloc(plan, &sp, s);
+    int P = plan_alloc(plan, &sp, 4 * size64 + 2);
+    plan_node(plan, &sp, n, NEED_P1, f, g, P, size64);
+
+    plan->n = n;
+}
+
+// Whether the schedule is of other tunables than tune, 
+// i.e. its tree or its scratch sizes are not those of tune
+int gf2x_byi_plan_stale(IN byi_plan_t *plan, IN gf2x_tune_t *tune) {
+    return plan->tune.byi_base_blocks != tune->byi_base_blocks ||
+           plan->tune.byi_split       != tune->byi_split ||
+           plan->tune.kara_threshold  != tune->kara_threshold;
+}
+
+// Matrix of a node in the workspace
+static inline polymat_t node_mat(uint64_t *ws, byi_node_t *node) {
+    uint64_t *base = &ws[node->P];
     polymat_t P = {
-        .p0 = { .data = calloc(Psize64, sizeof(uint64_t)), .size64 = 2 * Psize64 },
-        .p1 = { .data = calloc(Psize64, sizeof(uint64_t)), .size64 = 2 * Psize64 },
-        .p2 = { .data = calloc(Psize64, sizeof(uint64_t)), .size64 = 2 * Psize64 },
-        .p3 = { .data = calloc(Psize64, sizeof(uint64_t)), .size64 = 2 * Psize64 },
-        .denom = 0
-    };
-   
-    jnode top = {
-        .n          = 2*d-1,
-        .delta      = 1,
-        .f          = f_rev,
-        .g          = g_rev,
-        .P          = P,
-        .left       = NULL,
-        .right      = NULL,
+        .denom  = node->s,
+        .size64 = node->size64,
+        .p      = { base, base + node->size64, base + 2 * node->size64, base + 3 * node->size64 },
+        .hi     = base + 4 * node->size64
     };
+    return P;
+}
 
-    // Call "jumpdivstepx" function on "top" node
-    jumpdivstepx(&top);
+// Run the k-th operation of the schedule, and return the new delta
+static inline int byi_exec_op(byi_plan_t *plan, uint64_t *ws, int k, int delta) {
+    byi_op_t   *op   = &plan->op[k];
+    byi_node_t *node = &plan->node[op->node];
+    polymat_t P = node_mat(ws, node);
+    int kt = plan->tune.kara_threshold;
 
-    // Multiply P0[1] with x^(2*d-2)
-    poly_right_shift(&(top.P.p1), 64*top.P.denom - (2*d-2));
+    if (op->type == BYI_OP_BASE) {
+        return divstepx_base(node->n, delta, &ws[node->f], &ws[node->g], &P, kt, &ws[op->ws]);
+    }
+
+    byi_node_t *left  = &plan->node[node->left];
+    byi_node_t *right = &plan->node[node->right];
+    polymat_t P1 = node_mat(ws, left);
+
+    if (op->type == BYI_OP_UPDATE) {
+        MatPolyMul(&P1, &ws[node->f], &ws[node->g], right->s, kt,
+                   &ws[right->f], &ws[right->g], &ws[op->ws]);
+    } else {
+        polymat_t P2 = node_mat(ws, right);
+        MatMatMul(&P, &P1, &P2, node->need, kt, &ws[op->ws]);
+    }
+
+    return delta;
+}
+
+// (f, g) of the top node of the schedule <- reversed (x^d - 1, g)
+void gf2x_byi_load(
+    IN byi_plan_t *plan,
+    IN int d,
+    IN poly_t *g,
+    uint64_t *ws
+) {
+    byi_node_t *top = &plan->node[0];
+    uint64_t *f_rev = &ws[top->f];
+    uint64_t *g_rev = &ws[top->g];
+
+    // Reverse of f (i.e. f_rev = f.reverse(d) = f for f = x^d - 1)
+    memset(f_rev, 0, top->s * sizeof(uint64_t));
+    f_rev[d / 64] |= 1ULL << (d % 64);
+    f_rev[0] |= 1;
+
+    // Reverse g (i.e. g_rev = g.reverse(d-1) ), zero padded to s blocks
+    memset(g_rev, 0, top->s * sizeof(uint64_t));
+    reverse(g->data, 0, g_rev, d-1);
+}
+
+// Run the operations of the schedule from the k-th one, until all of 
+// them are done, or cpucycles() reaches deadline after one of them,
+// and return the next one
+// 
+// The tasks of the large products only run in parallel in the team of
+// the caller (if any), i.e. a slice does not open a team of its own.
+int gf2x_byi_resume(
+    IN byi_plan_t *plan,
+    uint64_t *ws,
+    IN int k,
+    INPLACE int *delta,
+    IN unsigned long long deadline
+) {
+    // JumpStep, as the flat loop over the schedule
+    while (k < plan->num_ops) {
+        *delta = byi_exec_op(plan, ws, k, *delta);
+        k += 1;
+        if (deadline != ULLONG_MAX && cpucycles() >= deadline) {
+            break;
+        }
+    }
+    return k;
+}
+
+// Whether gf2x_byi_run opens a team for the tasks of the schedule, i.e. 
+// not for a worker of a pool, nor for a caller which is in a team already
+static inline int byi_team(IN byi_plan_t *plan) {
+#if defined(_OPENMP)
+    return plan->team && !omp_in_parallel();
+#else
+    (void) plan;
+    return 0;
+#endif
+}
+
+// ginv <- the inverse in P[0][1] of the top node, after all the operations
+void gf2x_byi_store(
+    IN byi_plan_t *plan,
+    IN int d,
+    uint64_t *ws,
+    OUT poly_t *ginv
+) {
+    // ginv = reverse of (P[0][1] * x^(2*d-2)), where P[0][1] is kept
+    // as P[0][1] * x^(64*s), in a single pass
+    byi_node_t *top = &plan->node[0];
+    uint64_t *p1 = &ws[top->P + top->size64];
+    reverse(p1, 64*top->s - (2*d-2), ginv->data, d-1);
+}
+
+// g^-1 mod (x^d - 1) by the divsteps of the schedule on f = x^d - 1
+// and g, in the workspace ws of plan->ws_size blocks
+void gf2x_byi_run(
+    IN byi_plan_t *plan,
+    IN int d,
+    IN poly_t *g,
+    OUT poly_t *ginv,
+    uint64_t *ws
+) {
+    int delta = 1;
+    gf2x_byi_load(plan, d, g, ws);
+
+    // A single team for the whole inversion, where a single thread runs
+    // the schedule while the others run the tasks of the large products
+    if (byi_team(plan)) {
+        #pragma omp parallel
+        #pragma omp single
+        gf2x_byi_resume(plan, ws, 0, &delta, ULLONG_MAX);
+    } else {
+        gf2x_byi_resume(plan, ws, 0, &delta, ULLONG_MAX);
+    }
+
+    gf2x_byi_store(plan, d, ws, ginv);
+}
 
-    // ginv = reverse of (P[0][1])  
-    reverse(&(top.P.p1), ginv, d-1);
+/************************************
+ * BYI IN LANES
+ ************************************/
+
+/*
+    The schedule does not depend on the input, so that GF2X_BYI_LANES
+    inversions run it together, each in a workspace of its own.
+    The divsteps of the base cases are computed in the 64-bit lanes of
+    a vector (i.e. 4 in ymm, 8 in zmm) by masks, as in divstepx_64, and
+    the products of UPDATE and MERGE are run for each lane in turn.
+*/
+typedef uint64_t vlane_t __attribute__((vector_size(8 * GF2X_BYI_LANES)));
+
+// divstepx_64 in each lane, on the vectors of f, g and delta, where 
+// the entries u, v, q, r of 65 bits are in a low and a high vector
+static inline vlane_t divstepx_64_lanes(
+    int n, vlane_t delta,
+    vlane_t f, vlane_t g,       // input
+    vlane_t m[4],               // output matrix
+    vlane_t mhi[2]              // output x^64 coefficients of m[0], m[1]
+) {
+    const vlane_t zero = {0};
+    const vlane_t one = zero + 1;
+
+    // u = r = x^64, v = q = 0
+    vlane_t u0 = zero, u1 = one;
+    vlane_t v0 = zero, v1 = zero;
+    vlane_t q0 = zero, q1 = zero;
+    vlane_t r0 = zero, r1 = one;
+
+    vlane_t mask_swap, mask_g0, t;
+
+    for (int i = 0; i < n; i++) {
+        // Swap if delta > 0 and g0 = 1 (f0 is always 1)
+        mask_swap = zero - (((zero - delta) >> 63) & g & 1);
+
+        delta = (delta ^ mask_swap) - mask_swap;
+        t = mask_swap & (f ^ g);      f ^= t;  g ^= t;
+        t = mask_swap & (u0 ^ q0);    u0 ^= t; q0 ^= t;
+        t = mask_swap & (u1 ^ q1);    u1 ^= t; q1 ^= t;
+        t = mask_swap & (v0 ^ r0);    v0 ^= t; r0 ^= t;
+        t = mask_swap & (v1 ^ r1);    v1 ^= t; r1 ^= t;
+
+        delta += 1;
+
+        // g <- (g + g0*f)/x, q <- (q + g0*u)/x, r <- (r + g0*v)/x
+        mask_g0 = zero - (g & 1);
+
+        g  = (g ^ (mask_g0 & f)) >> 1;
+        q0 ^= mask_g0 & u0;
+        q1 ^= mask_g0 & u1;
+        r0 ^= mask_g0 & v0;
+        r1 ^= mask_g0 & v1;
+        q0 = (q0 >> 1) | (q1 << 63);  q1 >>= 1;
+        r0 = (r0 >> 1) | (r1 << 63);  r1 >>= 1;
+    }
+
+    m[0] = u0;
+    m[1] = v0;
+    m[2] = q0;
+    m[3] = r0;
+    mhi[0] = zero - u1;
+    mhi[1] = zero - v1;
+
+    return delta;
+}
+
+// divstepx_base in each lane, i.e. on f[l], g[l] into P[l]
+static inline vlane_t divstepx_base_lanes(
+    int n, vlane_t delta,
+    uint64_t **f, uint64_t **g, // input of each lane
+    polymat_t *P,               // output matrix of each lane
+    int kt,                     // Karatsuba threshold
+    uint64_t **scratch          // merge_scratch(s, kt) blocks of each lane
+) {
+    const int L = GF2X_BYI_LANES;
+    int s = (n + 63) / 64;
+    assert(s <= BASE_BLOCKS);
+
+    uint64_t ff[L][BASE_BLOCKS + 1], gg[L][BASE_BLOCKS + 1];
+    uint64_t m[L][4], mhi[L][2];
+    uint64_t a[L][2][4][BASE_BLOCKS], ah[L][2][2];
+    polymat_t M[L], A[L][2];
+
+    for (int l = 0; l < L; l++) {
+        memset(ff[l], 0, sizeof(ff[l]));
+        memset(gg[l], 0, sizeof(gg[l]));
+        memcpy(ff[l], f[l], s * sizeof(uint64_t));
+        memcpy(gg[l], g[l], s * sizeof(uint64_t));
+
+        M[l] = (polymat_t) {
+            .denom = 1, .size64 = 1,
+            .p = { &m[l][0], &m[l][1], &m[l][2], &m[l][3] },
+            .hi = mhi[l]
+        };
+        for (int k = 0; k < 2; k++) {
+            for (int e = 0; e < 4; e++) {
+                A[l][k].p[e] = a[l][k][e];
+            }
+            A[l][k].hi = ah[l][k];
+        }
+    }
+
+    vlane_t vf = {0}, vg = {0}, vm[4], vmhi[2];
+
+    for (int c = 0; c < s; c++) {
+        // f, g <- m * (f, g) / x^64 on the remaining (s - c + 1) blocks
+        for (int l = 0; c > 0 && l < L; l++) {
+            divstepx_shift(m[l], mhi[l], ff[l], gg[l], s - c + 1);
+        }
+
+        // Next (at most) 64 divsteps in the lanes
+        for (int l = 0; l < L; l++) {
+            vf[l] = ff[l][0];
+            vg[l] = gg[l][0];
+        }
+        delta = divstepx_64_lanes((n - 64*c < 64 ? n - 64*c : 64), delta, vf, vg, vm, vmhi);
+
+        // A[c%2] <- m * A[(c-1)%2], or A[0] <- m
+        for (int l = 0; l < L; l++) {
+            for (int k = 0; k < 4; k++) {
+                m[l][k] = vm[k][l];
+            }
+            mhi[l][0] = vmhi[0][l];
+            mhi[l][1] = vmhi[1][l];
+
+            if (c == 0) {
+                for (int k = 0; k < 4; k++) {
+                    a[l][0][k][0] = m[l][k];
+                }
+                A[l][0].denom = A[l][0].size64 = 1;
+                ah[l][0][0] = mhi[l][0];
+                ah[l][0][1] = mhi[l][1];
+            } else {
+                A[l][c & 1].size64 = c + 1;
+                MatMatMul(&A[l][c & 1], &A[l][(c - 1) & 1], &M[l], NEED_ALL, kt, scratch[l]);
+            }
+        }
+    }
 
-} 
\ No newline at end of file
+    // P <- A[(s-1)%2]
+    for (int l = 0; l < L; l++) {
+        divstepx_store(&A[l][(s - 1) & 1], s, &P[l]);
+    }
+
+    return delta;
+}
+
+// *ginv[l] <- *g[l]^-1 mod (x^d - 1) for GF2X_BYI_LANES inputs by the 
+// schedule, in the workspaces ws + l * plan->ws_size
+void gf2x_byi_run_lanes(
+    IN  byi_plan_t *plan,
+    IN  int d,
+    IN  poly_t **g,
+    OUT poly_t **ginv,
+    uint64_t *ws
+) {
+    const int L = GF2X_BYI_LANES;
+    uint64_t *w[L];
+    uint64_t *f[L], *gl[L], *scratch[L];
+    polymat_t P[L];
+
+    for (int l = 0; l < L; l++) {
+        w[l] = ws + (size_t) l * plan->ws_size;
+        gf2x_byi_load(plan, d, g[l], w[l]);
+    }
+
+    vlane_t delta = {0};
+    delta += 1;
+
+    for (int k = 0; k < plan->num_ops; k++) {
+        byi_op_t   *op   = &plan->op[k];
+        byi_node_t *node = &plan->node[op->node];
+
+        if (op->type != BYI_OP_BASE) {
+            for (int l = 0; l < L; l++) {
+                byi_exec_op(plan, w[l], k, 0);
+            }
+            continue;
+        }
+
+        for (int l = 0; l < L; l++) {
+            f[l]  = &w[l][node->f];
+            gl[l] = &w[l][node->g];
+            scratch[l] = &w[l][op->ws];
+            P[l] = node_mat(w[l], node);
+        }
+        delta = divstepx_base_lanes(node->n, delta, f, gl, P, plan->tune.kara_threshold, scratch);
+    }
+
+    for (int l = 0; l < L; l++) {
+        gf2x_byi_store(plan, d, w[l], ginv[l]);
+    }
+}
+
+// ginv[i] <- g[i]^-1 mod (x^p - 1) for 0 <= i < n using BYI,
+// GF2X_BYI_LANES inputs at a time
+void gf2x_mod_inv_byi_lanes(
+    IN  ctx_t *ctx,
+    IN  int n,
+    IN  poly_t *g,
+    OUT poly_t *ginv
+) {
+    const int L = GF2X_BYI_LANES;
+    int d = ctx->p;
+
+    byi_plan_t *plan = &(ctx->byi);
+    if (plan->n != BYI_DIVSTEPS(d) || gf2x_byi_plan_stale(plan, &gf2x_tune)) {
+        gf2x_ctx_init(ctx);
+    }
+
+    uint64_t *ws = malloc((size_t) L * plan->ws_size * sizeof(uint64_t));
+
+    // The last group is filled up by its first input, into a spare output
+    poly_t spare;
+    gf2x_poly_init(&spare, d - 1);
+    poly_t *in[L], *out[L];
+
+    for (int i = 0; i < n; i += L) {
+        int num = (n - i < L) ? n - i : L;
+        for (int l = 0; l < L; l++) {
+            in[l]  = &g[i + ((l < num) ? l : 0)];
+            out[l] = (l < num) ? &ginv[i + l] : &spare;
+        }
+        gf2x_byi_run_lanes(plan, d, in, out, ws);
+    }
+
+    gf2x_poly_free(&spare);
+    free(ws);
+}
+
+// g^-1 mod (x^d - 1) by n divsteps on f = x^d - 1 and g, 
+// which is correct for all g if n >= BYI_DIVSTEPS(d) = 2d - 1, 
+// and for a given g, if there is no swap after the n-th divstep
+void gf2x_mod_inv_byi_steps(
+    IN ctx_t *ctx, 
+    IN int n,
+    IN poly_t *g, 
+    OUT poly_t *ginv
+) {
+    
+    int d = ctx->p; 
+    assert(n >= d + 1);
+
+    // Schedule of ctx (computed on the first use, and again
+    // after a change of gf2x_tune), or a temporary one for another n
+    byi_plan_t *plan = &(ctx->byi);
+    if (n != BYI_DIVSTEPS(d)) {
+        plan = malloc(sizeof(byi_plan_t));
+        gf2x_byi_plan(plan, &gf2x_tune, d, n);
+    } else if (plan->n != n || gf2x_byi_plan_stale(plan, &gf2x_tune)) {
+        gf2x_ctx_init(ctx);
+    }
+
+    uint64_t *ws = malloc(plan->ws_size * sizeof(uint64_t));
+    gf2x_byi_run(plan, d, g, ginv, ws);
+
+    free(ws);
+    if (plan != &(ctx->byi)) {
+        free(plan);
+    }
+}
+
+// void gf2x_mod_inv_by(int d, poly_t *f, poly_t *g, poly_t *ginv) {
+void gf2x_mod_inv_byi(
+    IN ctx_t *ctx, 
+    poly_t *g, 
+    poly_t *ginv
+) {
+    gf2x_mod_inv_byi_steps(ctx, BYI_DIVSTEPS(ctx->p), g, ginv);
+}
+
+// h * g^-1 mod (x^p - 1) using BYI
+void gf2x_mod_div_byi(
+    IN ctx_t *ctx,
+    IN poly_t *h,
+    IN poly_t *g,
+    OUT poly_t *out
+) {
+    poly_t ginv;
+    gf2x_poly_init(&ginv, ctx->p - 1);
+    gf2x_poly_zeroize(&ginv);
+
+    gf2x_mod_inv_byi(ctx, g, &ginv);
+    gf2x_mod_mul_kara(h, &ginv, out);
+
+    gf2x_poly_free(&ginv);
+}
@@ -43,10 +43,9 @@
  * 
  * ********************************************************/
 
-void gf2x_mod_inv_cea(
-    IN ctx_t *ctx,
-    IN poly_t *g,
-    OUT poly_t *ginv
+void gf2x_chain_cea(
+    IN  ctx_t *ctx,
+    OUT chain_t *chain
 ) {
     int r = ctx->p;
     int a = ctx->cea_a;
@@ -56,73 +55,80 @@ void gf2x_mod_inv_cea(
     int r2 = r - 2;
     assert( (a * b) == r2 );
 
-
-    // Create gamma and copy g to gamma.
-    poly_t gamma;
-    gf2x_poly_init(&gamma, r-1);
-    gf2x_poly_copy(&gamma, g);
-
     // Find s and t
-    int s = 0, t = 0;
-    int tmp = a;
-    while (tmp > 0) {
-        s += 1;
-        tmp >>= 1;
-    }
-    tmp = b;
-    while (tmp > 0) {
-        t += 1;
-        tmp >>= 1;
-    }
+    int s = bitlength(a);
+    int t = bitlength(b);
 
-    // Recursive computations
-    poly_t h;
-    gf2x_poly_init(&h, r-1);
+    gf2x_chain_init(chain);
 
+    // gamma <- g
+    int gamma = 0;
     int k;
 
     for(int i = s-2; i >= 0; i--) {
-        // h <- gamma
-        gf2x_poly_copy(&h, &gamma);
-
         // gamma <- gamma * gamma^(2^(2^i))
         k = (1 << i);
-        gf2x_mod_sqr_k_inplace(&gamma, k);
-        gf2x_mod_mul(&gamma, &h, &gamma);
+        gamma = gf2x_chain_op(chain, gamma, k, gamma);
 
         if (a & (1 << i)) {
             // gamma <- g * gamma^(2^(2^i))
-            gf2x_mod_sqr_k_inplace(&gamma, k);
-            gf2x_mod_mul(&gamma, g, &gamma);
+            gamma = gf2x_chain_op(chain, gamma, k, 0);
         }
-
     }
 
     // gamma <- gamma^2
-    gf2x_mod_sqr_k_inplace(&gamma, 1);
+    gamma = gf2x_chain_op(chain, gamma, 1, -1);
 
-    // Create delta and copy gamma to delta.
-    poly_t delta;
-    gf2x_poly_init(&delta, r-1);
-    gf2x_poly_copy(&delta, &gamma);
+    // delta <- gamma
+    int delta = gamma;
 
     for(int i = t-2; i >= 0; i--) {
-        // h <- delta
-        gf2x_poly_copy(&h, &delta);
-
-        // delta <- delta * delta^(2^(2^i))
+        // delta <- delta * delta^(2^(a * 2^i))
         k = a * (1 << i);
-        gf2x_mod_sqr_k_inplace(&delta, k);
-        gf2x_mod_mul(&delta, &h, &delta);
+        delta = gf2x_chain_op(chain, delta, k, delta);
 
         if (b & (1 << i)) {
-            // delta <- g * delta^(2^(2^i))
-            gf2x_mod_sqr_k_inplace(&delta, k);
-            gf2x_mod_mul(&delta, &gamma, &delta);
+            // delta <- gamma * delta^(2^(a * 2^i))
+            delta = gf2x_chain_op(chain, delta, k, gamma);
         }
+    }
+
+    // ginv <- delta, which must be the last value
+    if (delta != chain->num_ops) {
+        gf2x_chain_op(chain, delta, 0, -1);
+    }
 
+    gf2x_chain_compile(chain);
+}
+
+void gf2x_mod_inv_cea(
+    IN ctx_t *ctx,
+    IN poly_t *g,
+    OUT poly_t *ginv
+) {
+    // Parameters of a prime without its entry in params.h
+    if (ctx->cea_a == 0) {
+        gf2x_params_search(ctx, NULL);
     }
 
-    // ginv <- delta
-    gf2x_poly_copy(ginv, &delta);
+    chain_t chain;
+    gf2x_chain_cea(ctx, &chain);
+    gf2x_chain_run(&chain, g, ginv);
+}
+
+// h * g^-1 mod x^r -1 using CEA Inversion
+void gf2x_mod_div_cea(
+    IN ctx_t *ctx,
+    IN poly_t *h,
+    IN poly_t *g,
+    OUT poly_t *out
+) {
+    poly_t ginv;
+    gf2x_poly_init(&ginv, ctx->p - 1);
+    gf2x_poly_zeroize(&ginv);
+
+    gf2x_mod_inv_cea(ctx, g, &ginv);
+    gf2x_mod_mul_kara(h, &ginv, out);
+
+    gf2x_poly_free(&ginv);
 }
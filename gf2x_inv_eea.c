@@ -0,0 +1,279 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Emrah Karagoz, Pakize Sanal, Abhraneel Dutta, Edoardo Persichetti
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gf2x.h"
+
+/*********************************************************
+ * Extended Euclid's Algorithm (EEA) in VARIABLE TIME
+ * Input: f(x) = x^p - 1,
+ *        g(x), which is PUBLIC
+ * Output: V(x), such that g(x)^-1 = V(x) mod f(x), and 1,
+ *         or V(x) = 0 and 0 if g(x) is not invertible
+ *
+ * The running time and the memory accesses depend on g,
+ * so that it must not be used for secret inputs.
+ *
+ * (a, b) <- (f, g) and (u, v) <- (0, 1), so that a = u*g and
+ * b = v*g mod f, are reduced by the steps
+ *     a <- a + x^s * b,  u <- u + x^s * v,  s = deg(a) - deg(b)
+ * until b = 0, i.e. a = 1 and u = g^-1.
+ *
+ * The steps are found on the top 128 bits of a and b (Lehmer), and
+ * collected in a 2x2 matrix of 1-block polynomials, which is applied
+ * to (a, b) and (u, v) at once. The top bits of a and b only depend
+ * on these bits, as long as they are above the degree of the matrix.
+**********************************************************/
+
+typedef unsigned __int128 uint128_t;
+
+// Degree of a (of n blocks), and -1 for a = 0
+static inline int eea_deg(IN uint64_t *a, IN int n) {
+    for (int i = n - 1; i >= 0; i--) {
+        if (a[i]) {
+            return 64 * i + 63 - __builtin_clzll(a[i]);
+        }
+    }
+    return -1;
+}
+
+// Degree of a 128-bit polynomial, and -1 for a = 0
+static inline int eea_deg128(uint128_t a) {
+    uint64_t hi = (uint64_t) (a >> 64);
+    uint64_t lo = (uint64_t) a;
+    if (hi) return 127 - __builtin_clzll(hi);
+    if (lo) return  63 - __builtin_clzll(lo);
+    return -1;
+}
+
+// Bits [m, m + 128) of a (of n blocks)
+static inline uint128_t eea_window(IN uint64_t *a, IN int n, IN int m) {
+    int bs = m / 64;
+    int k  = m % 64;
+    uint64_t w[3];
+    for (int i = 0; i < 3; i++) {
+        w[i] = (bs + i < n) ? a[bs + i] : 0;
+    }
+    uint64_t lo = (k == 0) ? w[0] : ((w[0] >> k) | (w[1] << (64 - k)));
+    uint64_t hi = (k == 0) ? w[1] : ((w[1] >> k) | (w[2] << (64 - k)));
+    return ((uint128_t) hi << 64) | lo;
+}
+
+// a <- a + x^s * b, for b of n blocks
+static inline void eea_add_shifted(INPLACE uint64_t *a, IN uint64_t *b, IN int n, IN int s) {
+    int bs = s / 64;
+    int k  = s % 64;
+    if (k == 0) {
+        for (int i = 0; i < n; i++) {
+            a[bs + i] ^= b[i];
+        }
+    } else {
+        for (int i = 0; i < n; i++) {
+            a[bs + i]     ^= b[i] << k;
+            a[bs + i + 1] ^= b[i] >> (64 - k);
+        }
+    }
+}
+
+// (c, d) <- M * (a, b) for n-block a and b, i.e. n + 1 blocks
+static inline void eea_apply(
+    IN  uint64_t M[4],
+    IN  uint64_t *a,
+    IN  uint64_t *b,
+    IN  int n,
+    OUT uint64_t *c,
+    OUT uint64_t *d
+) {
+    memset(c, 0, (n + 1) * sizeof(uint64_t));
+    memset(d, 0, (n + 1) * sizeof(uint64_t));
+    gf2x_mul_words(&M[0], 1, a, n, c);
+    gf2x_mul_words(&M[1], 1, b, n, c);
+    gf2x_mul_words(&M[2], 1, a, n, d);
+    gf2x_mul_words(&M[3], 1, b, n, d);
+}
+
+/*
+    Steps on the windows A, B (of a, b at bit m), as long as the degrees
+    of A and B are exact and the matrix is of 1-block polynomials.
+    Returns the number of steps, and M such that (A, B) <- M * (A, B).
+*/
+static inline int eea_lehmer(uint128_t A, uint128_t B, int m, uint64_t M[4]) {
+    // Rows of M for A and B, and their degrees
+    uint64_t ra[2] = {1, 0}, rb[2] = {0, 1}, t;
+    int da = 0, db = 0, k, steps = 0;
+    uint128_t T;
+
+    while (B != 0) {
+        int degA = eea_deg128(A);
+        int degB = eea_deg128(B);
+
+        if (degA < degB) {
+            T = A; A = B; B = T;
+            t = ra[0]; ra[0] = rb[0]; rb[0] = t;
+            t = ra[1]; ra[1] = rb[1]; rb[1] = t;
+            k = da;   da = db;     db = k;
+            k = degA; degA = degB; degB = k;
+        }
+
+        // The bits of a (and b) below x^(m + da) are not known
+        if (m > 0 && (degA < da || degB < db)) {
+            break;
+        }
+
+        int s = degA - degB;
+        if (db + s > 63) {
+            break;
+        }
+
+        A ^= B << s;
+        ra[0] ^= rb[0] << s;
+        ra[1] ^= rb[1] << s;
+        da = (da > db + s) ? da : db + s;
+        steps++;
+    }
+
+    M[0] = ra[0]; M[1] = ra[1];
+    M[2] = rb[0]; M[3] = rb[1];
+    return steps;
+}
+
+int gf2x_mod_inv_eea(
+    IN ctx_t *ctx,
+    IN poly_t *g,
+    OUT poly_t *ginv
+) {
+    int p = ctx->p;
+    int n = p / 64 + 2;     // blocks of a, b, u, v (and one for the products)
+
+    uint64_t *buf = calloc(8 * (n + 1), sizeof(uint64_t));
+    uint64_t *a = &buf[0 * (n + 1)], *b = &buf[1 * (n + 1)];
+    uint64_t *u = &buf[2 * (n + 1)], *v = &buf[3 * (n + 1)];
+    uint64_t *c = &buf[4 * (n + 1)], *d = &buf[5 * (n + 1)];
+    uint64_t *x = &buf[6 * (n + 1)], *y = &buf[7 * (n + 1)];
+    uint64_t *t, M[4];
+
+    // (a, b) <- (x^p - 1, g), (u, v) <- (0, 1)
+    a[p / 64] |= 1ULL << (p % 64);
+    a[0] |= 1;
+    memcpy(b, g->data, (p + 63) / 64 * sizeof(uint64_t));
+    v[0] = 1;
+
+    int dega = p;
+    int degb = eea_deg(b, n);
+    int lenuv = 1;          // blocks of u and v
+
+    while (degb >= 0) {
+        if (dega < degb) {
+            t = a; a = b; b = t;
+            t = u; u = v; v = t;
+            int k = dega; dega = degb; degb = k;
+        }
+
+        int s = dega - degb;
+        int lenab = dega / 64 + 1;
+
+        if (s >= 64) {
+            // Single long step, as the window of a does not reach b
+            eea_add_shifted(a, b, degb / 64 + 1, s);
+            eea_add_shifted(u, v, lenuv, s);
+            lenuv = (lenuv + s / 64 + 1 < n) ? (lenuv + s / 64 + 1) : n;
+            dega = eea_deg(a, lenab);
+            continue;
+        }
+
+        // Steps on the top 128 bits, then on the whole polynomials
+        int m = (dega >= 127) ? dega - 127 : 0;
+        eea_lehmer(eea_window(a, lenab, m), eea_window(b, lenab, m), m, M);
+
+        eea_apply(M, a, b, lenab, c, d);
+        eea_apply(M, u, v, lenuv, x, y);
+        t = a; a = c; c = t;
+        t = b; b = d; d = t;
+        t = u; u = x; x = t;
+        t = v; v = y; y = t;
+
+        lenuv = (lenuv + 1 < n) ? (lenuv + 1) : n;
+        dega = eea_deg(a, lenab);
+        degb = eea_deg(b, lenab);
+    }
+
+    // a = gcd(f, g), i.e. g is invertible if a = 1, and g^-1 = u mod (x^p - 1)
+    if (dega != 0) {
+        gf2x_poly_zeroize(ginv);
+        free(buf);
+        return 0;
+    }
+    for (int i = eea_deg(u, n); i >= p; i--) {
+        if ((u[i / 64] >> (i % 64)) & 1) {
+            u[i / 64] ^= 1ULL << (i % 64);
+            u[(i - p) / 64] ^= 1ULL << ((i - p) % 64);
+        }
+    }
+
+    memcpy(ginv->data, u, (p + 63) / 64 * sizeof(uint64_t));
+    free(buf);
+    return 1;
+}
+
+// h * g^-1 mod (x^p - 1) using EEA, in variable time, and 1
+// (or 0, and out = 0, if g is not invertible)
+int gf2x_mod_div_eea(
+    IN ctx_t *ctx,
+    IN poly_t *h,
+    IN poly_t *g,
+    OUT poly_t *out
+) {
+    poly_t ginv;
+    gf2x_poly_init(&ginv, ctx->p - 1);
+    gf2x_poly_zeroize(&ginv);
+
+    int ok = gf2x_mod_inv_eea(ctx, g, &ginv);
+    gf2x_mod_mul_kara(h, &ginv, out);
+
+    gf2x_poly_free(&ginv);
+    return ok;
+}
+
+// g^-1 mod (x^p - 1) in variable time, for public g only
+int gf2x_mod_inv_public(
+    IN ctx_t *ctx,
+    IN poly_t *g,
+    OUT poly_t *ginv
+) {
+    return gf2x_mod_inv_eea(ctx, g, ginv);
+}
+
+// h * g^-1 mod (x^p - 1) in variable time, for public h and g only
+int gf2x_mod_div_public(
+    IN ctx_t *ctx,
+    IN poly_t *h,
+    IN poly_t *g,
+    OUT poly_t *out
+) {
+    return gf2x_mod_div_eea(ctx, h, g, out);
+}
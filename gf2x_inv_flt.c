@@ -29,57 +29,36 @@
 
 #include "gf2x.h"
 
-// Compute g^-1 mod x^r -1
-// where g is a polynomials over GF(2)
-void gf2x_mod_inv_flt(
-    IN ctx_t *ctx,
-    IN poly_t *g,
-    OUT poly_t *ginv
-) {   
+// Addition chain of g^-1 mod x^r -1 for FLT
+void gf2x_chain_flt(
+    IN  ctx_t *ctx,
+    OUT chain_t *chain
+) {
     // r - 2
     int r = ctx->p;
     int r2 = r - 2;
     assert( (r2 & 1) == 1 );
     r2 >>= 1;
 
-    // Create b and c, and copy g to b & c.    
-    poly_t b;
-    gf2x_poly_init(&b, r-1);
-    gf2x_poly_copy(&b, g);
-        
-    poly_t c;
-    gf2x_poly_init(&c, r-1);
-    gf2x_poly_copy(&c, g);
+    gf2x_chain_init(chain);
+
+    // b = c = g
+    int b = 0;
+    int c = 0;
 
     // Recursive computations
     int i = 1;
     int k;
 
-    poly_t tmp;
-    gf2x_poly_init(&tmp, r-1);
-
-
     while (r2 > 0) {
         k = 1 << (i-1);
 
-        // tmp <- c
-        gf2x_poly_copy(&tmp, &c);
-
-        // c <- c^(2^k) 
-        gf2x_mod_sqr_k_inplace(&c, k);
-
         // c <- c^(2^k) * c
-        gf2x_mod_mul(&c, &tmp, &c);
+        c = gf2x_chain_op(chain, c, k, c);
 
         if (r2 & 1) {
-            // k = 2^i
-            k <<= 1;
-
-            // b <- b^(2^k)
-            gf2x_mod_sqr_k_inplace(&b, k);
-
-            // b <- b * c
-            gf2x_mod_mul(&b, &c, &b);
+            // b <- b^(2^(2^i)) * c
+            b = gf2x_chain_op(chain, b, k << 1, c);
         }
 
         i += 1;
@@ -87,10 +66,36 @@ void gf2x_mod_inv_flt(
     }
 
     // ginv = b^2
-    gf2x_mod_sqr(&b, ginv);
+    gf2x_chain_op(chain, b, 1, -1);
+
+    gf2x_chain_compile(chain);
+}
+
+// Compute g^-1 mod x^r -1
+// where g is a polynomials over GF(2)
+void gf2x_mod_inv_flt(
+    IN ctx_t *ctx,
+    IN poly_t *g,
+    OUT poly_t *ginv
+) {
+    chain_t chain;
+    gf2x_chain_flt(ctx, &chain);
+    gf2x_chain_run(&chain, g, ginv);
+}
+
+// h * g^-1 mod x^r -1 using FLT-based Inversion
+void gf2x_mod_div_flt(
+    IN ctx_t *ctx,
+    IN poly_t *h,
+    IN poly_t *g,
+    OUT poly_t *out
+) {
+    poly_t ginv;
+    gf2x_poly_init(&ginv, ctx->p - 1);
+    gf2x_poly_zeroize(&ginv);
+
+    gf2x_mod_inv_flt(ctx, g, &ginv);
+    gf2x_mod_mul_kara(h, &ginv, out);
 
-    // free
-    gf2x_poly_free(&b);
-    gf2x_poly_free(&c);
-    gf2x_poly_free(&tmp);
+    gf2x_poly_free(&ginv);
 }
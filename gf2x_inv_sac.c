@@ -45,13 +45,10 @@
  * h in C
  * 
  * ******************************************/
-void gf2x_mod_inv_sac(
+void gf2x_chain_sac(
     IN  ctx_t       *ctx,       // Context
-    IN  poly_t      *g,         // input polynomial g
-    OUT poly_t      *ginv       // the inverse of g
+    OUT chain_t     *chain      // the addition chain of g^-1
 ) {
-    int p = ctx->p;
-
     int h = ctx->sac_h;
     int h_idx = ctx->sac_h_idx;
     int r = ctx->sac_r;
@@ -60,65 +57,82 @@ void gf2x_mod_inv_sac(
     int *C = ctx->sac_C;
     int *A = ctx->sac_A;
     int lenC = ctx->sac_lenC;
-    
-    // Polys
-    poly_t delta, delta_r, delta_h, gamma;
-    gf2x_poly_init(&delta, p-1);
-    gf2x_poly_init(&delta_r, p-1);
-    gf2x_poly_init(&delta_h, p-1);
-    gf2x_poly_init(&gamma, p-1);
-
-    // Chain Inverse
-    poly_t tmp;
-    gf2x_poly_init(&tmp, p-1);
-
-    // Initiate the list of delta polynomials
-    poly_t L[lenC];
-    for(int i = 0; i < lenC; i++) {
-        gf2x_poly_init(&L[i], p-1);
-    }
-    gf2x_poly_copy(&L[0], g);
+
+    gf2x_chain_init(chain);
 
     // Construct a list of delta's such that
     // delta[i] = alpha^(2^ci -1)
+    int L[lenC];
+    L[0] = 0;
+
     int i1, i2;
     for (int i = 1; i < lenC; i++) {
         // i1, i2 = A[2*i-2], A[2*i-1]
         i1 = A[2*i-2];
         i2 = A[2*i-1];
-        gf2x_poly_copy(&tmp, &L[i1]);
-        gf2x_mod_sqr_k_inplace(&tmp, C[i2]);
-        gf2x_mod_mul(&L[i2], &tmp, &L[i]);
+        L[i] = gf2x_chain_op(chain, L[i1], C[i2], L[i2]);
     }
 
-    gf2x_poly_copy(&delta_r, &L[lenC - 1]);
-    gf2x_poly_copy(&delta_h, &L[h_idx]);
+    int delta_r = L[lenC - 1];
+    int delta_h = L[h_idx];
 
     // Factors
     // gamma <- delta_r
-    gf2x_poly_copy(&gamma, &delta_r);
+    int gamma = delta_r;
 
     for (int i = bitlength(n) - 2; i >= 0; i--) {
         // gamma <- gamma * gamma^(2^(r * 2^i))
-        gf2x_poly_copy(&tmp, &gamma);
-        gf2x_mod_sqr_k_inplace(&gamma, r * (1 << i));
-        gf2x_mod_mul(&gamma, &tmp, &gamma);
-        
+        gamma = gf2x_chain_op(chain, gamma, r * (1 << i), gamma);
+
         if ((n >> i) & 1) {
-            gf2x_mod_sqr_k_inplace(&gamma, r * (1 << i));        
-            gf2x_mod_mul(&gamma, &delta_r, &gamma);
+            gamma = gf2x_chain_op(chain, gamma, r * (1 << i), delta_r);
         }
     }
-    
+
     // Final Phase
     if (h == 0) {
-        gf2x_poly_copy(ginv, &gamma);
+        // ginv <- gamma, which must be the last value
+        if (gamma != chain->num_ops) {
+            gf2x_chain_op(chain, gamma, 0, -1);
+        }
     } else {
         // delta <- delta_h * gamma^(2^h)
-        gf2x_mod_sqr_k_inplace(&gamma, h);
-        gf2x_mod_mul(&delta_h, &gamma, &delta);
+        int delta = gf2x_chain_op(chain, gamma, h, delta_h);
         // ginv = delta^2
-        gf2x_mod_sqr(&delta, ginv);
+        gf2x_chain_op(chain, delta, 1, -1);
+    }
+
+    gf2x_chain_compile(chain);
+}
+
+void gf2x_mod_inv_sac(
+    IN  ctx_t       *ctx,       // Context
+    IN  poly_t      *g,         // input polynomial g
+    OUT poly_t      *ginv       // the inverse of g
+) {
+    // Parameters of a prime without its entry in params.h
+    if (ctx->sac_lenC == 0) {
+        gf2x_params_search(ctx, NULL);
     }
 
-}
\ No newline at end of file
+    chain_t chain;
+    gf2x_chain_sac(ctx, &chain);
+    gf2x_chain_run(&chain, g, ginv);
+}
+
+// h * g^-1 mod x^r -1 using SAC Inversion
+void gf2x_mod_div_sac(
+    IN ctx_t *ctx,
+    IN poly_t *h,
+    IN poly_t *g,
+    OUT poly_t *out
+) {
+    poly_t ginv;
+    gf2x_poly_init(&ginv, ctx->p - 1);
+    gf2x_poly_zeroize(&ginv);
+
+    gf2x_mod_inv_sac(ctx, g, &ginv);
+    gf2x_mod_mul_kara(h, &ginv, out);
+
+    gf2x_poly_free(&ginv);
+}
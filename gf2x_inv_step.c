@@ -0,0 +1,172 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Emrah Karagoz, Pakize Sanal, Abhraneel Dutta, Edoardo Persichetti
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <assert.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "gf2x.h"
+
+/*********************************************************
+ * Resumable inversion
+ *
+ * gf2x_inv_begin compiles the chain of FLT, CEA, TYT or SAC (or
+ * copies the BYI schedule of ctx), and gf2x_inv_step runs it for a
+ * budget of cycles, so that a scheduler interleaves many inversions
+ * on a core. The state only lives in the caller's gf2x_inv_state_t,
+ * i.e. a new schedule of ctx (e.g. after a change of gf2x_tune) does
+ * not change the inversions in progress.
+ *
+ * The unit of work is a single squaring or multiplication of a chain,
+ * or an operation of the BYI schedule, i.e. a slice ends after the
+ * first unit which reaches the budget. The largest BYI operation is
+ * the product of the top node, so that the slices of BYI are coarser.
+ *
+ * The units only depend on the method and p (not on g), i.e. the
+ * number of steps of an inversion does not leak anything about g
+ * beyond the running time of each unit.
+**********************************************************/
+
+// Number of units of a chain operation, i.e. its squarings, 
+// and then its multiplication (or copy for k = 0)
+static inline int op_units(IN chain_op_t *op) {
+    return op->k + ((op->mul >= 0 || op->k == 0) ? 1 : 0);
+}
+
+// Run the sub-th unit of the chain operation op
+static void chain_unit(IN chain_op_t *op, IN int sub, poly_t *reg) {
+    poly_t *dst = &reg[op->rdst];
+    poly_t *src = &reg[op->rsrc];
+
+    if (sub < op->k) {
+        // The first squaring reads src (unless in-place), the others dst
+        gf2x_mod_sqr((sub == 0) ? src : dst, dst);
+    } else if (op->k > 0) {
+        gf2x_mod_mul(dst, &reg[op->rmul], dst);
+    } else if (op->mul >= 0) {
+        gf2x_mod_mul(src, &reg[op->rmul], dst);
+    } else {
+        gf2x_poly_copy(dst, src);
+    }
+}
+
+void gf2x_inv_begin(
+    OUT gf2x_inv_state_t *st,
+    IN  ctx_t *ctx,
+    IN  int method,
+    IN  poly_t *g
+) {
+    if (method == 0) {
+        method = ctx->inv_method ? ctx->inv_method : gf2x_inv_select(ctx);
+    }
+
+    st->ctx = ctx;
+    st->method = method;
+    st->pos = 0;
+    st->sub = 0;
+    st->delta = 1;
+    st->reg = NULL;
+    st->ws = NULL;
+    st->byi = NULL;
+
+    if (method == BYI) {
+        if (ctx->byi.n != BYI_DIVSTEPS(ctx->p) || gf2x_byi_plan_stale(&(ctx->byi), &gf2x_tune)) {
+            gf2x_ctx_init(ctx);
+        }
+        st->byi = malloc(sizeof(byi_plan_t));
+        *st->byi = ctx->byi;
+        st->ws = malloc(st->byi->ws_size * sizeof(uint64_t));
+        gf2x_byi_load(st->byi, ctx->p, g, st->ws);
+        return;
+    }
+
+    // Registers of the chain, where the input is a copy of g
+    gf2x_chain_method(ctx, method, &st->chain);
+    st->reg = malloc(st->chain.num_regs * sizeof(poly_t));
+    for (int r = 0; r < st->chain.num_regs; r++) {
+        gf2x_poly_init(&st->reg[r], ctx->p - 1);
+    }
+    gf2x_poly_copy(&st->reg[CHAIN_REG_IN], g);
+}
+
+int gf2x_inv_step(
+    INPLACE gf2x_inv_state_t *st,
+    IN unsigned long long budget
+) {
+    unsigned long long deadline = (budget == ULLONG_MAX) ? ULLONG_MAX : cpucycles() + budget;
+
+    if (st->method == BYI) {
+        st->pos = gf2x_byi_resume(st->byi, st->ws, st->pos, &st->delta, deadline);
+        return st->pos == st->byi->num_ops;
+    }
+
+    chain_t *chain = &st->chain;
+    while (st->pos < chain->num_ops) {
+        chain_op_t *op = &chain->op[st->pos];
+        chain_unit(op, st->sub, st->reg);
+
+        st->sub += 1;
+        if (st->sub == op_units(op)) {
+            st->pos += 1;
+            st->sub = 0;
+        }
+        if (deadline != ULLONG_MAX && cpucycles() >= deadline) {
+            break;
+        }
+    }
+    return st->pos == chain->num_ops;
+}
+
+void gf2x_inv_finish(
+    INPLACE gf2x_inv_state_t *st,
+    OUT poly_t *ginv
+) {
+    gf2x_inv_step(st, ULLONG_MAX);
+
+    if (st->method == BYI) {
+        gf2x_byi_store(st->byi, st->ctx->p, st->ws, ginv);
+    } else {
+        gf2x_poly_copy(ginv, &st->reg[CHAIN_REG_OUT]);
+    }
+
+    gf2x_inv_abort(st);
+}
+
+void gf2x_inv_abort(INPLACE gf2x_inv_state_t *st) {
+    if (st->reg != NULL) {
+        for (int r = 0; r < st->chain.num_regs; r++) {
+            gf2x_poly_free(&st->reg[r]);
+        }
+        free(st->reg);
+        st->reg = NULL;
+    }
+    free(st->ws);
+    free(st->byi);
+    st->ws = NULL;
+    st->byi = NULL;
+}
@@ -54,10 +54,9 @@
  * where q = max(qi)
  * 
  * ***************************/
-void gf2x_mod_inv_tyt(
+void gf2x_chain_tyt(
     IN  ctx_t       *ctx,       // Context
-    IN  poly_t      *g,         // input polynomial g
-    OUT poly_t      *ginv       // the inverse of g
+    OUT chain_t     *chain      // the addition chain of g^-1
 ) {
     int p = ctx->p;
     int h = ctx->tyt_h;
@@ -86,82 +85,97 @@ void gf2x_mod_inv_tyt(
 
     int t = bitlength(h);
 
-    // First phase: Construction of F    
-    poly_t F[max_q];
+    gf2x_chain_init(chain);
 
-    gf2x_poly_init(&F[0], p-1);
-    gf2x_poly_copy(&F[0], g);
-
-    for(int i = 1; i < max_q; i++) {
-        gf2x_poly_init(&F[i], p-1);
-    }
+    // First phase: Construction of F
+    int F[max_q];
+    F[0] = 0;
 
     for(int i = 1; i < q[0]; i++) {
-        // F[i] <- F[i-1]
-        gf2x_poly_copy(&F[i], &F[i-1]);
         // F[i] <- F[i-1]^(2^(i-1) + 1)
-        gf2x_mod_sqr_k_inplace(&F[i], 1 << (i-1));
-        gf2x_mod_mul(&F[i], &F[i-1], &F[i]);
+        F[i] = gf2x_chain_op(chain, F[i-1], 1 << (i-1), F[i-1]);
     }
 
-    // Second phase: Compute delta    
-    poly_t delta;
-    gf2x_poly_init(&delta, p-1);
-    gf2x_poly_copy(&delta, &F[q[0]-1]);
+    // Second phase: Compute delta
+    int delta = F[q[0]-1];
 
     for(int i = q[0]-2; i >= 0; i--) {
         if ((r[0] >> i) & 1) {
-            gf2x_mod_sqr_k_inplace(&delta, (1 << i));
-            gf2x_mod_mul(&delta, &F[i], &delta);
+            delta = gf2x_chain_op(chain, delta, (1 << i), F[i]);
         }
     }
 
     // Third phase: Compute gamma
-    poly_t gamma;
-    gf2x_poly_init(&gamma, p-1);
-    gf2x_poly_copy(&gamma, &F[t-1]);
+    int gamma = F[t-1];
 
     for (int i = t-2; i >= 0; i--) {
         if ((h >> i) & 1) {
-            gf2x_mod_sqr_k_inplace(&gamma, (1 << i));
-            gf2x_mod_mul(&gamma, &F[i], &gamma);
+            gamma = gf2x_chain_op(chain, gamma, (1 << i), F[i]);
         }
     }
 
     // Fourth phase: Update the list F and delta
     int N = r[0];
-    gf2x_poly_copy(&F[0], &delta);
+    F[0] = delta;
 
     for(int j = 1; j < k; j++) {
-        
+
         for(int i = 1; i < q[j]; i++) {
-            // F[i] <- F[i-1]
-            gf2x_poly_copy(&F[i], &F[i-1]);
-            // F[i] <- F[i-1]^(2^(i-1) + 1)
-            gf2x_mod_sqr_k_inplace(&F[i], N * (1 << (i-1)));
-            gf2x_mod_mul(&F[i], &F[i-1], &F[i]);
+            // F[i] <- F[i-1]^(2^(N * 2^(i-1)) + 1)
+            F[i] = gf2x_chain_op(chain, F[i-1], N * (1 << (i-1)), F[i-1]);
         }
 
         // delta <- F[qj-1]
-        gf2x_poly_copy(&delta, &F[q[j]-1]);
+        delta = F[q[j]-1];
 
         for (int i = q[j] - 2; i >= 0; i--) {
             if ((r[j] >> i) & 1) {
-                gf2x_mod_sqr_k_inplace(&delta, N * (1 << i));
-                gf2x_mod_mul(&delta, &F[i], &delta);
+                delta = gf2x_chain_op(chain, delta, N * (1 << i), F[i]);
             }
         }
 
         // F[0} <- delta
-        gf2x_poly_copy(&F[0], &delta);
+        F[0] = delta;
 
         // Update N
         N *= r[j];
     }
 
     // Final phase
-    gf2x_mod_sqr_k_inplace(&gamma, p-2-h);
-    gf2x_mod_mul(&gamma, &delta, &gamma);
-    gf2x_mod_sqr(&gamma, ginv);
+    gamma = gf2x_chain_op(chain, gamma, p-2-h, delta);
+    gf2x_chain_op(chain, gamma, 1, -1);
+
+    gf2x_chain_compile(chain);
+}
+
+void gf2x_mod_inv_tyt(
+    IN  ctx_t       *ctx,       // Context
+    IN  poly_t      *g,         // input polynomial g
+    OUT poly_t      *ginv       // the inverse of g
+) {
+    // Parameters of a prime without its entry in params.h
+    if (ctx->tyt_k == 0) {
+        gf2x_params_search(ctx, NULL);
+    }
+
+    chain_t chain;
+    gf2x_chain_tyt(ctx, &chain);
+    gf2x_chain_run(&chain, g, ginv);
+}
+
+// h * g^-1 mod x^r -1 using TYT Inversion
+void gf2x_mod_div_tyt(
+    IN ctx_t *ctx,
+    IN poly_t *h,
+    IN poly_t *g,
+    OUT poly_t *out
+) {
+    poly_t ginv;
+    gf2x_poly_init(&ginv, ctx->p - 1);
+    gf2x_poly_zeroize(&ginv);
+
+    gf2x_mod_inv_tyt(ctx, g, &ginv);
+    gf2x_mod_mul_kara(h, &ginv, out);
 
+    gf2x_poly_free(&ginv);
 }
@@ -0,0 +1,339 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Emrah Karagoz, Pakize Sanal, Abhraneel Dutta, Edoardo Persichetti
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gf2x.h"
+
+/*********************************************************
+ * Inversion of GF2X_LANES polynomials in lockstep
+ *
+ * The chains of FLT, CEA, TYT and SAC depend only on ctx, i.e.
+ * the same squarings and multiplications are run for any input,
+ * so that GF2X_LANES inputs are run together in the lanes of
+ * vector registers (4 in zmm, 2 in ymm, or 1 in xmm).
+ *
+ * A polynomial is a list of units of two 64-bit blocks, and the
+ * lanes are interleaved by units (SoA), i.e. the u-th vector of
+ * a register is the u-th unit of each lane. VPCLMULQDQ multiplies
+ * a block of each lane, and the squaring, the multiplication
+ * (by the 3-multiplication Karatsuba of the units) and the
+ * reduction mod (x^r - 1) are done lane-wise as in gf2x_sqr.c,
+ * gf2x_mul.c and gf2x_red.c.
+**********************************************************/
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <x86intrin.h>
+
+#if GF2X_LANES == 4
+    typedef __m512i vec_t;
+    #define VEC_ZERO()          _mm512_setzero_si512()
+    #define VEC_LOAD(p)         _mm512_loadu_si512((const void *)(p))
+    #define VEC_STORE(p, a)     _mm512_storeu_si512((void *)(p), a)
+    #define VEC_XOR(a, b)       _mm512_xor_si512(a, b)
+    #define VEC_AND(a, b)       _mm512_and_si512(a, b)
+    #define VEC_OR(a, b)        _mm512_or_si512(a, b)
+    #define VEC_CLMUL(a, b, i)  _mm512_clmulepi64_epi128(a, b, i)
+    #define VEC_BSLLI(a)        _mm512_bslli_epi128(a, 8)
+    #define VEC_BSRLI(a)        _mm512_bsrli_epi128(a, 8)
+    #define VEC_SRLI(a, s)      _mm512_srli_epi64(a, s)
+    #define VEC_SLLI(a, s)      _mm512_slli_epi64(a, s)
+    #define VEC_ALIGNR(b, a)    _mm512_alignr_epi8(b, a, 8)
+#elif GF2X_LANES == 2
+    typedef __m256i vec_t;
+    #define VEC_ZERO()          _mm256_setzero_si256()
+    #define VEC_LOAD(p)         _mm256_loadu_si256((const __m256i *)(p))
+    #define VEC_STORE(p, a)     _mm256_storeu_si256((__m256i *)(p), a)
+    #define VEC_XOR(a, b)       _mm256_xor_si256(a, b)
+    #define VEC_AND(a, b)       _mm256_and_si256(a, b)
+    #define VEC_OR(a, b)        _mm256_or_si256(a, b)
+    #define VEC_CLMUL(a, b, i)  _mm256_clmulepi64_epi128(a, b, i)
+    #define VEC_BSLLI(a)        _mm256_bslli_epi128(a, 8)
+    #define VEC_BSRLI(a)        _mm256_bsrli_epi128(a, 8)
+    #define VEC_SRLI(a, s)      _mm256_srli_epi64(a, s)
+    #define VEC_SLLI(a, s)      _mm256_slli_epi64(a, s)
+    #define VEC_ALIGNR(b, a)    _mm256_alignr_epi8(b, a, 8)
+#else
+    typedef __m128i vec_t;
+    #define VEC_ZERO()          _mm_setzero_si128()
+    #define VEC_LOAD(p)         _mm_loadu_si128((const __m128i *)(p))
+    #define VEC_STORE(p, a)     _mm_storeu_si128((__m128i *)(p), a)
+    #define VEC_XOR(a, b)       _mm_xor_si128(a, b)
+    #define VEC_AND(a, b)       _mm_and_si128(a, b)
+    #define VEC_OR(a, b)        _mm_or_si128(a, b)
+    #define VEC_CLMUL(a, b, i)  _mm_clmulepi64_si128(a, b, i)
+    #define VEC_BSLLI(a)        _mm_bslli_si128(a, 8)
+    #define VEC_BSRLI(a)        _mm_bsrli_si128(a, 8)
+    #define VEC_SRLI(a, s)      _mm_srli_epi64(a, s)
+    #define VEC_SLLI(a, s)      _mm_slli_epi64(a, s)
+    #define VEC_ALIGNR(b, a)    _mm_alignr_epi8(b, a, 8)
+#endif
+
+// Number of units of a polynomial (the last one may be half of a unit)
+#define NUM_UNITS   CEIL(NUM_BLOCKS, 2)
+
+// Lane-wise scratch, i.e. the images of the units and the product
+typedef struct {
+    vec_t ak[NUM_UNITS];
+    vec_t bk[NUM_UNITS];
+    vec_t h[2 * NUM_UNITS];
+    vec_t mask_h;               // blocks of the last unit below x^r
+    vec_t mask_c;               // blocks of the last unit in a polynomial
+} lanes_ws_t;
+
+static void lanes_ws_init(OUT lanes_ws_t *ws) {
+    uint64_t m[2 * GF2X_LANES];
+
+    for (int l = 0; l < GF2X_LANES; l++) {
+        for (int b = 0; b < 2; b++) {
+            int j = 2 * (NUM_UNITS - 1) + b;
+            m[2 * l + b] = (j < LAST_BLOCK_IDX) ? ~0ULL :
+                           (j == LAST_BLOCK_IDX) ? (1ULL << LAST_BLOCK_BITSIZE) - 1 : 0;
+        }
+    }
+    ws->mask_h = VEC_LOAD(m);
+
+    for (int l = 0; l < GF2X_LANES; l++) {
+        for (int b = 0; b < 2; b++) {
+            m[2 * l + b] = (2 * (NUM_UNITS - 1) + b < NUM_BLOCKS) ? ~0ULL : 0;
+        }
+    }
+    ws->mask_c = VEC_LOAD(m);
+}
+
+// c <- h mod (x^r - 1) lane-wise, where h is of 2 * NUM_UNITS units
+static void lanes_red(
+    IN  lanes_ws_t *ws,
+    OUT vec_t *c
+) {
+    const vec_t *h = ws->h;
+
+    // Blocks LAST_BLOCK_IDX + j, shifted down by LAST_BLOCK_BITSIZE bits,
+    // are added to the block j, i.e. units are shifted by half of a unit
+    // for an odd LAST_BLOCK_IDX
+    for (int u = 0; u < NUM_UNITS; u++) {
+        vec_t cur, next;
+        #if (LAST_BLOCK_IDX % 2) == 0
+        int U = u + LAST_BLOCK_IDX / 2;
+        cur  = h[U];
+        next = VEC_ALIGNR(h[U + 1], h[U]);
+        #else
+        int U = u + (LAST_BLOCK_IDX - 1) / 2;
+        cur  = VEC_ALIGNR(h[U + 1], h[U]);
+        next = h[U + 1];
+        #endif
+
+        vec_t hi = VEC_OR(VEC_SRLI(cur, LAST_BLOCK_BITSIZE), VEC_SLLI(next, 64 - LAST_BLOCK_BITSIZE));
+
+        if (u < NUM_UNITS - 1) {
+            c[u] = VEC_XOR(h[u], hi);
+        } else {
+            c[u] = VEC_AND(VEC_XOR(VEC_AND(h[u], ws->mask_h), hi), ws->mask_c);
+        }
+    }
+}
+
+// c <- a^(2^k) mod (x^r - 1) lane-wise (c may be a)
+static void lanes_sqr_k(
+    INPLACE lanes_ws_t *ws,
+    IN  vec_t *a,
+    IN  int k,
+    OUT vec_t *c
+) {
+    for (int j = 0; j < k; j++) {
+        const vec_t *src = (j == 0) ? a : c;
+
+        for (int u = 0; u < NUM_UNITS; u++) {
+            ws->h[2 * u]     = VEC_CLMUL(src[u], src[u], 0x00);
+            ws->h[2 * u + 1] = VEC_CLMUL(src[u], src[u], 0x11);
+        }
+        lanes_red(ws, c);
+    }
+}
+
+// c <- (a * b) mod (x^r - 1) lane-wise (c may be a or b)
+static void lanes_mul(
+    INPLACE lanes_ws_t *ws,
+    IN  vec_t *a,
+    IN  vec_t *b,
+    OUT vec_t *c
+) {
+    const int m = NUM_UNITS;
+
+    // The low block of ak[u] is the sum of the blocks of a[u]
+    for (int u = 0; u < m; u++) {
+        ws->ak[u] = VEC_XOR(a[u], VEC_BSRLI(a[u]));
+        ws->bk[u] = VEC_XOR(b[u], VEC_BSRLI(b[u]));
+    }
+
+    // Unit k of the product, i.e. the sums of the low (L), high (H) and 
+    // middle (M) blocks of a[t] * b[k - t], and the carry of the unit k - 1
+    vec_t carry = VEC_ZERO();
+    for (int k = 0; k < 2 * m - 1; k++) {
+        vec_t L = VEC_ZERO(), H = VEC_ZERO(), M = VEC_ZERO();
+
+        int t0 = (k < m) ? 0 : k - m + 1;
+        int t1 = (k < m) ? k : m - 1;
+        for (int t = t0; t <= t1; t++) {
+            L = VEC_XOR(L, VEC_CLMUL(a[t], b[k - t], 0x00));
+            H = VEC_XOR(H, VEC_CLMUL(a[t], b[k - t], 0x11));
+            M = VEC_XOR(M, VEC_CLMUL(ws->ak[t], ws->bk[k - t], 0x00));
+        }
+        M = VEC_XOR(M, VEC_XOR(L, H));
+
+        ws->h[k] = VEC_XOR(carry, VEC_XOR(L, VEC_BSLLI(M)));
+        carry = VEC_XOR(H, VEC_BSRLI(M));
+    }
+    ws->h[2 * m - 1] = carry;
+
+    lanes_red(ws, c);
+}
+
+// Interleave the units of the lanes, and back
+static void lanes_pack(IN poly_t **g, OUT vec_t *v) {
+    uint64_t *w = (uint64_t *)v;
+    for (int l = 0; l < GF2X_LANES; l++) {
+        for (int j = 0; j < 2 * NUM_UNITS; j++) {
+            w[2 * (GF2X_LANES * (j / 2) + l) + (j % 2)] = (j < NUM_BLOCKS) ? g[l]->data[j] : 0;
+        }
+    }
+}
+
+static void lanes_unpack(IN vec_t *v, OUT poly_t **g) {
+    const uint64_t *w = (const uint64_t *)v;
+    for (int l = 0; l < GF2X_LANES; l++) {
+        for (int j = 0; j < NUM_BLOCKS; j++) {
+            g[l]->data[j] = w[2 * (GF2X_LANES * (j / 2) + l) + (j % 2)];
+        }
+    }
+}
+
+// *out[l] <- the last value of the chain for v_0 = *g[l], lane-wise,
+// where R holds the registers of the chain (NUM_UNITS vectors each)
+static void lanes_chain_exec(
+    IN  chain_t *chain,
+    IN  poly_t **g,
+    OUT poly_t **out,
+    vec_t *R,
+    lanes_ws_t *ws
+) {
+    lanes_pack(g, &R[CHAIN_REG_IN * NUM_UNITS]);
+
+    for (int i = 0; i < chain->num_ops; i++) {
+        chain_op_t *op = &chain->op[i];
+        vec_t *dst = &R[op->rdst * NUM_UNITS];
+        vec_t *src = &R[op->rsrc * NUM_UNITS];
+
+        if (op->k > 0) {
+            lanes_sqr_k(ws, src, op->k, dst);
+        } else if (op->mul >= 0) {
+            lanes_mul(ws, src, &R[op->rmul * NUM_UNITS], dst);
+            continue;
+        } else if (dst != src) {
+            memcpy(dst, src, NUM_UNITS * sizeof(vec_t));
+        }
+
+        if (op->mul >= 0) {
+            lanes_mul(ws, dst, &R[op->rmul * NUM_UNITS], dst);
+        }
+    }
+
+    lanes_unpack(&R[CHAIN_REG_OUT * NUM_UNITS], out);
+}
+
+#endif /* x86 */
+
+// Chain method with the fewest multiplications, as the squarings
+// of the chains are the same (p - 2)
+static int lanes_method(IN ctx_t *ctx) {
+    cost_model_t muls = { .sqr = 0, .mul = 1 };
+    chain_t chain;
+    int best = FLT;
+    double best_cost = 0;
+
+    for (int m = FLT; m <= SAC; m++) {
+        gf2x_chain_method(ctx, m, &chain);
+        double c = gf2x_chain_cost(&chain, &muls);
+        if (m == FLT || c < best_cost) {
+            best = m;
+            best_cost = c;
+        }
+    }
+    return best;
+}
+
+// ginv[i] <- g[i]^-1 for 0 <= i < n by a chain method (or the one with
+// the fewest multiplications for 0), GF2X_LANES inputs at a time, 
+// or by BYI in the lanes of its divsteps
+void gf2x_mod_inv_lanes(
+    IN  ctx_t *ctx,
+    IN  int method,
+    IN  int n,
+    IN  poly_t *g,
+    OUT poly_t *ginv
+) {
+    if (method == BYI) {
+        gf2x_mod_inv_byi_lanes(ctx, n, g, ginv);
+        return;
+    }
+    if (method == 0) {
+        method = lanes_method(ctx);
+    }
+    assert(method >= FLT && method <= SAC);
+
+    chain_t chain;
+    gf2x_chain_method(ctx, method, &chain);
+
+#if defined(__x86_64__) || defined(_M_X64)
+    size_t size = chain.num_regs * NUM_UNITS * sizeof(vec_t) + sizeof(lanes_ws_t);
+    vec_t *R = aligned_alloc(sizeof(vec_t), CEIL_N(size, sizeof(vec_t)));
+    lanes_ws_t *ws = (lanes_ws_t *)&R[chain.num_regs * NUM_UNITS];
+    lanes_ws_init(ws);
+
+    // The last group is filled up by its first input, into a spare output
+    poly_t spare;
+    gf2x_poly_init(&spare, EXT_DEG - 1);
+    poly_t *in[GF2X_LANES], *out[GF2X_LANES];
+
+    for (int i = 0; i < n; i += GF2X_LANES) {
+        int num = (n - i < GF2X_LANES) ? n - i : GF2X_LANES;
+        for (int l = 0; l < GF2X_LANES; l++) {
+            in[l]  = &g[i + ((l < num) ? l : 0)];
+            out[l] = (l < num) ? &ginv[i + l] : &spare;
+        }
+        lanes_chain_exec(&chain, in, out, R, ws);
+    }
+
+    gf2x_poly_free(&spare);
+    free(R);
+#else
+    // A single lane, by the polynomial arithmetic
+    for (int i = 0; i < n; i++) {
+        gf2x_chain_run(&chain, &g[i], &ginv[i]);
+    }
+#endif
+}
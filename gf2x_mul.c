@@ -25,6 +25,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "gf2x.h"
 
@@ -69,6 +70,28 @@
 #endif
 
 
+// Multiplication of na-block a and nb-block b
+// c <- c + a * b (na + nb blocks)
+void gf2x_mul_words(
+    IN  uint64_t *a,
+    IN  int na,
+    IN  uint64_t *b,
+    IN  int nb,
+    INPLACE uint64_t *c
+) {
+    uint64_t out[2] = {0};
+
+    for (int i = 0; i < na; i++) {
+        for (int j = 0; j < nb; j++) {
+            PRINT_FUNCTION_NAME("mul64");
+            mul64(&a[i], &b[j], out);
+            c[i + j    ] ^= out[0];
+            c[i + j + 1] ^= out[1];
+        }
+    }
+}
+
+
 // Polynomial multiplication
 // c <- a * b
 void gf2x_poly_mul(
@@ -79,18 +102,297 @@ void gf2x_poly_mul(
     // Required for countint functial call
     PRINT_FUNCTION_NAME("gf2x_poly_mul");
     
-    uint64_t out[2] = {0};
+    gf2x_mul_words(a->data, a->size64, b->data, b->size64, c->data);
+}
+
+
+/*********************************************************
+ * Karatsuba transform of n-block polynomials
+ * 
+ * The image of a = a0 + a1 * x^(64h), h = ceil(n/2), is
+ * [ image(a0) | image(a0 + a1) | image(a1) ], down to
+ * n <= kt blocks (the Karatsuba threshold, e.g. of gf2x_tune),
+ * whose image is a itself.
+ * Then a * b = interp( image(a) (.) image(b) ), and the
+ * images of several products can be summed up before a
+ * single interpolation, e.g. in 2x2 matrix products.
+**********************************************************/
+
+// Image sizes of n-block and (n-1)-block polynomials, where the
+// image of a single block is of base blocks (1 for a polynomial,
+// 2 for a product). Both halves of n and n-1 blocks are of
+// ceil(n/2) or ceil(n/2)-1 blocks, so that it takes O(log n).
+static void gf2x_kara_sizes(
+    IN  int n,
+    IN  int kt,
+    IN  int base,
+    OUT int *tn,
+    OUT int *tn1
+) {
+    if (n <= kt) {
+        *tn  = base * n;
+        *tn1 = base * (n - 1);
+        return;
+    }
+
+    int tm, tm1;
+    gf2x_kara_sizes((n + 1) / 2, kt, base, &tm, &tm1);
+
+    if (n % 2 == 0) {
+        *tn  = 3 * tm;
+        *tn1 = 2 * tm + tm1;
+    } else {
+        *tn  = 2 * tm + tm1;
+        *tn1 = 3 * tm1;
+    }
+    if (n - 1 <= kt) {
+        *tn1 = base * (n - 1);
+    }
+}
+
+// Number of blocks in the image of an n-block polynomial
+int gf2x_kara_size(IN int n, IN int kt) {
+    int tn, tn1;
+    gf2x_kara_sizes(n, kt, 1, &tn, &tn1);
+    return tn;
+}
+
+// Number of blocks in the image of the product of two n-block polynomials
+int gf2x_kara_prod_size(IN int n, IN int kt) {
+    int tn, tn1;
+    gf2x_kara_sizes(n, kt, 2, &tn, &tn1);
+    return tn;
+}
+
+// In-place image of the n-block polynomial in the first n blocks of a
+static void gf2x_kara_eval_inplace(
+    INPLACE uint64_t *a,
+    IN int n,
+    IN int kt
+) {
+    if (n <= kt) {
+        return;
+    }
+
+    int h  = (n + 1) / 2;
+    int th = gf2x_kara_size(h, kt);
+
+    // [a0 | a1] -> [a0 | a0 + a1 | a1]
+    memmove(&a[2 * th], &a[h], (n - h) * sizeof(uint64_t));
+    for (int i = 0; i < n - h; i++) {
+        a[th + i] = a[i] ^ a[2 * th + i];
+    }
+    for (int i = n - h; i < h; i++) {
+        a[th + i] = a[i];
+    }
+
+    gf2x_kara_eval_inplace(&a[0],      h,     kt);
+    gf2x_kara_eval_inplace(&a[th],     h,     kt);
+    gf2x_kara_eval_inplace(&a[2 * th], n - h, kt);
+}
+
+// ea <- image of a (alen <= n blocks, zero padded to n blocks)
+void gf2x_kara_eval(
+    IN  uint64_t *a,
+    IN  int alen,
+    IN  int n,
+    IN  int kt,
+    OUT uint64_t *ea
+) {
+    assert(alen <= n);
+
+    memcpy(ea, a, alen * sizeof(uint64_t));
+    memset(&ea[alen], 0, (n - alen) * sizeof(uint64_t));
+    gf2x_kara_eval_inplace(ea, n, kt);
+}
+
+// ec <- ec + ea (.) eb
+void gf2x_kara_mul_acc(
+    IN  uint64_t *ea,
+    IN  uint64_t *eb,
+    IN  int n,
+    IN  int kt,
+    INPLACE uint64_t *ec
+) {
+    if (n <= kt) {
+        gf2x_mul_words(ea, n, eb, n, ec);
+        return;
+    }
+
+    int h  = (n + 1) / 2;
+    int th = gf2x_kara_size(h, kt);
+    int qh = gf2x_kara_prod_size(h, kt);
+
+    // The three sub-products are independent (i.e. tasks for large n)
+    #pragma omp task if(n >= GF2X_TASK_BLOCKS)
+    gf2x_kara_mul_acc(&ea[0],      &eb[0],      h,     kt, &ec[0]);
+    #pragma omp task if(n >= GF2X_TASK_BLOCKS)
+    gf2x_kara_mul_acc(&ea[th],     &eb[th],     h,     kt, &ec[qh]);
+    gf2x_kara_mul_acc(&ea[2 * th], &eb[2 * th], n - h, kt, &ec[2 * qh]);
+    #pragma omp taskwait
+}
+
+// In-place interpolation of the image ec of a product of
+// n-block polynomials, i.e. the product is in ec[0, 2n)
+void gf2x_kara_interp(
+    INPLACE uint64_t *ec,
+    IN int n,
+    IN int kt
+) {
+    if (n <= kt) {
+        return;
+    }
+
+    int h  = (n + 1) / 2;
+    int qh = gf2x_kara_prod_size(h, kt);
+
+    uint64_t *c0 = &ec[0];
+    uint64_t *c1 = &ec[qh];
+    uint64_t *c2 = &ec[2 * qh];
+
+    gf2x_kara_interp(c0, h,     kt);
+    gf2x_kara_interp(c1, h,     kt);
+    gf2x_kara_interp(c2, n - h, kt);
+
+    // c1 <- c1 + c0 + c2
+    for (int i = 0; i < 2 * h; i++) {
+        c1[i] ^= c0[i];
+    }
+    for (int i = 0; i < 2 * (n - h); i++) {
+        c1[i] ^= c2[i];
+    }
+
+    // ec <- c0 + c1 * x^(64h) + c2 * x^(128h)
+    // c1 and c2 are above the written blocks, so that it can be done in-place
+    for (int i = 0; i < 2 * n; i++) {
+        uint64_t v = (i < 2 * h) ? c0[i] : c2[i - 2 * h];
+        if (i >= h && i < 3 * h) {
+            v ^= c1[i - h];
+        }
+        ec[i] = v;
+    }
+}
+
+
+/*********************************************************
+ * Middle product of n-block a and (2n-1)-block b
+ *     m_k = sum_i a_i * b_(k+n-1-i),  0 <= k < n
+ * where a_i * b_j are 2-block products (i.e. m_k is kept
+ * in m[2k], m[2k+1]), so that m_k = (a * b)_(k+n-1) before
+ * the carries of the blocks. 
+ * It is computed by the transposed Karatsuba, at the cost 
+ * of a single n-block product.
+**********************************************************/
 
-    for (int i = 0; i < a->size64; i++) {
-        for (int j = 0; j < b->size64; j++) {
+static void gf2x_mul_middle_rec(
+    IN  uint64_t *a,
+    IN  uint64_t *b,
+    IN  int n,
+    IN  int kt,
+    INPLACE uint64_t *m,
+    uint64_t *scratch
+) {
+    uint64_t out[2];
+
+    if (n <= kt) {
+        for (int k = 0; k < n; k++) {
+            for (int i = 0; i < n; i++) {
+                PRINT_FUNCTION_NAME("mul64");
+                mul64(&a[i], &b[k + n - 1 - i], out);
+                m[2 * k    ] ^= out[0];
+                m[2 * k + 1] ^= out[1];
+            }
+        }
+        return;
+    }
+
+    // Odd n: the middle product of (n-1) blocks on a_1, ..., a_(n-1),
+    // together with the column of a_0 and the last row
+    if (n & 1) {
+        gf2x_mul_middle_rec(&a[1], b, n - 1, kt, m, scratch);
+        for (int k = 0; k < n; k++) {
+            PRINT_FUNCTION_NAME("mul64");
+            mul64(&a[0], &b[k + n - 1], out);
+            m[2 * k    ] ^= out[0];
+            m[2 * k + 1] ^= out[1];
+        }
+        for (int i = 1; i < n; i++) {
             PRINT_FUNCTION_NAME("mul64");
-            mul64(&a->data[i], &b->data[j], out);
-            c->data[i + j    ] ^= out[0];
-            c->data[i + j + 1] ^= out[1];
+            mul64(&a[i], &b[2 * n - 2 - i], out);
+            m[2 * (n - 1)    ] ^= out[0];
+            m[2 * (n - 1) + 1] ^= out[1];
         }
+        return;
+    }
+
+    // a = a0 + a1 * X^h, and b0, b1, b2 are the (2h-1)-block 
+    // windows of b at 0, h, 2h, so that
+    //  low  = MP(a1, b0) + MP(a0, b1) = MP(a1, b0 + b1) + beta
+    //  high = MP(a1, b1) + MP(a0, b2) = MP(a0, b1 + b2) + beta
+    // for beta = MP(a0 + a1, b1)
+    int h = n / 2;
+    uint64_t *sa   = scratch;
+    uint64_t *sb   = sa + h;
+    uint64_t *beta = sb + (2 * h - 1);
+    uint64_t *next = beta + 2 * h;
+
+    for (int i = 0; i < h; i++) {
+        sa[i] = a[i] ^ a[h + i];
+    }
+    memset(beta, 0, 2 * h * sizeof(uint64_t));
+    gf2x_mul_middle_rec(sa, &b[h], h, kt, beta, next);
+
+    for (int i = 0; i < 2 * h - 1; i++) {
+        sb[i] = b[i] ^ b[h + i];
+    }
+    gf2x_mul_middle_rec(&a[h], sb, h, kt, &m[0], next);
+
+    for (int i = 0; i < 2 * h - 1; i++) {
+        sb[i] = b[h + i] ^ b[2 * h + i];
+    }
+    gf2x_mul_middle_rec(&a[0], sb, h, kt, &m[2 * h], next);
+
+    for (int i = 0; i < 2 * h; i++) {
+        m[i]         ^= beta[i];
+        m[2 * h + i] ^= beta[i];
+    }
+}
+
+// Coefficient of X^(n-1) in the product of n-block a and b
+// m <- m + sum_i a_i * b_(n-1-i) in m[0], m[1]
+void gf2x_mul_dot(
+    IN  uint64_t *a,
+    IN  uint64_t *b,
+    IN  int n,
+    INPLACE uint64_t *m
+) {
+    uint64_t out[2];
+
+    for (int i = 0; i < n; i++) {
+        PRINT_FUNCTION_NAME("mul64");
+        mul64(&a[i], &b[n - 1 - i], out);
+        m[0] ^= out[0];
+        m[1] ^= out[1];
     }
 }
 
+// Number of blocks of scratch for MP(a, b) of n blocks,
+// i.e. at most 5h blocks for each level of n = 2h
+int gf2x_mul_middle_scratch(IN int n) {
+    return 5 * n + 1;
+}
+
+// m <- m + MP(a, b)
+void gf2x_mul_middle(
+    IN  uint64_t *a,
+    IN  uint64_t *b,
+    IN  int n,
+    IN  int kt,
+    INPLACE uint64_t *m,
+    uint64_t *scratch
+) {
+    gf2x_mul_middle_rec(a, b, n, kt, m, scratch);
+}
 
 // Modular multiplication of polynomials
 // c <- (a * b) mod (x^EXT_DEG - 1)
@@ -132,3 +434,75 @@ void gf2x_mod_mul(
 
     gf2x_poly_free(&tmp);
 }
+
+// Blocks of the scratch of gf2x_mod_mul_kara_tune, gf2x_mod_sqr_tune and 
+// gf2x_mod_sqr_k_inplace_tune for n-block polynomials, i.e. the images of
+// the Karatsuba transform (at least the 2n blocks of a square)
+int gf2x_mod_scratch(IN gf2x_tune_t *tune, IN int n) {
+    int kt = tune->kara_threshold;
+    return 2 * gf2x_kara_size(n, kt) + gf2x_kara_prod_size(n, kt);
+}
+
+// Modular multiplication of polynomials by the Karatsuba transform
+// down to the threshold of tune, in the scratch ws (or an allocated one)
+// c <- (a * b) mod (x^EXT_DEG - 1)
+void gf2x_mod_mul_kara_tune(
+    IN  gf2x_tune_t *tune,
+    IN  poly_t *a,
+    IN  poly_t *b,
+    OUT poly_t *c,
+    uint64_t *ws
+) {
+    // Required for countint functial call
+    PRINT_FUNCTION_NAME("gf2x_mod_mul_kara");
+
+    assert(a->size64 == b->size64);
+
+    int n  = a->size64;
+    int kt = tune->kara_threshold;
+    int tn = gf2x_kara_size(n, kt);
+    int qn = gf2x_kara_prod_size(n, kt);
+
+    // Images of a and b, and of the product
+    uint64_t *buf = (ws != NULL) ? ws : malloc((2 * tn + qn) * sizeof(uint64_t));
+    uint64_t *ea = &buf[0];
+    uint64_t *eb = &buf[tn];
+    uint64_t *ec = &buf[2 * tn];
+
+    gf2x_kara_eval(a->data, n, n, kt, ea);
+    gf2x_kara_eval(b->data, n, n, kt, eb);
+    memset(ec, 0, qn * sizeof(uint64_t));
+    gf2x_kara_mul_acc(ea, eb, n, kt, ec);
+    gf2x_kara_interp(ec, n, kt);
+
+    // Reduction of the product in ec[0, 2n)
+    #if defined(USE_STATIC_POLY)
+    poly_t tmp = {
+        .deg = 2 * (EXT_DEG-1), 
+        .size64 = 2 * n
+        };
+    memcpy(tmp.data, ec, 2 * n * sizeof(uint64_t));
+    #else
+    poly_t tmp = {
+        .deg = 2 * (EXT_DEG-1), 
+        .size64 = 2 * n,
+        .data = ec
+        };
+    #endif
+
+    gf2x_red(&tmp, c);
+
+    if (ws == NULL) {
+        free(buf);
+    }
+}
+
+// Modular multiplication of polynomials by the Karatsuba transform
+// c <- (a * b) mod (x^EXT_DEG - 1)
+void gf2x_mod_mul_kara(
+    IN  poly_t *a,
+    IN  poly_t *b,
+    OUT poly_t *c
+) {
+    gf2x_mod_mul_kara_tune(&gf2x_tune, a, b, c, NULL);
+}
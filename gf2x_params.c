@@ -0,0 +1,384 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Emrah Karagoz, Pakize Sanal, Abhraneel Dutta, Edoardo Persichetti
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "gf2x.h"
+
+/*********************************************************
+ * Parameter search of CEA, TYT and SAC for any prime p
+ *
+ * The candidates are
+ *   CEA: p - 2 = a * b for all divisors a of p - 2,
+ *   TYT: p - 2 = r_0 * ... * r_(k-1) + h for all h >= 1 and all 
+ *        ordered factorizations of at most GF2X_PARAMS_TYT_MAX_K factors,
+ *   SAC: p - 2 = r * 2^t + h for all 1 <= h <= r, and an addition 
+ *        sequence of (h, r),
+ * and each one is scored by the cost of its addition chain, i.e.
+ * the chain built by gf2x_chain_cea/tyt/sac.
+**********************************************************/
+
+// Cycles of gf2x_mod_sqr and gf2x_mod_mul (medians) on the host
+void gf2x_cost_calibrate(OUT cost_model_t *cost) {
+    int p = EXT_DEG;
+
+    poly_t a, b, c;
+    gf2x_poly_init(&a, p-1);
+    gf2x_poly_init(&b, p-1);
+    gf2x_poly_init(&c, p-1);
+    gf2x_poly_random(&a);
+    gf2x_poly_random(&b);
+
+    bench_t bench;
+    bench_init(&bench, GF2X_PARAMS_CALIB_RUNS, NULL);
+
+    BENCHFUNC(bench, gf2x_mod_sqr(&a, &c));
+    cost->sqr = (double) bench.stats.med;
+
+    BENCHFUNC(bench, gf2x_mod_mul(&a, &b, &c));
+    cost->mul = (double) bench.stats.med;
+
+    bench_free(&bench);
+    gf2x_poly_free(&a);
+    gf2x_poly_free(&b);
+    gf2x_poly_free(&c);
+}
+
+// Check that the chain computes g^(2^(p-1) - 2), i.e. g^-1
+static int chain_is_inverse(IN chain_t *chain, IN int p) {
+    int nwords = p / 64 + 1;
+    uint64_t e[nwords];
+    uint64_t w[nwords];
+
+    gf2x_chain_exponent(chain, e, nwords);
+
+    // w <- 2^(p-1) - 2
+    memset(w, 0, sizeof(w));
+    for (int i = 1; i < p - 1; i++) {
+        w[i / 64] |= 1ULL << (i % 64);
+    }
+
+    return memcmp(e, w, sizeof(w)) == 0;
+}
+
+// Divisors of m in increasing order
+static int divisors(IN int m, OUT int *d, IN int max_d) {
+    int n = 0, lo = 0;
+    int hi[max_d];
+    int nhi = 0;
+
+    for (int i = 1; i * i <= m; i++) {
+        if (m % i == 0) {
+            assert(n + nhi + 2 <= max_d);
+            d[n++] = i;
+            if (i * i != m) {
+                hi[nhi++] = m / i;
+            }
+        }
+    }
+    for (lo = nhi - 1; lo >= 0; lo--) {
+        d[n++] = hi[lo];
+    }
+    return n;
+}
+
+/******************************
+ * CEA
+ ******************************/
+double gf2x_params_cea(
+    INPLACE ctx_t *ctx,
+    IN      cost_model_t *cost
+) {
+    int m = ctx->p - 2;
+    int d[GF2X_PARAMS_MAX_DIV];
+    int nd = divisors(m, d, GF2X_PARAMS_MAX_DIV);
+
+    chain_t chain;
+    double best = -1;
+    int best_a = 0;
+
+    for (int i = 0; i < nd; i++) {
+        ctx->cea_a = d[i];
+        ctx->cea_b = m / d[i];
+
+        gf2x_chain_cea(ctx, &chain);
+        double c = gf2x_chain_cost(&chain, cost);
+        if (best < 0 || c < best) {
+            best = c;
+            best_a = d[i];
+        }
+    }
+
+    ctx->cea_a = best_a;
+    ctx->cea_b = m / best_a;
+
+    gf2x_chain_cea(ctx, &chain);
+    assert(chain_is_inverse(&chain, ctx->p));
+    return best;
+}
+
+/******************************
+ * TYT
+ ******************************/
+typedef struct {
+    double cost;
+    int h;
+    int k;
+    int r[POLY_INV_TYT_MAX_K];
+} tyt_best_t;
+
+// All ordered factorizations r[j] * r[j+1] * ... of rem (with r[j] >= 2)
+static void tyt_factors(
+    INPLACE ctx_t *ctx,
+    IN      cost_model_t *cost,
+    IN      int *d,
+    IN      int nd,
+    IN      int rem,
+    IN      int j,
+    INPLACE tyt_best_t *best
+) {
+    chain_t chain;
+
+    for (int i = 0; i < nd && d[i] <= rem; i++) {
+        if (d[i] < 2 || rem % d[i]) {
+            continue;
+        }
+        ctx->tyt_r[j] = d[i];
+
+        if (d[i] == rem) {
+            // The bits of h are taken from the first list F, of bitlength(r_0)
+            if (bitlength(ctx->tyt_h) > bitlength(ctx->tyt_r[0])) {
+                continue;
+            }
+            ctx->tyt_k = j + 1;
+            gf2x_chain_tyt(ctx, &chain);
+            double c = gf2x_chain_cost(&chain, cost);
+            if (best->cost < 0 || c < best->cost) {
+                best->cost = c;
+                best->h = ctx->tyt_h;
+                best->k = ctx->tyt_k;
+                memcpy(best->r, ctx->tyt_r, sizeof(best->r));
+            }
+        } else if (j + 1 < GF2X_PARAMS_TYT_MAX_K) {
+            tyt_factors(ctx, cost, d, nd, rem / d[i], j + 1, best);
+        }
+    }
+}
+
+double gf2x_params_tyt(
+    INPLACE ctx_t *ctx,
+    IN      cost_model_t *cost
+) {
+    int m = ctx->p - 2;
+    int d[GF2X_PARAMS_MAX_DIV];
+
+    tyt_best_t best;
+    best.cost = -1;
+
+    for (int h = 1; h < m - 1; h++) {
+        int nd = divisors(m - h, d, GF2X_PARAMS_MAX_DIV);
+        ctx->tyt_h = h;
+        memset(ctx->tyt_r, 0, sizeof(ctx->tyt_r));
+        tyt_factors(ctx, cost, d, nd, m - h, 0, &best);
+    }
+    assert(best.cost >= 0);
+
+    ctx->tyt_h = best.h;
+    ctx->tyt_k = best.k;
+    memcpy(ctx->tyt_r, best.r, sizeof(best.r));
+
+    chain_t chain;
+    gf2x_chain_tyt(ctx, &chain);
+    assert(chain_is_inverse(&chain, ctx->p));
+    return best.cost;
+}
+
+/******************************
+ * SAC
+ ******************************/
+
+/*
+    Addition sequence C of (h, r), i.e. an addition chain with h in C,
+    and its pairs A with C[i] = C[A[2i-2]] + C[A[2i-1]], where C[A[2i-1]]
+    is the smaller one (the number of squarings of the i-th step).
+
+    It is built from r down (Bos-Coster): the largest element x, which
+    is not a sum of two elements yet, is x = y + (x-y) for the element y
+    below x if y >= x/2, and otherwise x = x/2 + x/2 or x = (x-1) + 1.
+
+    Returns lenC, or 0 if C does not fit into POLY_INV_SAC_MAX_C.
+*/
+static int sac_sequence(IN int h, IN int r, OUT int *C, OUT int *A, OUT int *h_idx) {
+    int len = 0;
+    int S[POLY_INV_SAC_MAX_C + 2];
+    int P[POLY_INV_SAC_MAX_C + 2];     // the smaller summand of S[i]
+
+    // S <- {1, h, r} in increasing order
+    S[len++] = 1;
+    if (h > 1) S[len++] = h;
+    if (r > h) S[len++] = r;
+    for (int i = 0; i < len; i++) {
+        P[i] = 0;
+    }
+
+    while (1) {
+        // The largest element, which is not a sum yet
+        int i = len - 1;
+        while (i > 0 && P[i] != 0) i--;
+        if (i == 0) {
+            break;
+        }
+        int x = S[i];
+        int y = 0;
+
+        // x = y + (x-y) of two elements, for the smallest y
+        for (int j = 0; j < i && y == 0; j++) {
+            for (int l = j; l < i; l++) {
+                if (S[j] + S[l] == x) {
+                    y = S[j];
+                    break;
+                }
+            }
+        }
+
+        // Otherwise, a new element z below x
+        int z = 0;
+        if (y == 0) {
+            if (2 * S[i-1] >= x) {
+                z = x - S[i-1];
+                y = (z < S[i-1]) ? z : S[i-1];
+            } else if (x % 2 == 0) {
+                z = y = x / 2;
+            } else {
+                z = x - 1;
+                y = 1;
+            }
+        }
+        P[i] = y;
+
+        if (z > 0) {
+            if (len == POLY_INV_SAC_MAX_C) {
+                return 0;
+            }
+            int j = len;
+            while (S[j-1] > z) {
+                S[j] = S[j-1];
+                P[j] = P[j-1];
+                j--;
+            }
+            S[j] = z;
+            P[j] = 0;
+            len += 1;
+        }
+    }
+
+    // C and A (the index of the summands)
+    for (int i = 0; i < len; i++) {
+        C[i] = S[i];
+        if (S[i] == h) {
+            *h_idx = i;
+        }
+    }
+    for (int i = 1; i < len; i++) {
+        int i1 = -1, i2 = -1;
+        for (int j = 0; j < i; j++) {
+            if (S[j] == P[i]) i2 = j;
+            if (S[j] == S[i] - P[i]) i1 = j;
+        }
+        assert(i1 >= 0 && i2 >= 0);
+        A[2*i-2] = i1;
+        A[2*i-1] = i2;
+    }
+    return len;
+}
+
+double gf2x_params_sac(
+    INPLACE ctx_t *ctx,
+    IN      cost_model_t *cost
+) {
+    int m = ctx->p - 2;
+
+    chain_t chain;
+    double best = -1;
+    int best_r = 0, best_n = 0, best_h = 0;
+
+    for (int t = 0; (1 << t) < m; t++) {
+        int n = 1 << t;
+
+        for (int h = (m % n) ? (m % n) : n; h < m; h += n) {
+            int r = (m - h) / n;
+            if (h > r) {
+                break;
+            }
+
+            ctx->sac_lenC = sac_sequence(h, r, ctx->sac_C, ctx->sac_A, &ctx->sac_h_idx);
+            if (ctx->sac_lenC == 0) {
+                continue;
+            }
+            ctx->sac_r = r;
+            ctx->sac_n = n;
+            ctx->sac_h = h;
+
+            gf2x_chain_sac(ctx, &chain);
+            double c = gf2x_chain_cost(&chain, cost);
+            if (best < 0 || c < best) {
+                best = c;
+                best_r = r;
+                best_n = n;
+                best_h = h;
+            }
+        }
+    }
+    assert(best >= 0);
+
+    ctx->sac_r = best_r;
+    ctx->sac_n = best_n;
+    ctx->sac_h = best_h;
+    ctx->sac_lenC = sac_sequence(best_h, best_r, ctx->sac_C, ctx->sac_A, &ctx->sac_h_idx);
+
+    gf2x_chain_sac(ctx, &chain);
+    assert(chain_is_inverse(&chain, ctx->p));
+    return best;
+}
+
+// The cheapest parameters of CEA, TYT and SAC for ctx->p,
+// under the cost model of the host for cost = NULL
+void gf2x_params_search(
+    INPLACE ctx_t *ctx,
+    IN      cost_model_t *cost
+) {
+    cost_model_t host;
+    if (cost == NULL) {
+        gf2x_cost_calibrate(&host);
+        cost = &host;
+    }
+
+    gf2x_params_cea(ctx, cost);
+    gf2x_params_tyt(ctx, cost);
+    gf2x_params_sac(ctx, cost);
+}
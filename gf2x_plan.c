@@ -0,0 +1,493 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Emrah Karagoz, Pakize Sanal, Abhraneel Dutta, Edoardo Persichetti
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "gf2x.h"
+
+/*********************************************************
+ * Plans and wisdom
+ *
+ * The tunables of the kernels (gf2x_tune) are measured for the
+ * ring size and the host by gf2x_plan_create(ctx, GF2X_PLAN_MEASURE),
+ * one after the other, in the order of their dependencies, on the
+ * tunables and the schedules of the plan only (i.e. neither gf2x_tune
+ * nor ctx is changed, but by gf2x_plan_apply):
+ *
+ *   kara_threshold   gf2x_mod_mul_kara, for each candidate threshold
+ *   sqr_kernel       gf2x_mod_sqr, for each kernel of the host
+ *   frob_min_k       the cost of gf2x_mod_frob in squarings
+ *   byi_base_blocks  BYI, for each base case width and split
+ *   byi_split
+ *   inv_method       BYI, and the chains of FLT, CEA, TYT and SAC
+ *
+ * The winners are kept in the wisdom, i.e. the entries "p cpu tunables",
+ * which is exported to and imported from a text file, so that a later
+ * process plans p without measuring anything. If $POLYINV_WISDOM is set,
+ * it is imported by the first plan, and exported after each measurement.
+**********************************************************/
+
+#define TUNE_DEFAULT {                          \
+    .kara_threshold  = GF2X_KARA_THRESHOLD,     \
+    .sqr_kernel      = GF2X_SQR_KERNEL,         \
+    .frob_min_k      = GF2X_FROB_MIN_K,         \
+    .byi_base_blocks = BYI_BASE_BLOCKS,         \
+    .byi_split       = BYI_SPLIT,               \
+}
+
+gf2x_tune_t gf2x_tune = TUNE_DEFAULT;
+static const gf2x_tune_t tune_default = TUNE_DEFAULT;
+
+static const char *sqr_names[] = { "CLMUL", "PDEP" };
+
+#define NUM_SQR_KERNELS ((int) (sizeof(sqr_names) / sizeof(sqr_names[0])))
+
+// Candidates of the Karatsuba threshold, BYI base case and BYI split
+static const int kara_candidates[]  = { 2, 4, 6, 8, 12, 16, 24, 32 };
+static const int base_candidates[]  = { 1, 2, 4 };
+static const int split_candidates[] = { 8, 9, 10, 11, 12 };
+
+#define NUM_OF(a) ((int) (sizeof(a) / sizeof(a[0])))
+
+/************************************
+ * WISDOM
+ ************************************/
+
+typedef struct {
+    int         p;
+    char        cpu[49];
+    gf2x_tune_t tune;
+    int         inv_method;
+} wisdom_t;
+
+static wisdom_t wisdom[GF2X_WISDOM_MAX];
+static int num_wisdom = 0;
+static int wisdom_env_done = 0;
+
+// Entry of p and cpu, or NULL
+static wisdom_t *wisdom_find(IN int p, IN const char *cpu) {
+    for (int w = 0; w < num_wisdom; w++) {
+        if (wisdom[w].p == p && strcmp(wisdom[w].cpu, cpu) == 0) {
+            return &wisdom[w];
+        }
+    }
+    return NULL;
+}
+
+// Add (or replace) the entry of p and cpu, unless the wisdom is full
+static void wisdom_add(IN int p, IN const char *cpu, IN gf2x_tune_t *tune, IN int method) {
+    wisdom_t *w = wisdom_find(p, cpu);
+    if (w == NULL) {
+        if (num_wisdom == GF2X_WISDOM_MAX) {
+            return;
+        }
+        w = &wisdom[num_wisdom++];
+    }
+    w->p = p;
+    snprintf(w->cpu, sizeof(w->cpu), "%s", cpu);
+    w->tune = *tune;
+    w->inv_method = method;
+}
+
+// Index of name in names, or -1
+static int name_index(IN const char *name, IN const char **names, IN int n) {
+    for (int k = 0; k < n; k++) {
+        if (strcmp(name, names[k]) == 0) {
+            return k;
+        }
+    }
+    return -1;
+}
+
+// Inversion method of a name, or 0
+static int inv_method_of(IN const char *name) {
+    for (int m = BYI; m <= SAC; m++) {
+        if (strcmp(name, gf2x_inv_name(m)) == 0) {
+            return m;
+        }
+    }
+    return 0;
+}
+
+// Save the wisdom, i.e. a line "<p> <cpu> kara=... inv=<method>" for each entry
+int gf2x_wisdom_export(IN const char *path) {
+    FILE *f = fopen(path, "w");
+    if (f == NULL) {
+        return -1;
+    }
+
+    fprintf(f, "# polyinv wisdom\n");
+    for (int w = 0; w < num_wisdom; w++) {
+        gf2x_tune_t *t = &wisdom[w].tune;
+        fprintf(f, "%d %s kara=%d sqr=%s frob=%d byi_base=%d byi_split=%d inv=%s\n",
+                wisdom[w].p, wisdom[w].cpu, t->kara_threshold, sqr_names[t->sqr_kernel],
+                t->frob_min_k, t->byi_base_blocks, t->byi_split,
+                gf2x_inv_name(wisdom[w].inv_method));
+    }
+
+    fclose(f);
+    return num_wisdom;
+}
+
+// Load the wisdom, on top of the current one, skipping the invalid lines
+int gf2x_wisdom_import(IN const char *path) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        return -1;
+    }
+
+    int count = 0;
+    char line[256], cpu[64], sqr[16], inv[16];
+    while (fgets(line, sizeof(line), f) != NULL) {
+        int p;
+        gf2x_tune_t t;
+        if (line[0] == '#' ||
+            sscanf(line, "%d %63s kara=%d sqr=%15s frob=%d byi_base=%d byi_split=%d inv=%15s",
+                   &p, cpu, &t.kara_threshold, sqr, &t.frob_min_k,
+                   &t.byi_base_blocks, &t.byi_split, inv) != 8) {
+            continue;
+        }
+
+        t.sqr_kernel = name_index(sqr, sqr_names, NUM_SQR_KERNELS);
+        int method = inv_method_of(inv);
+
+        if (p < 3 || t.kara_threshold < 1 || t.sqr_kernel < 0 || t.frob_min_k < 1 ||
+            (t.byi_base_blocks != 1 && t.byi_base_blocks != 2 && t.byi_base_blocks != 4) ||
+            t.byi_split < 8 || t.byi_split > 15 || method == 0) {
+            continue;
+        }
+
+        wisdom_add(p, cpu, &t, method);
+        count++;
+    }
+
+    fclose(f);
+    return count;
+}
+
+// Remove all the entries of the wisdom
+void gf2x_wisdom_forget(void) {
+    num_wisdom = 0;
+}
+
+// $POLYINV_WISDOM (or NULL), imported on the first call
+static const char *wisdom_env(void) {
+    const char *path = getenv("POLYINV_WISDOM");
+    if (path != NULL && !wisdom_env_done) {
+        gf2x_wisdom_import(path);
+        wisdom_env_done = 1;
+    }
+    return path;
+}
+
+// Inversion method of the wisdom of p for the host, or 0
+int gf2x_wisdom_method(IN int p) {
+    char cpu[49];
+    gf2x_cpu_name(cpu);
+
+    wisdom_env();
+    wisdom_t *w = wisdom_find(p, cpu);
+    return (w != NULL) ? w->inv_method : 0;
+}
+
+/************************************
+ * MEASUREMENTS
+ ************************************/
+
+// Karatsuba threshold of the fastest gf2x_mod_mul_kara
+static void measure_kara(INPLACE gf2x_tune_t *t, IN poly_t *a, IN poly_t *b, OUT poly_t *c) {
+    bench_t bench;
+    bench_init(&bench, GF2X_PLAN_RUNS, NULL);
+
+    // (BENCHFUNC loops over i)
+    gf2x_tune_t k_tune = *t;
+    unsigned long long best = 0;
+    uint64_t *ws = NULL;
+    for (int k = 0; k < NUM_OF(kara_candidates); k++) {
+        // The larger thresholds are all schoolbook
+        if (k > 0 && kara_candidates[k - 1] >= a->size64) {
+            break;
+        }
+        k_tune.kara_threshold = kara_candidates[k];
+
+        // In a scratch, as in a plan
+        free(ws);
+        ws = malloc(gf2x_mod_scratch(&k_tune, a->size64) * sizeof(uint64_t));
+
+        gf2x_mod_mul_kara_tune(&k_tune, a, b, c, ws);
+        BENCHFUNC(bench, gf2x_mod_mul_kara_tune(&k_tune, a, b, c, ws));
+        if (k == 0 || bench.stats.med < best) {
+            best = bench.stats.med;
+            t->kara_threshold = kara_candidates[k];
+        }
+    }
+
+    free(ws);
+    bench_free(&bench);
+}
+
+// Squaring kernel of the fastest gf2x_mod_sqr, and the number of
+// squarings from which the Frobenius map is faster
+static void measure_sqr(INPLACE gf2x_tune_t *t, IN poly_t *a, OUT poly_t *c) {
+    bench_t bench;
+    bench_init(&bench, GF2X_PLAN_RUNS, NULL);
+
+    gf2x_tune_t k_tune = *t;
+    unsigned long long best = 0;
+    uint64_t *ws = malloc(gf2x_mod_scratch(t, a->size64) * sizeof(uint64_t));
+    for (int k = 0; k < NUM_SQR_KERNELS; k++) {
+        if (!gf2x_sqr_kernel_ok(k)) {
+            continue;
+        }
+        k_tune.sqr_kernel = k;
+
+        gf2x_mod_sqr_tune(&k_tune, a, c, ws);
+        BENCHFUNC(bench, gf2x_mod_sqr_tune(&k_tune, a, c, ws));
+        if (best == 0 || bench.stats.med < best) {
+            best = bench.stats.med;
+            t->sqr_kernel = k;
+        }
+    }
+
+    // Cost of 16 squarings, and of a permutation
+    BENCHFUNC(bench, gf2x_mod_sqr_k_inplace_tune(t, c, 16, ws));
+    double sqr = bench.stats.med / 16.0;
+    BENCHFUNC(bench, gf2x_mod_frob(a, 1000, c));
+    double frob = bench.stats.med;
+
+    t->frob_min_k = (int) (frob / sqr) + 1;
+
+    free(ws);
+    bench_free(&bench);
+}
+
+// BYI base case and split of the fastest BYI, and its median cycles
+static unsigned long long measure_byi(INPLACE gf2x_tune_t *t, IN ctx_t *ctx, IN poly_t *g, OUT poly_t *ginv) {
+    bench_t bench;
+    bench_init(&bench, GF2X_PLAN_RUNS, NULL);
+
+    byi_plan_t *byi = malloc(sizeof(byi_plan_t));
+    gf2x_tune_t k_tune = *t;
+    unsigned long long best = 0;
+    for (int b = 0; b < NUM_OF(base_candidates); b++) {
+        for (int s = 0; s < NUM_OF(split_candidates); s++) {
+            k_tune.byi_base_blocks = base_candidates[b];
+            k_tune.byi_split = split_candidates[s];
+            gf2x_byi_plan(byi, &k_tune, ctx->p, BYI_DIVSTEPS(ctx->p));
+            uint64_t *ws = malloc(byi->ws_size * sizeof(uint64_t));
+
+            gf2x_byi_run(byi, ctx->p, g, ginv, ws);
+            BENCHFUNC(bench, gf2x_byi_run(byi, ctx->p, g, ginv, ws));
+            if (best == 0 || bench.stats.med < best) {
+                best = bench.stats.med;
+                t->byi_base_blocks = base_candidates[b];
+                t->byi_split = split_candidates[s];
+            }
+            free(ws);
+        }
+    }
+
+    free(byi);
+    bench_free(&bench);
+    return best;
+}
+
+// Fastest of BYI (of byi cycles) and the chains by t
+static int measure_method(IN gf2x_tune_t *t, INPLACE ctx_t *ctx, IN unsigned long long byi, 
+                          IN poly_t *g, OUT poly_t *ginv) {
+    bench_t bench;
+    bench_init(&bench, GF2X_PLAN_RUNS, NULL);
+
+    int method = BYI;
+    unsigned long long best = byi;
+
+    chain_t chain;
+    uint64_t *ws = malloc(gf2x_mod_scratch(t, g->size64) * sizeof(uint64_t));
+    for (int m = FLT; m <= SAC; m++) {
+        gf2x_chain_method(ctx, m, &chain);
+        int num_tmp = chain.num_regs - 2;
+        poly_t *tmp = malloc((num_tmp > 0 ? num_tmp : 1) * sizeof(poly_t));
+        for (int k = 0; k < num_tmp; k++) {
+            gf2x_poly_init(&tmp[k], ctx->p - 1);
+        }
+
+        gf2x_chain_exec(&chain, t, g, ginv, tmp, ws);
+        BENCHFUNC(bench, gf2x_chain_exec(&chain, t, g, ginv, tmp, ws));
+        if (bench.stats.med < best) {
+            best = bench.stats.med;
+            method = m;
+        }
+
+        for (int k = 0; k < num_tmp; k++) {
+            gf2x_poly_free(&tmp[k]);
+        }
+        free(tmp);
+    }
+
+    free(ws);
+    bench_free(&bench);
+    return method;
+}
+
+// Measure all the tunables for ctx->p, i.e. t and the method
+static int plan_measure(INPLACE ctx_t *ctx, OUT gf2x_tune_t *t) {
+    poly_t a, b, c;
+    gf2x_poly_init(&a, ctx->p - 1);
+    gf2x_poly_init(&b, ctx->p - 1);
+    gf2x_poly_init(&c, ctx->p - 1);
+    gf2x_poly_random_coprime(&a);
+    gf2x_poly_random_coprime(&b);
+
+    *t = tune_default;
+    measure_kara(t, &a, &b, &c);
+    measure_sqr(t, &a, &c);
+    unsigned long long byi = measure_byi(t, ctx, &a, &c);
+    int method = measure_method(t, ctx, byi, &a, &c);
+
+    gf2x_poly_free(&a);
+    gf2x_poly_free(&b);
+    gf2x_poly_free(&c);
+    return method;
+}
+
+/************************************
+ * PLANS
+ ************************************/
+
+// Plan of ctx->p (see gf2x.h)
+gf2x_plan_t *gf2x_plan_create(INPLACE ctx_t *ctx, IN int flags) {
+    char cpu[49];
+    gf2x_cpu_name(cpu);
+
+    const char *path = wisdom_env();
+
+    gf2x_tune_t t;
+    int method;
+
+    // Parameters of CEA, TYT and SAC (if p has no entry in params.h)
+    if (ctx->cea_a == 0) {
+        gf2x_params_search(ctx, NULL);
+    }
+
+    wisdom_t *w = wisdom_find(ctx->p, cpu);
+    if (w != NULL) {
+        t = w->tune;
+        method = w->inv_method;
+    } else if (flags & GF2X_PLAN_WISDOM_ONLY) {
+        return NULL;
+    } else if (flags & GF2X_PLAN_MEASURE) {
+        method = plan_measure(ctx, &t);
+        wisdom_add(ctx->p, cpu, &t, method);
+        if (path != NULL) {
+            gf2x_wisdom_export(path);
+        }
+    } else {
+        t = tune_default;
+        method = ctx->inv_method ? ctx->inv_method : BYI;
+    }
+
+    // A kernel of the wisdom may not be available on this host
+    if (!gf2x_sqr_kernel_ok(t.sqr_kernel)) {
+        t.sqr_kernel = GF2X_SQR_CLMUL;
+    }
+
+    gf2x_plan_t *plan = malloc(sizeof(gf2x_plan_t));
+    plan->ctx = ctx;
+    plan->tune = t;
+    plan->inv_method = method;
+    plan->tmp = NULL;
+    plan->ws = NULL;
+
+    // Scratch of the products and the squarings, and the temporaries of a batch
+    plan->scratch = malloc(gf2x_mod_scratch(&t, (ctx->p + 63) / 64) * sizeof(uint64_t));
+    for (int k = 0; k < 4; k++) {
+        gf2x_poly_init(&plan->batch[k], ctx->p - 1);
+    }
+
+    // Schedule and scratch of the method
+    plan->byi.n = 0;
+    if (method == BYI) {
+        gf2x_byi_plan(&plan->byi, &plan->tune, ctx->p, BYI_DIVSTEPS(ctx->p));
+        plan->byi.team = !(flags & GF2X_PLAN_WORKER);
+        plan->ws = malloc(plan->byi.ws_size * sizeof(uint64_t));
+    } else {
+        gf2x_chain_method(ctx, method, &plan->chain);
+        int num_tmp = plan->chain.num_regs - 2;
+        plan->tmp = malloc((num_tmp > 0 ? num_tmp : 1) * sizeof(poly_t));
+        for (int k = 0; k < num_tmp; k++) {
+            gf2x_poly_init(&plan->tmp[k], ctx->p - 1);
+        }
+    }
+
+    return plan;
+}
+
+void gf2x_plan_destroy(INPLACE gf2x_plan_t *plan) {
+    if (plan == NULL) {
+        return;
+    }
+    if (plan->tmp != NULL) {
+        for (int k = 0; k < plan->chain.num_regs - 2; k++) {
+            gf2x_poly_free(&plan->tmp[k]);
+        }
+        free(plan->tmp);
+    }
+    for (int k = 0; k < 4; k++) {
+        gf2x_poly_free(&plan->batch[k]);
+    }
+    free(plan->scratch);
+    free(plan->ws);
+    free(plan);
+}
+
+// gf2x_tune <- the tunables of the plan, and the BYI schedule of its ctx,
+// for the inversions without a plan (i.e. gf2x_plan_inv does not need it)
+void gf2x_plan_apply(IN gf2x_plan_t *plan) {
+    ctx_t *ctx = plan->ctx;
+
+    gf2x_tune = plan->tune;
+    ctx->inv_method = plan->inv_method;
+
+    if (ctx->byi.n != BYI_DIVSTEPS(ctx->p) || gf2x_byi_plan_stale(&(ctx->byi), &gf2x_tune)) {
+        gf2x_byi_plan(&(ctx->byi), &gf2x_tune, ctx->p, BYI_DIVSTEPS(ctx->p));
+    }
+}
+
+// g^-1 mod (x^p - 1) by the method, the schedule and the tunables 
+// of the plan, in its scratch (i.e. whatever gf2x_tune is)
+void gf2x_plan_inv(
+    INPLACE gf2x_plan_t *plan,
+    IN  poly_t *g,
+    OUT poly_t *ginv
+) {
+    if (plan->inv_method == BYI) {
+        gf2x_byi_run(&plan->byi, plan->ctx->p, g, ginv, plan->ws);
+    } else {
+        gf2x_chain_exec(&plan->chain, &plan->tune, g, ginv, plan->tmp, plan->scratch);
+    }
+}
@@ -0,0 +1,273 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Emrah Karagoz, Pakize Sanal, Abhraneel Dutta, Edoardo Persichetti
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+    #define _GNU_SOURCE     // pthread_setaffinity_np, sched_getaffinity
+#endif
+
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "gf2x.h"
+
+/*********************************************************
+ * Thread pool of batch inversions
+ *
+ * Each worker is pinned to a CPU and owns a plan, i.e. its
+ * workspace is preallocated (see gf2x_plan.c). A call of
+ * gf2x_pool_inv_batch queues a job, and the workers take chunks
+ * of at most GF2X_POOL_CHUNK consecutive inputs from it, whose
+ * inverses are computed by Montgomery's trick in the workspace
+ * and written in place into the arrays of the caller (zero for a
+ * non-invertible input, see gf2x_inv_batch.c).
+ *
+ * The jobs are queued in the order of the calls, so that any
+ * number of threads may call gf2x_pool_inv_batch at a time.
+ * The workers only read the ring (ctx) and their plans (i.e. the
+ * tunables and the BYI schedule of each plan, not gf2x_tune), and
+ * ctx must not be changed while the pool exists.
+**********************************************************/
+
+typedef struct pool_job_s {
+    int     n;
+    int     chunk;
+    int     next;               // first input not taken by a worker
+    int     done;               // inputs inverted
+    int     count;              // invertible inputs
+    poly_t  *g;
+    poly_t  *ginv;
+    pthread_cond_t    finished;
+    struct pool_job_s *link;
+} pool_job_t;
+
+typedef struct {
+    gf2x_pool_t *pool;
+    gf2x_plan_t *plan;
+    int         cpu;            // -1 if not pinned
+    pthread_t   thread;
+} pool_worker_t;
+
+struct gf2x_pool_s {
+    ctx_t           *ctx;
+    int             num_threads;
+    pool_worker_t   *worker;
+    pthread_mutex_t lock;
+    pthread_cond_t  work;
+    pool_job_t      *head;
+    pool_job_t      *tail;
+    int             stop;
+};
+
+// CPUs of the process (i.e. of its affinity), and their number
+static int pool_cpus(OUT int *cpu, IN int max) {
+    int num = 0;
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int c = 0; c < CPU_SETSIZE && num < max; c++) {
+            if (CPU_ISSET(c, &set)) {
+                if (cpu != NULL) cpu[num] = c;
+                num++;
+            }
+        }
+    }
+#endif
+    if (num == 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        num = (n > 0) ? (int)n : 1;
+        num = (num < max) ? num : max;
+        for (int c = 0; cpu != NULL && c < num; c++) {
+            cpu[c] = -1;
+        }
+    }
+    return num;
+}
+
+static void *pool_worker(void *arg) {
+    pool_worker_t *w = arg;
+    gf2x_pool_t *pool = w->pool;
+
+#if defined(__linux__)
+    if (w->cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(w->cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+#endif
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->stop && pool->head == NULL) {
+            pthread_cond_wait(&pool->work, &pool->lock);
+        }
+        if (pool->head == NULL) {
+            break;
+        }
+
+        // Take the next chunk of the first job
+        pool_job_t *job = pool->head;
+        int i = job->next;
+        int m = (job->n - i < job->chunk) ? job->n - i : job->chunk;
+        job->next += m;
+        if (job->next == job->n) {
+            pool->head = job->link;
+            if (pool->head == NULL) {
+                pool->tail = NULL;
+            }
+        }
+        pthread_mutex_unlock(&pool->lock);
+
+        int count = gf2x_mod_inv_batch_plan(w->plan, m, &job->g[i], &job->ginv[i]);
+
+        pthread_mutex_lock(&pool->lock);
+        job->count += count;
+        job->done += m;
+        if (job->done == job->n) {
+            pthread_cond_signal(&job->finished);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+// Pool of num_threads workers (or one per CPU for 0) for ctx->p
+gf2x_pool_t *gf2x_pool_create(INPLACE ctx_t *ctx, IN int num_threads, IN int flags) {
+    int cpu[GF2X_POOL_MAX_THREADS];
+    int num_cpus = pool_cpus(cpu, GF2X_POOL_MAX_THREADS);
+
+    if (num_threads <= 0) {
+        num_threads = num_cpus;
+    }
+    if (num_threads > GF2X_POOL_MAX_THREADS) {
+        num_threads = GF2X_POOL_MAX_THREADS;
+    }
+
+    gf2x_pool_t *pool = malloc(sizeof(gf2x_pool_t));
+    pool->ctx = ctx;
+    pool->num_threads = num_threads;
+    pool->head = NULL;
+    pool->tail = NULL;
+    pool->stop = 0;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work, NULL);
+
+    // The plans are created (and ctx is completed) before any worker
+    // runs, i.e. measured once for GF2X_PLAN_MEASURE and then from the wisdom
+    pool->worker = malloc(num_threads * sizeof(pool_worker_t));
+    for (int t = 0; t < num_threads; t++) {
+        pool->worker[t].pool = pool;
+        pool->worker[t].plan = gf2x_plan_create(ctx, flags | GF2X_PLAN_WORKER);
+        pool->worker[t].cpu  = cpu[t % num_cpus];
+        if (pool->worker[t].plan == NULL) {
+            // No wisdom for GF2X_PLAN_WISDOM_ONLY
+            while (--t >= 0) {
+                gf2x_plan_destroy(pool->worker[t].plan);
+            }
+            pthread_cond_destroy(&pool->work);
+            pthread_mutex_destroy(&pool->lock);
+            free(pool->worker);
+            free(pool);
+            return NULL;
+        }
+    }
+
+    for (int t = 0; t < num_threads; t++) {
+        pthread_create(&pool->worker[t].thread, NULL, pool_worker, &pool->worker[t]);
+    }
+
+    return pool;
+}
+
+void gf2x_pool_destroy(INPLACE gf2x_pool_t *pool) {
+    if (pool == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int t = 0; t < pool->num_threads; t++) {
+        pthread_join(pool->worker[t].thread, NULL);
+        gf2x_plan_destroy(pool->worker[t].plan);
+    }
+
+    pthread_cond_destroy(&pool->work);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->worker);
+    free(pool);
+}
+
+int gf2x_pool_threads(IN gf2x_pool_t *pool) {
+    return pool->num_threads;
+}
+
+// ginv[i] <- g[i]^-1 by the workers, and the number of invertible g[i]
+int gf2x_pool_inv_batch(
+    INPLACE gf2x_pool_t *pool,
+    IN  int n,
+    IN  poly_t *g,
+    OUT poly_t *ginv
+) {
+    if (n <= 0) {
+        return 0;
+    }
+
+    // Chunks of at most GF2X_POOL_CHUNK inputs, but a chunk for each worker
+    // of a small batch
+    int chunk = (n + pool->num_threads - 1) / pool->num_threads;
+    chunk = (chunk < GF2X_POOL_CHUNK) ? chunk : GF2X_POOL_CHUNK;
+
+    pool_job_t job = {
+        .n = n, .chunk = chunk, .next = 0, .done = 0, .count = 0,
+        .g = g, .ginv = ginv, .link = NULL
+    };
+    pthread_cond_init(&job.finished, NULL);
+
+    pthread_mutex_lock(&pool->lock);
+    if (pool->tail != NULL) {
+        pool->tail->link = &job;
+    } else {
+        pool->head = &job;
+    }
+    pool->tail = &job;
+    pthread_cond_broadcast(&pool->work);
+
+    while (job.done < n) {
+        pthread_cond_wait(&job.finished, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    pthread_cond_destroy(&job.finished);
+    return job.count;
+}
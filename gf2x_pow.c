@@ -0,0 +1,199 @@
+/* 
+ * MIT License
+ *
+ * Copyright (c) 2024 Emrah Karagoz, Pakize Sanal, Abhraneel Dutta, Edoardo Persichetti
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gf2x.h"
+
+/*********************************************************
+ * Frobenius map and exponentiation
+ *
+ * In F2[x] / (x^p - 1), the Frobenius map a -> a^2 is 
+ *     a(x)^2 = a(x^2),
+ * so that a^(2^k) = a(x^m) for m = 2^k mod p, i.e. the coefficient 
+ * a_i moves to a_(i*m mod p). This holds for any integer k, where 
+ * k = -1 is the square root (m = 2^-1 = (p+1)/2 mod p). 
+ * 
+ * The permutation only depends on k, so that it is in constant time 
+ * for secret a, and costs about as much as gf2x_tune.frob_min_k squarings.
+**********************************************************/
+
+// 2^k mod p for any integer k
+static int pow2_mod(IN int k, IN int p) {
+    long long b = (k >= 0) ? 2 : (p + 1) / 2;   // 2 or 2^-1 mod p
+    long long m = 1;
+    k = (k >= 0) ? k : -k;
+
+    // k modulo the order of 2, which divides p - 1
+    k %= (p - 1);
+    while (k > 0) {
+        if (k & 1) {
+            m = (m * b) % p;
+        }
+        b = (b * b) % p;
+        k >>= 1;
+    }
+    return (int) m;
+}
+
+// c <- a^(2^k) mod (x^p - 1) for any integer k, by permuting the coefficients
+void gf2x_mod_frob(
+    IN  poly_t *a,
+    IN  int k,
+    OUT poly_t *c
+) {
+    // Required for counting function call
+    PRINT_FUNCTION_NAME("gf2x_mod_frob");
+
+    int p = EXT_DEG;
+
+    // c_j = a_i for i = j * 2^-k mod p
+    int step = pow2_mod(-k, p);
+
+    poly_t tmp;
+    gf2x_poly_init(&tmp, p - 1);
+
+    int i = 0;
+    for (int w = 0; w < tmp.size64; w++) {
+        uint64_t word = 0;
+        int nbits = (64 * w + 64 <= p) ? 64 : (p - 64 * w);
+
+        for (int b = 0; b < nbits; b++) {
+            word |= ((a->data[i >> 6] >> (i & 63)) & 1) << b;
+            i += step;
+            i -= (i >= p) ? p : 0;
+        }
+        tmp.data[w] = word;
+    }
+
+    gf2x_poly_copy(c, &tmp);
+    gf2x_poly_free(&tmp);
+}
+
+// c <- a^(1/2) mod (x^p - 1), i.e. the inverse Frobenius map
+void gf2x_mod_sqrt(
+    IN  poly_t *a,
+    OUT poly_t *c
+) {
+    gf2x_mod_frob(a, -1, c);
+}
+
+// c <- a^(2^k) mod (x^p - 1), by k squarings or by the Frobenius map
+void gf2x_mod_sqr_k(
+    IN  poly_t *a,
+    IN  int k,
+    OUT poly_t *c
+) {
+    if (k >= gf2x_tune.frob_min_k) {
+        gf2x_mod_frob(a, k, c);
+    } else {
+        gf2x_poly_copy(c, a);
+        gf2x_mod_sqr_k_inplace(c, k);
+    }
+}
+
+/*
+    Fixed-window exponentiation g^e, for the windows e_i of w bits of e
+        e = sum_i e_i * 2^(w*i),   T[j] = g^j   (0 <= j < 2^w)
+        c <- T[e_top],  c <- c^(2^w) * T[e_i]   (i = top-1, ..., 0)
+    where T[e_i] is read by scanning the whole table, and c is multiplied
+    for e_i = 0 as well, so that the running time and the memory accesses
+    only depend on ebits.
+*/
+
+// Window of w bits of e at bit i (zero above ebits)
+static inline uint64_t pow_digit(IN uint64_t *e, IN int ebits, IN int i, IN int w) {
+    uint64_t d = 0;
+    for (int b = w - 1; b >= 0; b--) {
+        int j = i + b;
+        uint64_t bit = (j < ebits) ? (e[j >> 6] >> (j & 63)) & 1 : 0;
+        d = (d << 1) | bit;
+    }
+    return d;
+}
+
+// c <- T[d] in constant time, i.e. by masks over all n entries
+static inline void pow_select(IN poly_t *T, IN int n, IN uint64_t d, OUT poly_t *c) {
+    gf2x_poly_zeroize(c);
+    for (int j = 0; j < n; j++) {
+        uint64_t x = d ^ (uint64_t) j;
+        uint64_t mask = ((x | (0 - x)) >> 63) - 1;   // all ones iff d = j
+        for (int i = 0; i < c->size64; i++) {
+            c->data[i] |= T[j].data[i] & mask;
+        }
+    }
+}
+
+// c <- g^e mod (x^p - 1), for e of ebits bits (e[0] is the lowest block)
+void gf2x_mod_pow(
+    IN  ctx_t *ctx,
+    IN  poly_t *g,
+    IN  uint64_t *e,
+    IN  int ebits,
+    OUT poly_t *c
+) {
+    int p = ctx->p;
+    int w = GF2X_POW_WINDOW;
+    int n = 1 << w;
+    int nwin = (ebits + w - 1) / w;
+
+    // T[j] <- g^j, by squaring for even j
+    poly_t T[n];
+    for (int j = 0; j < n; j++) {
+        gf2x_poly_init(&T[j], p - 1);
+    }
+    gf2x_poly_zeroize(&T[0]);
+    T[0].data[0] = 1;
+    gf2x_poly_copy(&T[1], g);
+    for (int j = 2; j < n; j++) {
+        if (j & 1) {
+            gf2x_mod_mul(&T[j-1], g, &T[j]);
+        } else {
+            gf2x_mod_sqr(&T[j/2], &T[j]);
+        }
+    }
+
+    poly_t t;
+    gf2x_poly_init(&t, p - 1);
+
+    if (nwin == 0) {
+        gf2x_poly_copy(c, &T[0]);
+    } else {
+        pow_select(T, n, pow_digit(e, ebits, w * (nwin - 1), w), c);
+    }
+
+    for (int i = nwin - 2; i >= 0; i--) {
+        gf2x_mod_sqr_k_inplace(c, w);
+        pow_select(T, n, pow_digit(e, ebits, w * i, w), &t);
+        gf2x_mod_mul(c, &t, c);
+    }
+
+    gf2x_poly_free(&t);
+    for (int j = 0; j < n; j++) {
+        gf2x_poly_free(&T[j]);
+    }
+}
@@ -40,7 +40,13 @@ void gf2x_red(
 
     c->data[LAST_BLOCK_IDX] = h->data[LAST_BLOCK_IDX] & LAST_BLOCK_MASK;
 
-    for(int i = LAST_BLOCK_IDX; i < h->size64; i++) {
+    for(int i = LAST_BLOCK_IDX; i < h->size64 - 1; i++) {
         c->data[i - LAST_BLOCK_IDX] ^= ((h->data[i] >> LAST_BLOCK_BITSIZE) | (h->data[i + 1] << (64 - LAST_BLOCK_BITSIZE)));
     }
+
+    // The last block of h has no upper neighbour, and
+    // it only lands in c if it is still within NUM_BLOCKS
+    if (h->size64 - 1 - LAST_BLOCK_IDX < NUM_BLOCKS) {
+        c->data[h->size64 - 1 - LAST_BLOCK_IDX] ^= (h->data[h->size64 - 1] >> LAST_BLOCK_BITSIZE);
+    }
 }
\ No newline at end of file
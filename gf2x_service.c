@@ -0,0 +1,455 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Emrah Karagoz, Pakize Sanal, Abhraneel Dutta, Edoardo Persichetti
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "gf2x.h"
+
+/*********************************************************
+ * Asynchronous inversion service
+ *
+ * The clients push their requests into a single submission ring
+ * without blocking, and pop the results from a completion ring of
+ * their own. Both rings are bounded lock-free MPSC queues (i.e. of
+ * any number of producers and a single consumer): the producers 
+ * claim a slot by a CAS on its tail, and each slot is published by
+ * its sequence number.
+ *
+ * A worker takes all the queued requests (at most GF2X_SVC_BATCH)
+ * at a time, under the lock of the consumer of the submission
+ * ring, and inverts them by a batch of its plan (i.e. Montgomery's
+ * trick). The batching is therefore automatic under load, and a
+ * single request is inverted alone otherwise.
+ *
+ * Backpressure: a client has at most depth requests in flight (the
+ * size of its completion ring, so that a completion never waits),
+ * and the submission ring is of GF2X_SVC_DEPTH requests, i.e. 
+ * gf2x_svc_submit returns 0 if either is full.
+**********************************************************/
+
+typedef struct {
+    _Atomic size_t  seq;
+    gf2x_svc_cqe_t  e;
+} ring_slot_t;
+
+typedef struct {
+    size_t          mask;       // number of slots - 1
+    ring_slot_t     *slot;
+    _Atomic size_t  tail;       // next slot of the producers
+    size_t          head;       // next slot of the consumer
+} ring_t;
+
+struct gf2x_svc_client_s {
+    gf2x_svc_t      *svc;
+    ring_t          cq;
+    int             depth;
+    _Atomic int     inflight;
+    _Atomic int     sleeping;
+    _Atomic int     users;      // workers completing a request of the client
+    pthread_mutex_t lock;
+    pthread_cond_t  done;
+};
+
+typedef struct {
+    gf2x_svc_t      *svc;
+    gf2x_plan_t     *plan;
+    pthread_t       thread;
+} svc_worker_t;
+
+struct gf2x_svc_s {
+    ctx_t           *ctx;
+    int             num_threads;
+    svc_worker_t    *worker;
+    ring_t          sq;
+    pthread_mutex_t consumer;   // of sq
+    _Atomic int     sleeping;   // workers waiting for work
+    _Atomic int     stop;
+    pthread_mutex_t lock;
+    pthread_cond_t  work;
+};
+
+// Time stamp of the requests, in nanoseconds
+static inline uint64_t svc_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/************************************
+ * MPSC RING
+ ************************************/
+
+// Ring of (at least) n slots, for a power of two
+static void ring_init(OUT ring_t *r, IN int n) {
+    size_t size = 1;
+    while (size < (size_t) n) {
+        size <<= 1;
+    }
+
+    r->mask = size - 1;
+    r->slot = malloc(size * sizeof(ring_slot_t));
+    for (size_t i = 0; i < size; i++) {
+        atomic_init(&r->slot[i].seq, i);
+    }
+    atomic_init(&r->tail, 0);
+    r->head = 0;
+}
+
+static void ring_free(INPLACE ring_t *r) {
+    free(r->slot);
+}
+
+// Push e by any producer, or 0 if the ring is full
+static int ring_push(INPLACE ring_t *r, IN gf2x_svc_cqe_t *e) {
+    size_t pos = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    ring_slot_t *slot;
+
+    for (;;) {
+        slot = &r->slot[pos & r->mask];
+        size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&r->tail, &pos, pos + 1,
+                    memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return 0;
+        } else {
+            pos = atomic_load_explicit(&r->tail, memory_order_relaxed);
+        }
+    }
+
+    slot->e = *e;
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+    return 1;
+}
+
+// Pop into e by the consumer, or 0 if the ring is empty
+static int ring_pop(INPLACE ring_t *r, OUT gf2x_svc_cqe_t *e) {
+    ring_slot_t *slot = &r->slot[r->head & r->mask];
+    size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+
+    if (seq != r->head + 1) {
+        return 0;
+    }
+
+    *e = slot->e;
+    atomic_store_explicit(&slot->seq, r->head + r->mask + 1, memory_order_release);
+    r->head += 1;
+    return 1;
+}
+
+// Whether the ring has an entry for its consumer
+static int ring_ready(IN ring_t *r) {
+    ring_slot_t *slot = &r->slot[r->head & r->mask];
+    return atomic_load_explicit(&slot->seq, memory_order_acquire) == r->head + 1;
+}
+
+/************************************
+ * WORKERS
+ ************************************/
+
+// Whether an output of a batch is zero, i.e. of a non-invertible input
+static inline int svc_is_zero(IN poly_t *a) {
+    uint64_t t = 0;
+    for (int i = 0; i < a->size64; i++) {
+        t |= a->data[i];
+    }
+    return t == 0;
+}
+
+// Wake a thread waiting on cond (if any, as sleeping tells) after a push,
+// which is ordered before the load of sleeping by the fence
+static inline void svc_wake(_Atomic int *sleeping, pthread_mutex_t *lock, pthread_cond_t *cond) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load(sleeping) > 0) {
+        pthread_mutex_lock(lock);
+        pthread_cond_broadcast(cond);
+        pthread_mutex_unlock(lock);
+    }
+}
+
+// Inverses of the requests e[0, m) into their ginv, and their completions
+static void svc_invert(
+    INPLACE svc_worker_t *w,
+    INPLACE gf2x_svc_cqe_t *e,
+    IN int m,
+    poly_t *g,
+    poly_t *ginv
+) {
+    for (int i = 0; i < m; i++) {
+        gf2x_poly_copy(&g[i], e[i].g);
+    }
+
+    // The inverse of a non-invertible request is zero
+    int count = gf2x_mod_inv_batch_plan(w->plan, m, g, ginv);
+    for (int i = 0; i < m; i++) {
+        e[i].invertible = (m == count) || !svc_is_zero(&ginv[i]);
+    }
+
+    uint64_t now = svc_now();
+    for (int i = 0; i < m; i++) {
+        gf2x_poly_copy(e[i].ginv, &ginv[i]);
+        e[i].t_done = now;
+
+        // The client is not destroyed while it has a user, i.e. until 
+        // the wake-up after the completion is reaped
+        gf2x_svc_client_t *c = e[i].client;
+        atomic_fetch_add(&c->users, 1);
+        int ok = ring_push(&c->cq, &e[i]);
+        assert(ok);
+        (void) ok;
+        svc_wake(&c->sleeping, &c->lock, &c->done);
+        atomic_fetch_sub(&c->users, 1);
+    }
+}
+
+static void *svc_worker(void *arg) {
+    svc_worker_t *w = arg;
+    gf2x_svc_t *svc = w->svc;
+
+    gf2x_svc_cqe_t e[GF2X_SVC_BATCH];
+    poly_t g[GF2X_SVC_BATCH], ginv[GF2X_SVC_BATCH];
+    for (int i = 0; i < GF2X_SVC_BATCH; i++) {
+        gf2x_poly_init(&g[i], svc->ctx->p - 1);
+        gf2x_poly_init(&ginv[i], svc->ctx->p - 1);
+    }
+
+    for (;;) {
+        // All the queued requests, up to a batch
+        int m = 0;
+        pthread_mutex_lock(&svc->consumer);
+        while (m < GF2X_SVC_BATCH && ring_pop(&svc->sq, &e[m])) {
+            m++;
+        }
+        pthread_mutex_unlock(&svc->consumer);
+
+        if (m > 0) {
+            uint64_t now = svc_now();
+            for (int i = 0; i < m; i++) {
+                e[i].t_start = now;
+            }
+            svc_invert(w, e, m, g, ginv);
+            continue;
+        }
+
+        // Sleep until a request (or the stop) comes, where sleeping is
+        // raised before the ring is checked again, so that no wake-up is lost
+        pthread_mutex_lock(&svc->lock);
+        atomic_fetch_add(&svc->sleeping, 1);
+        pthread_mutex_lock(&svc->consumer);
+        int ready = ring_ready(&svc->sq);
+        pthread_mutex_unlock(&svc->consumer);
+        if (!ready && atomic_load(&svc->stop)) {
+            atomic_fetch_sub(&svc->sleeping, 1);
+            pthread_mutex_unlock(&svc->lock);
+            break;
+        }
+        if (!ready) {
+            pthread_cond_wait(&svc->work, &svc->lock);
+        }
+        atomic_fetch_sub(&svc->sleeping, 1);
+        pthread_mutex_unlock(&svc->lock);
+    }
+
+    for (int i = 0; i < GF2X_SVC_BATCH; i++) {
+        gf2x_poly_free(&g[i]);
+        gf2x_poly_free(&ginv[i]);
+    }
+    return NULL;
+}
+
+/************************************
+ * SERVICE AND CLIENTS
+ ************************************/
+
+// Service of num_threads workers (at least one) for ctx->p
+gf2x_svc_t *gf2x_svc_create(INPLACE ctx_t *ctx, IN int num_threads, IN int flags) {
+    if (num_threads <= 0) {
+        num_threads = 1;
+    }
+
+    gf2x_svc_t *svc = malloc(sizeof(gf2x_svc_t));
+    svc->ctx = ctx;
+    svc->num_threads = num_threads;
+    ring_init(&svc->sq, GF2X_SVC_DEPTH);
+    pthread_mutex_init(&svc->consumer, NULL);
+    pthread_mutex_init(&svc->lock, NULL);
+    pthread_cond_init(&svc->work, NULL);
+    atomic_init(&svc->sleeping, 0);
+    atomic_init(&svc->stop, 0);
+
+    // The plans are created (and ctx is completed) before any worker runs
+    svc->worker = malloc(num_threads * sizeof(svc_worker_t));
+    for (int t = 0; t < num_threads; t++) {
+        svc->worker[t].svc = svc;
+        svc->worker[t].plan = gf2x_plan_create(ctx, flags | GF2X_PLAN_WORKER);
+        if (svc->worker[t].plan == NULL) {
+            // No wisdom for GF2X_PLAN_WISDOM_ONLY
+            while (--t >= 0) {
+                gf2x_plan_destroy(svc->worker[t].plan);
+            }
+            ring_free(&svc->sq);
+            free(svc->worker);
+            free(svc);
+            return NULL;
+        }
+    }
+
+    for (int t = 0; t < num_threads; t++) {
+        pthread_create(&svc->worker[t].thread, NULL, svc_worker, &svc->worker[t]);
+    }
+
+    return svc;
+}
+
+// Stop the workers, after the requests already submitted
+void gf2x_svc_destroy(INPLACE gf2x_svc_t *svc) {
+    if (svc == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&svc->lock);
+    atomic_store(&svc->stop, 1);
+    pthread_cond_broadcast(&svc->work);
+    pthread_mutex_unlock(&svc->lock);
+
+    for (int t = 0; t < svc->num_threads; t++) {
+        pthread_join(svc->worker[t].thread, NULL);
+        gf2x_plan_destroy(svc->worker[t].plan);
+    }
+
+    pthread_cond_destroy(&svc->work);
+    pthread_mutex_destroy(&svc->lock);
+    pthread_mutex_destroy(&svc->consumer);
+    ring_free(&svc->sq);
+    free(svc->worker);
+    free(svc);
+}
+
+// Client of at most depth requests in flight
+gf2x_svc_client_t *gf2x_svc_client_create(INPLACE gf2x_svc_t *svc, IN int depth) {
+    assert(depth >= 1);
+
+    gf2x_svc_client_t *c = malloc(sizeof(gf2x_svc_client_t));
+    c->svc = svc;
+    c->depth = depth;
+    ring_init(&c->cq, depth);
+    atomic_init(&c->inflight, 0);
+    atomic_init(&c->sleeping, 0);
+    atomic_init(&c->users, 0);
+    pthread_mutex_init(&c->lock, NULL);
+    pthread_cond_init(&c->done, NULL);
+    return c;
+}
+
+// The requests in flight are reaped first
+void gf2x_svc_client_destroy(INPLACE gf2x_svc_client_t *c) {
+    if (c == NULL) {
+        return;
+    }
+
+    gf2x_svc_cqe_t e;
+    while (atomic_load(&c->inflight) > 0) {
+        gf2x_svc_reap(c, &e, 1, 1);
+    }
+    while (atomic_load(&c->users) > 0) {
+        sched_yield();
+    }
+
+    pthread_cond_destroy(&c->done);
+    pthread_mutex_destroy(&c->lock);
+    ring_free(&c->cq);
+    free(c);
+}
+
+// Submit ginv <- g^-1 without blocking, i.e. 1, or 0 if it is full
+int gf2x_svc_submit(
+    INPLACE gf2x_svc_client_t *c,
+    IN  poly_t *g,
+    OUT poly_t *ginv,
+    IN  uint64_t user_data
+) {
+    gf2x_svc_t *svc = c->svc;
+
+    if (atomic_fetch_add(&c->inflight, 1) >= c->depth) {
+        atomic_fetch_sub(&c->inflight, 1);
+        return 0;
+    }
+
+    gf2x_svc_cqe_t e = {
+        .user_data = user_data,
+        .g = g, .ginv = ginv,
+        .client = c,
+        .invertible = 0,
+        .t_submit = svc_now(), .t_start = 0, .t_done = 0
+    };
+    if (!ring_push(&svc->sq, &e)) {
+        atomic_fetch_sub(&c->inflight, 1);
+        return 0;
+    }
+
+    svc_wake(&svc->sleeping, &svc->lock, &svc->work);
+    return 1;
+}
+
+// Completions of the client (at most max), waiting for one if wait is set
+// and there is a request in flight, and their number
+int gf2x_svc_reap(
+    INPLACE gf2x_svc_client_t *c,
+    OUT gf2x_svc_cqe_t *cqe,
+    IN  int max,
+    IN  int wait
+) {
+    int n = 0;
+    while (n < max && ring_pop(&c->cq, &cqe[n])) {
+        n++;
+    }
+
+    if (n == 0 && wait && atomic_load(&c->inflight) > 0) {
+        pthread_mutex_lock(&c->lock);
+        atomic_fetch_add(&c->sleeping, 1);
+        while (!ring_ready(&c->cq)) {
+            pthread_cond_wait(&c->done, &c->lock);
+        }
+        atomic_fetch_sub(&c->sleeping, 1);
+        pthread_mutex_unlock(&c->lock);
+
+        while (n < max && ring_pop(&c->cq, &cqe[n])) {
+            n++;
+        }
+    }
+
+    atomic_fetch_sub(&c->inflight, n);
+    return n;
+}
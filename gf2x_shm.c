@@ -0,0 +1,979 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Emrah Karagoz, Pakize Sanal, Abhraneel Dutta, Edoardo Persichetti
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+    #define _GNU_SOURCE     // memfd_create, sched_setaffinity
+#endif
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gf2x.h"
+
+/*********************************************************
+ * Inversion daemon over shared memory
+ *
+ * gf2x_shm_serve listens on a Unix socket, and forks workers
+ * (processes, i.e. a crash is isolated), pinned to the CPUs or to
+ * the NUMA nodes. For each client, it creates a segment (memfd) of
+ *     header | submission ring | completion ring | slots
+ * which is passed by SCM_RIGHTS to the client and to the worker of
+ * its shard (the one of the fewest clients). A slot is three
+ * polynomials (a, b, out), i.e. a poly_t itself for static 
+ * polynomials, and the blocks of its data otherwise, so that both
+ * the client and the worker compute in place (zero-copy).
+ *
+ * The rings are single-producer single-consumer (the client and its 
+ * worker). The tail of the completion ring is also the head of the
+ * submission ring, i.e. a request is consumed when its completion is
+ * published, so that a respawned worker redoes the unpublished 
+ * requests of a crashed one, and never a published one (whose slot
+ * the client may already reuse). A sleeping worker is woken by a futex on its bell
+ * (a counter in a segment of all the workers), and a client by a
+ * futex on the tail of its completion ring.
+**********************************************************/
+
+#if defined(__linux__)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <poll.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SHM_MAGIC       0x706f6c79u     // "poly"
+#define SHM_POLL_MS     100             // timeout of the daemon and of the futexes
+#define SHM_EXIT_PLAN   2               // exit status of a worker without a plan
+
+// Bytes of a polynomial of a slot
+#if defined(USE_STATIC_POLY)
+    #define SHM_POLY_SIZE   sizeof(poly_t)
+#else
+    #define SHM_POLY_SIZE   (NUM_BLOCKS * sizeof(uint64_t))
+#endif
+
+// Control messages (client -> daemon -> client, and daemon -> worker)
+typedef struct {
+    uint32_t magic;
+    uint32_t ext_deg;
+    uint32_t poly_size;         // SHM_POLY_SIZE of the client
+    uint32_t depth;
+} shm_hello_t;
+
+typedef struct {
+    int32_t  status;            // 0, or -1
+    int32_t  shard;
+    int32_t  worker;            // pid of the worker
+    uint32_t depth;
+} shm_reply_t;
+
+#define SHM_ADD     1           // serve a client (with its segment)
+#define SHM_DEL     2           // drop a client
+
+typedef struct {
+    int32_t  type;
+    int32_t  id;
+    uint32_t depth;
+} shm_ctl_t;
+
+// Segment of a client
+typedef struct {
+    uint32_t magic;
+    uint32_t depth;
+    _Alignas(64) _Atomic uint32_t sq_tail;  // by the client
+    _Alignas(64) _Atomic uint32_t cq_head;  // by the client
+    _Alignas(64) _Atomic uint32_t cq_tail;  // by the worker (head of the submissions)
+    _Atomic uint32_t cq_waiting;
+} shm_header_t;
+
+// Bell of a worker
+typedef struct {
+    _Alignas(64) _Atomic uint32_t seq;
+    _Atomic uint32_t sleeping;
+    int32_t pid;
+} shm_bell_t;
+
+static inline size_t shm_seg_size(uint32_t depth) {
+    return sizeof(shm_header_t) + 2 * depth * sizeof(gf2x_shm_cqe_t) + 3 * depth * SHM_POLY_SIZE;
+}
+
+static inline gf2x_shm_cqe_t *shm_sq(shm_header_t *h) {
+    return (gf2x_shm_cqe_t *) (h + 1);
+}
+
+// The depth is never read from the header, which the client can write
+static inline gf2x_shm_cqe_t *shm_cq(shm_header_t *h, uint32_t depth) {
+    return shm_sq(h) + depth;
+}
+
+// Polynomial of a slot (which = 0, 1, 2 for a, b, out), by a view of its 
+// blocks for dynamic polynomials
+static inline poly_t *shm_poly(shm_header_t *h, uint32_t depth, uint32_t slot, int which, poly_t *view) {
+    uint8_t *p = (uint8_t *) (shm_cq(h, depth) + depth) + (3 * slot + which) * SHM_POLY_SIZE;
+    #if defined(USE_STATIC_POLY)
+    // The sizes are not trusted, since both sides write them
+    (void) view;
+    poly_t *f = (poly_t *) p;
+    f->deg = EXT_DEG - 1;
+    f->size64 = NUM_BLOCKS;
+    return f;
+    #else
+    view->deg = EXT_DEG - 1;
+    view->size64 = NUM_BLOCKS;
+    view->data = (uint64_t *) p;
+    return view;
+    #endif
+}
+
+static inline uint64_t shm_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static inline void futex_wait(_Atomic uint32_t *addr, uint32_t val) {
+    struct timespec t = { .tv_sec = 0, .tv_nsec = SHM_POLL_MS * 1000000L };
+    syscall(SYS_futex, (uint32_t *) addr, FUTEX_WAIT, val, &t, NULL, 0);
+}
+
+static inline void futex_wake(_Atomic uint32_t *addr) {
+    syscall(SYS_futex, (uint32_t *) addr, FUTEX_WAKE, INT32_MAX, NULL, NULL, 0);
+}
+
+// Send or receive a message with (at most) two descriptors
+static int shm_send(int sock, const void *msg, size_t len, int *fds, int num_fds) {
+    struct iovec iov = { .iov_base = (void *) msg, .iov_len = len };
+    union { struct cmsghdr h; char buf[CMSG_SPACE(2 * sizeof(int))]; } u;
+    struct msghdr m = { .msg_iov = &iov, .msg_iovlen = 1 };
+
+    if (num_fds > 0) {
+        memset(&u, 0, sizeof(u));
+        m.msg_control = u.buf;
+        m.msg_controllen = CMSG_SPACE(num_fds * sizeof(int));
+        struct cmsghdr *c = CMSG_FIRSTHDR(&m);
+        c->cmsg_level = SOL_SOCKET;
+        c->cmsg_type = SCM_RIGHTS;
+        c->cmsg_len = CMSG_LEN(num_fds * sizeof(int));
+        memcpy(CMSG_DATA(c), fds, num_fds * sizeof(int));
+    }
+    return (sendmsg(sock, &m, MSG_NOSIGNAL) == (ssize_t) len) ? 0 : -1;
+}
+
+static int shm_recv(int sock, void *msg, size_t len, int *fds, int max_fds, int flags) {
+    struct iovec iov = { .iov_base = msg, .iov_len = len };
+    union { struct cmsghdr h; char buf[CMSG_SPACE(2 * sizeof(int))]; } u;
+    struct msghdr m = { .msg_iov = &iov, .msg_iovlen = 1,
+                        .msg_control = u.buf, .msg_controllen = sizeof(u.buf) };
+
+    ssize_t r = recvmsg(sock, &m, flags | MSG_CMSG_CLOEXEC);
+    if (r != (ssize_t) len) {
+        if (r >= 0) errno = EPIPE;      // EOF (or a short message)
+        return -1;
+    }
+
+    int num = 0;
+    for (struct cmsghdr *c = CMSG_FIRSTHDR(&m); c != NULL; c = CMSG_NXTHDR(&m, c)) {
+        if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_RIGHTS) {
+            int n = (c->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            for (int k = 0; k < n; k++) {
+                int fd;
+                memcpy(&fd, CMSG_DATA(c) + k * sizeof(int), sizeof(int));
+                if (num < max_fds) fds[num++] = fd; else close(fd);
+            }
+        }
+    }
+    return num;
+}
+
+/************************************
+ * WORKERS
+ ************************************/
+
+typedef struct {
+    int             id;         // -1 for a free entry
+    shm_header_t    *seg;
+    uint32_t        depth;
+} shm_served_t;
+
+static inline int shm_is_zero(IN poly_t *a) {
+    uint64_t t = 0;
+    for (int i = 0; i < a->size64; i++) {
+        t |= a->data[i];
+    }
+    return t == 0;
+}
+
+// Run the requests e[0..m) of the segment h (in its slots): the 
+// multiplications one by one, and the inversions by a batch (in g)
+static void shm_exec(
+    gf2x_plan_t *plan,
+    shm_header_t *h,
+    uint32_t depth,
+    gf2x_shm_cqe_t *e,
+    int m,
+    poly_t *g,
+    poly_t *ginv
+) {
+    poly_t va, vb, vc;
+    int inv[GF2X_SHM_BATCH], k = 0;
+
+    for (int i = 0; i < m; i++) {
+        if (e[i].slot >= depth || (e[i].op != GF2X_SHM_INV && e[i].op != GF2X_SHM_MUL)) {
+            e[i].status = -1;
+        } else if (e[i].op == GF2X_SHM_INV) {
+            gf2x_poly_copy(&g[k], shm_poly(h, depth, e[i].slot, 0, &va));
+            inv[k++] = i;
+        } else {
+            gf2x_mod_mul_kara_tune(&plan->tune, shm_poly(h, depth, e[i].slot, 0, &va), 
+                                   shm_poly(h, depth, e[i].slot, 1, &vb), 
+                                   shm_poly(h, depth, e[i].slot, 2, &vc), plan->scratch);
+            e[i].status = 0;
+        }
+    }
+    if (k == 0) {
+        return;
+    }
+
+    // The inverse of a non-invertible request is zero
+    int count = gf2x_mod_inv_batch_plan(plan, k, g, ginv);
+    for (int j = 0; j < k; j++) {
+        int invertible = (k == count) || !shm_is_zero(&ginv[j]);
+        e[inv[j]].status = invertible ? 0 : 1;
+        gf2x_poly_copy(shm_poly(h, depth, e[inv[j]].slot, 2, &vc), &ginv[j]);
+    }
+}
+
+// Requests of a client (at most GF2X_SHM_BATCH at a time), and their number,
+// whose completions are published at once
+static int shm_serve_client(
+    gf2x_plan_t *plan,
+    shm_header_t *h,
+    uint32_t depth,
+    gf2x_shm_cqe_t *e,
+    poly_t *g,
+    poly_t *ginv
+) {
+    uint32_t head = atomic_load_explicit(&h->cq_tail, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&h->sq_tail, memory_order_acquire);
+    int m = 0;
+
+    while (head + m != tail && m < GF2X_SHM_BATCH) {
+        e[m] = shm_sq(h)[(head + m) % depth];
+        m++;
+    }
+    if (m == 0) {
+        return 0;
+    }
+
+    shm_exec(plan, h, depth, e, m, g, ginv);
+
+    uint64_t now = shm_now();
+    for (int i = 0; i < m; i++) {
+        e[i].t_done = now;
+        shm_cq(h, depth)[(head + i) % depth] = e[i];
+    }
+    atomic_store_explicit(&h->cq_tail, head + m, memory_order_release);
+
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load(&h->cq_waiting)) {
+        futex_wake(&h->cq_tail);
+    }
+    return m;
+}
+
+static void shm_worker(ctx_t *ctx, int flags, int ctl, shm_bell_t *bell) {
+    shm_served_t served[GF2X_SHM_MAX_CLIENTS];
+    for (int k = 0; k < GF2X_SHM_MAX_CLIENTS; k++) {
+        served[k].id = -1;
+    }
+
+    // The daemon stops, rather than respawning a worker which cannot plan
+    gf2x_plan_t *plan = gf2x_plan_create(ctx, flags | GF2X_PLAN_WORKER);
+    if (plan == NULL) {
+        _exit(SHM_EXIT_PLAN);
+    }
+    fcntl(ctl, F_SETFL, O_NONBLOCK);
+
+    gf2x_shm_cqe_t e[GF2X_SHM_BATCH];
+    poly_t g[GF2X_SHM_BATCH], ginv[GF2X_SHM_BATCH];
+    for (int i = 0; i < GF2X_SHM_BATCH; i++) {
+        gf2x_poly_init(&g[i], ctx->p - 1);
+        gf2x_poly_init(&ginv[i], ctx->p - 1);
+    }
+
+    for (;;) {
+        // Control messages of the daemon (EOF when it exits)
+        shm_ctl_t msg;
+        int fd;
+        int r;
+        while ((r = shm_recv(ctl, &msg, sizeof(msg), &fd, 1, 0)) >= 0) {
+            if (msg.type == SHM_ADD && r == 1) {
+                for (int k = 0; k < GF2X_SHM_MAX_CLIENTS; k++) {
+                    if (served[k].id < 0) {
+                        served[k].seg = mmap(NULL, shm_seg_size(msg.depth), PROT_READ | PROT_WRITE, 
+                                             MAP_SHARED, fd, 0);
+                        served[k].depth = msg.depth;
+                        served[k].id = (served[k].seg == MAP_FAILED) ? -1 : msg.id;
+                        break;
+                    }
+                }
+                close(fd);
+            } else if (msg.type == SHM_DEL) {
+                for (int k = 0; k < GF2X_SHM_MAX_CLIENTS; k++) {
+                    if (served[k].id == msg.id) {
+                        munmap(served[k].seg, shm_seg_size(served[k].depth));
+                        served[k].id = -1;
+                    }
+                }
+            }
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            break;
+        }
+
+        int work = 0;
+        for (int k = 0; k < GF2X_SHM_MAX_CLIENTS; k++) {
+            if (served[k].id >= 0) {
+                work += shm_serve_client(plan, served[k].seg, served[k].depth, e, g, ginv);
+            }
+        }
+        if (work > 0) {
+            continue;
+        }
+
+        // Sleep on the bell, after the rings are checked again
+        uint32_t seq = atomic_load(&bell->seq);
+        atomic_store(&bell->sleeping, 1);
+        atomic_thread_fence(memory_order_seq_cst);
+        for (int k = 0; k < GF2X_SHM_MAX_CLIENTS; k++) {
+            shm_header_t *h = served[k].seg;
+            if (served[k].id >= 0 && atomic_load(&h->cq_tail) != atomic_load(&h->sq_tail)) {
+                work = 1;
+            }
+        }
+        if (!work) {
+            futex_wait(&bell->seq, seq);
+        }
+        atomic_store(&bell->sleeping, 0);
+    }
+
+    for (int i = 0; i < GF2X_SHM_BATCH; i++) {
+        gf2x_poly_free(&g[i]);
+        gf2x_poly_free(&ginv[i]);
+    }
+    gf2x_plan_destroy(plan);
+    _exit(0);
+}
+
+/************************************
+ * DAEMON
+ ************************************/
+
+typedef struct {
+    int     sock;               // -1 for a free entry
+    int     seg;                // memfd of the segment
+    int     shard;
+    int     depth;
+} shm_client_t;
+
+typedef struct {
+    ctx_t           *ctx;
+    int             flags;
+    int             num_workers;
+    pid_t           pid[GF2X_SHM_MAX_WORKERS];
+    int             ctl[GF2X_SHM_MAX_WORKERS];
+    int             lsock;
+    int             bells_fd;
+    shm_bell_t      *bells;
+    cpu_set_t       cpus[GF2X_SHM_MAX_WORKERS];
+    shm_client_t    client[GF2X_SHM_MAX_CLIENTS];
+} shm_daemon_t;
+
+static volatile sig_atomic_t shm_stop = 0;
+
+static void shm_on_signal(int sig) {
+    (void) sig;
+    shm_stop = 1;
+}
+
+// CPUs of each worker, i.e. of its NUMA node (round-robin on the nodes),
+// or a CPU of the process (round-robin on the CPUs)
+static void shm_pin_plan(shm_daemon_t *d, int numa) {
+    cpu_set_t all;
+    CPU_ZERO(&all);
+    sched_getaffinity(0, sizeof(all), &all);
+
+    int num_nodes = 0;
+    cpu_set_t node[64];
+    for (int n = 0; numa && n < 64; n++) {
+        char path[64], list[4096];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", n);
+        FILE *f = fopen(path, "r");
+        if (f == NULL) {
+            break;
+        }
+        CPU_ZERO(&node[n]);
+        if (fgets(list, sizeof(list), f) != NULL) {
+            // e.g. "0-3,8-11"
+            for (char *s = strtok(list, ",\n"); s != NULL; s = strtok(NULL, ",\n")) {
+                int lo, hi;
+                int k = sscanf(s, "%d-%d", &lo, &hi);
+                for (int c = lo; k >= 1 && c <= ((k == 2) ? hi : lo) && c < CPU_SETSIZE; c++) {
+                    if (CPU_ISSET(c, &all)) CPU_SET(c, &node[n]);
+                }
+            }
+        }
+        fclose(f);
+        num_nodes++;
+    }
+
+    int cpus[CPU_SETSIZE], num_cpus = 0;
+    for (int c = 0; c < CPU_SETSIZE; c++) {
+        if (CPU_ISSET(c, &all)) cpus[num_cpus++] = c;
+    }
+
+    for (int w = 0; w < d->num_workers; w++) {
+        CPU_ZERO(&d->cpus[w]);
+        if (num_nodes > 0 && CPU_COUNT(&node[w % num_nodes]) > 0) {
+            d->cpus[w] = node[w % num_nodes];
+        } else if (num_cpus > 0) {
+            CPU_SET(cpus[w % num_cpus], &d->cpus[w]);
+        } else {
+            d->cpus[w] = all;
+        }
+    }
+}
+
+// (Re)start the worker w, and give it the segments of its clients
+// (or no worker w, i.e. no pid and no control socket, on a failure)
+static int shm_spawn(shm_daemon_t *d, int w) {
+    d->pid[w] = 0;
+    d->ctl[w] = -1;
+    d->bells[w].pid = 0;
+
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sv) < 0) {
+        return -1;
+    }
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(sv[0]);
+        close(sv[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        // Only the control socket, and the worker exits with the daemon
+        close(sv[0]);
+        close(d->lsock);
+        for (int j = 0; j < d->num_workers; j++) {
+            if (j != w && d->ctl[j] >= 0) close(d->ctl[j]);
+        }
+        for (int k = 0; k < GF2X_SHM_MAX_CLIENTS; k++) {
+            if (d->client[k].sock >= 0) close(d->client[k].sock);
+        }
+        prctl(PR_SET_PDEATHSIG, SIGTERM);
+        signal(SIGTERM, SIG_DFL);
+        signal(SIGINT, SIG_IGN);
+        sched_setaffinity(0, sizeof(cpu_set_t), &d->cpus[w]);
+        shm_worker(d->ctx, d->flags, sv[1], &d->bells[w]);
+    }
+
+    close(sv[1]);
+    d->pid[w] = pid;
+    d->ctl[w] = sv[0];
+    d->bells[w].pid = pid;
+
+    for (int k = 0; k < GF2X_SHM_MAX_CLIENTS; k++) {
+        if (d->client[k].sock >= 0 && d->client[k].shard == w) {
+            shm_ctl_t msg = { .type = SHM_ADD, .id = k, .depth = d->client[k].depth };
+            shm_send(d->ctl[w], &msg, sizeof(msg), &d->client[k].seg, 1);
+        }
+    }
+    return 0;
+}
+
+static void shm_ring_bell(shm_bell_t *bell) {
+    atomic_fetch_add(&bell->seq, 1);
+    futex_wake(&bell->seq);
+}
+
+// A new client on sock, and its entry (or -1)
+static int shm_accept(shm_daemon_t *d, int sock) {
+    shm_hello_t hello;
+    shm_reply_t reply = { .status = -1, .shard = -1, .worker = 0, .depth = 0 };
+
+    int k = 0;
+    while (k < GF2X_SHM_MAX_CLIENTS && d->client[k].sock >= 0) {
+        k++;
+    }
+
+    // The hello is read without blocking the daemon for more than a poll
+    struct timeval tv = { .tv_sec = 0, .tv_usec = SHM_POLL_MS * 1000 };
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    if (k == GF2X_SHM_MAX_CLIENTS ||
+        shm_recv(sock, &hello, sizeof(hello), NULL, 0, 0) < 0 ||
+        hello.magic != SHM_MAGIC || hello.ext_deg != EXT_DEG ||
+        hello.poly_size != SHM_POLY_SIZE ||
+        hello.depth < 1 || hello.depth > GF2X_SHM_MAX_DEPTH) {
+        shm_send(sock, &reply, sizeof(reply), NULL, 0);
+        close(sock);
+        return -1;
+    }
+
+    // Segment of the client
+    size_t size = shm_seg_size(hello.depth);
+    int seg = memfd_create("polyinv", MFD_CLOEXEC);
+    if (seg < 0 || ftruncate(seg, size) < 0) {
+        shm_send(sock, &reply, sizeof(reply), NULL, 0);
+        close(sock);
+        if (seg >= 0) close(seg);
+        return -1;
+    }
+    shm_header_t *h = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, seg, 0);
+    if (h == MAP_FAILED) {
+        shm_send(sock, &reply, sizeof(reply), NULL, 0);
+        close(sock);
+        close(seg);
+        return -1;
+    }
+    h->magic = SHM_MAGIC;
+    h->depth = hello.depth;
+    munmap(h, size);
+
+    // Running shard of the fewest clients
+    int count[GF2X_SHM_MAX_WORKERS] = {0};
+    for (int j = 0; j < GF2X_SHM_MAX_CLIENTS; j++) {
+        if (d->client[j].sock >= 0) count[d->client[j].shard]++;
+    }
+    int w = -1;
+    for (int j = 0; j < d->num_workers; j++) {
+        if (d->pid[j] > 0 && (w < 0 || count[j] < count[w])) w = j;
+    }
+    if (w < 0) {
+        shm_send(sock, &reply, sizeof(reply), NULL, 0);
+        close(sock);
+        close(seg);
+        return -1;
+    }
+
+    d->client[k].sock = sock;
+    d->client[k].seg = seg;
+    d->client[k].shard = w;
+    d->client[k].depth = hello.depth;
+
+    shm_ctl_t msg = { .type = SHM_ADD, .id = k, .depth = hello.depth };
+    shm_send(d->ctl[w], &msg, sizeof(msg), &seg, 1);
+    shm_ring_bell(&d->bells[w]);
+
+    reply = (shm_reply_t) { .status = 0, .shard = w, .worker = d->pid[w], .depth = hello.depth };
+    int fds[2] = { seg, d->bells_fd };
+    shm_send(sock, &reply, sizeof(reply), fds, 2);
+    return k;
+}
+
+static void shm_drop(shm_daemon_t *d, int k) {
+    shm_client_t *c = &d->client[k];
+    shm_ctl_t msg = { .type = SHM_DEL, .id = k };
+    shm_send(d->ctl[c->shard], &msg, sizeof(msg), NULL, 0);
+    shm_ring_bell(&d->bells[c->shard]);
+
+    close(c->sock);
+    close(c->seg);
+    c->sock = -1;
+}
+
+// Serve ctx->p on the Unix socket path by num_workers processes, pinned 
+// to the NUMA nodes (numa) or to the CPUs, until SIGTERM or SIGINT
+int gf2x_shm_serve(
+    INPLACE ctx_t *ctx,
+    IN const char *path,
+    IN int num_workers,
+    IN int flags,
+    IN int numa
+) {
+    if (num_workers < 1) {
+        num_workers = 1;
+    }
+    if (num_workers > GF2X_SHM_MAX_WORKERS) {
+        num_workers = GF2X_SHM_MAX_WORKERS;
+    }
+
+    shm_daemon_t *d = calloc(1, sizeof(shm_daemon_t));
+    d->ctx = ctx;
+    d->flags = flags;
+    d->num_workers = num_workers;
+    for (int k = 0; k < GF2X_SHM_MAX_CLIENTS; k++) {
+        d->client[k].sock = -1;
+    }
+
+    // The plan (and its wisdom) is created once, before the workers
+    gf2x_plan_t *plan = gf2x_plan_create(ctx, flags);
+    if (plan == NULL) {
+        free(d);
+        return -1;
+    }
+    gf2x_plan_destroy(plan);
+
+    // Bells of the workers
+    d->bells_fd = memfd_create("polyinv-bells", MFD_CLOEXEC);
+    if (d->bells_fd < 0 || ftruncate(d->bells_fd, GF2X_SHM_MAX_WORKERS * sizeof(shm_bell_t)) < 0) {
+        if (d->bells_fd >= 0) close(d->bells_fd);
+        free(d);
+        return -1;
+    }
+    d->bells = mmap(NULL, GF2X_SHM_MAX_WORKERS * sizeof(shm_bell_t), PROT_READ | PROT_WRITE, 
+                    MAP_SHARED, d->bells_fd, 0);
+    if (d->bells == MAP_FAILED) {
+        close(d->bells_fd);
+        free(d);
+        return -1;
+    }
+
+    // Control socket
+    int lsock = d->lsock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    unlink(path);
+    if (lsock < 0 || bind(lsock, (struct sockaddr *) &addr, sizeof(addr)) < 0 || listen(lsock, 64) < 0) {
+        if (lsock >= 0) close(lsock);
+        munmap(d->bells, GF2X_SHM_MAX_WORKERS * sizeof(shm_bell_t));
+        close(d->bells_fd);
+        free(d);
+        return -1;
+    }
+
+    int ret = 0;
+    shm_stop = 0;
+    struct sigaction sa = { .sa_handler = shm_on_signal };
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGINT, &sa, NULL);
+
+    shm_pin_plan(d, numa);
+    for (int w = 0; w < num_workers; w++) {
+        shm_spawn(d, w);
+    }
+
+    struct pollfd pfd[1 + GF2X_SHM_MAX_CLIENTS];
+    while (!shm_stop) {
+        int n = 0;
+        pfd[n++] = (struct pollfd) { .fd = lsock, .events = POLLIN };
+        for (int k = 0; k < GF2X_SHM_MAX_CLIENTS; k++) {
+            pfd[n++] = (struct pollfd) { .fd = d->client[k].sock, .events = POLLIN };
+        }
+
+        if (poll(pfd, n, SHM_POLL_MS) > 0) {
+            if (pfd[0].revents & POLLIN) {
+                int sock = accept4(lsock, NULL, NULL, SOCK_CLOEXEC);
+                if (sock >= 0) shm_accept(d, sock);
+            }
+            // A client only closes its socket (i.e. EOF, or an error)
+            for (int k = 0; k < GF2X_SHM_MAX_CLIENTS; k++) {
+                if (d->client[k].sock >= 0 && pfd[1 + k].revents != 0) {
+                    shm_drop(d, k);
+                }
+            }
+        }
+
+        // Respawn the crashed workers
+        int status;
+        pid_t pid;
+        while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+            for (int w = 0; w < num_workers; w++) {
+                if (d->pid[w] != pid) {
+                    continue;
+                }
+                if (WIFEXITED(status) && WEXITSTATUS(status) == SHM_EXIT_PLAN) {
+                    d->pid[w] = 0;
+                    shm_stop = 1;
+                    ret = -1;
+                } else if (!shm_stop) {
+                    close(d->ctl[w]);
+                    shm_spawn(d, w);
+                }
+            }
+        }
+
+        // Retry the workers which could not be (re)started
+        for (int w = 0; w < num_workers && !shm_stop; w++) {
+            if (d->pid[w] == 0) shm_spawn(d, w);
+        }
+    }
+
+    for (int w = 0; w < num_workers; w++) {
+        if (d->pid[w] > 0) kill(d->pid[w], SIGTERM);
+        if (d->ctl[w] >= 0) close(d->ctl[w]);
+    }
+    for (int w = 0; w < num_workers; w++) {
+        if (d->pid[w] > 0) waitpid(d->pid[w], NULL, 0);
+    }
+    for (int k = 0; k < GF2X_SHM_MAX_CLIENTS; k++) {
+        if (d->client[k].sock >= 0) {
+            close(d->client[k].sock);
+            close(d->client[k].seg);
+        }
+    }
+    close(lsock);
+    unlink(path);
+    munmap(d->bells, GF2X_SHM_MAX_WORKERS * sizeof(shm_bell_t));
+    close(d->bells_fd);
+    free(d);
+    return ret;
+}
+
+/************************************
+ * CLIENTS
+ ************************************/
+
+struct gf2x_shm_client_s {
+    int             sock;
+    shm_header_t    *seg;
+    size_t          size;
+    shm_bell_t      *bell;      // of the worker of the shard
+    shm_bell_t      *bells;
+    int             shard;
+    int             worker;
+    uint32_t        depth;
+    int             inflight;
+    uint32_t        seq;        // of the last submission
+    uint32_t        *busy;      // seq of the slots in flight, or 0
+    poly_t          *view;      // views of the slots (dynamic polynomials)
+};
+
+// Client of at most depth requests in flight, or NULL
+gf2x_shm_client_t *gf2x_shm_connect(IN const char *path, IN int depth) {
+    int sock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    if (sock < 0 || connect(sock, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+        if (sock >= 0) close(sock);
+        return NULL;
+    }
+
+    shm_hello_t hello = { .magic = SHM_MAGIC, .ext_deg = EXT_DEG, 
+                          .poly_size = SHM_POLY_SIZE, .depth = depth };
+    shm_reply_t reply;
+    int fds[2];
+    if (shm_send(sock, &hello, sizeof(hello), NULL, 0) < 0 ||
+        shm_recv(sock, &reply, sizeof(reply), fds, 2, 0) != 2 || reply.status != 0) {
+        close(sock);
+        return NULL;
+    }
+
+    size_t size = shm_seg_size(reply.depth);
+    void *seg = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fds[0], 0);
+    void *bells = mmap(NULL, GF2X_SHM_MAX_WORKERS * sizeof(shm_bell_t), PROT_READ | PROT_WRITE, 
+                       MAP_SHARED, fds[1], 0);
+    close(fds[0]);
+    close(fds[1]);
+    if (seg == MAP_FAILED || bells == MAP_FAILED || 
+        reply.shard < 0 || reply.shard >= GF2X_SHM_MAX_WORKERS) {
+        if (seg != MAP_FAILED) munmap(seg, size);
+        if (bells != MAP_FAILED) munmap(bells, GF2X_SHM_MAX_WORKERS * sizeof(shm_bell_t));
+        close(sock);
+        return NULL;
+    }
+
+    gf2x_shm_client_t *c = calloc(1, sizeof(gf2x_shm_client_t));
+    c->sock = sock;
+    c->depth = reply.depth;
+    c->shard = reply.shard;
+    c->worker = reply.worker;
+    c->size = size;
+    c->seg = seg;
+    c->bells = bells;
+    c->bell = &c->bells[c->shard];
+
+    c->busy = calloc(c->depth, sizeof(uint32_t));
+    c->view = malloc(3 * c->depth * sizeof(poly_t));
+    return c;
+}
+
+void gf2x_shm_close(INPLACE gf2x_shm_client_t *c) {
+    if (c == NULL) {
+        return;
+    }
+    close(c->sock);
+    munmap(c->seg, c->size);
+    munmap(c->bells, GF2X_SHM_MAX_WORKERS * sizeof(shm_bell_t));
+    free(c->busy);
+    free(c->view);
+    free(c);
+}
+
+int gf2x_shm_depth(IN gf2x_shm_client_t *c) {
+    return c->depth;
+}
+
+// Pid of the worker process of the client
+int gf2x_shm_worker(IN gf2x_shm_client_t *c) {
+    return c->bell->pid;
+}
+
+// Polynomial a (0), b (1) or out (2) of a slot, in the shared memory
+poly_t *gf2x_shm_poly(INPLACE gf2x_shm_client_t *c, IN int slot, IN int which) {
+    assert(slot >= 0 && slot < (int) c->depth && which >= 0 && which < 3);
+    return shm_poly(c->seg, c->depth, slot, which, &c->view[3 * slot + which]);
+}
+
+// Submit the operation of a slot without blocking, i.e. 1, or 0 if the 
+// client is full (or the slot is in flight)
+int gf2x_shm_submit(
+    INPLACE gf2x_shm_client_t *c,
+    IN int op,
+    IN int slot,
+    IN uint64_t user_data
+) {
+    shm_header_t *h = c->seg;
+
+    if (c->inflight == (int) c->depth || slot < 0 || slot >= (int) c->depth || c->busy[slot]) {
+        return 0;
+    }
+
+    // Both rings hold the requests which are not reaped
+    uint32_t tail = atomic_load_explicit(&h->sq_tail, memory_order_relaxed);
+    if (tail - atomic_load_explicit(&h->cq_head, memory_order_relaxed) >= c->depth) {
+        return 0;
+    }
+
+    c->seq = (c->seq == UINT32_MAX) ? 1 : c->seq + 1;
+    gf2x_shm_cqe_t *e = &shm_sq(h)[tail % c->depth];
+    e->user_data = user_data;
+    e->op = op;
+    e->slot = slot;
+    e->seq = c->seq;
+    e->status = 0;
+    e->t_submit = shm_now();
+    e->t_done = 0;
+    atomic_store_explicit(&h->sq_tail, tail + 1, memory_order_release);
+
+    c->busy[slot] = c->seq;
+    c->inflight++;
+
+    atomic_fetch_add(&c->bell->seq, 1);
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load(&c->bell->sleeping)) {
+        futex_wake(&c->bell->seq);
+    }
+    return 1;
+}
+
+// At most max completions, waiting for one if wait is set (and a request
+// is in flight), and their number
+int gf2x_shm_reap(
+    INPLACE gf2x_shm_client_t *c,
+    OUT gf2x_shm_cqe_t *cqe,
+    IN int max,
+    IN int wait
+) {
+    shm_header_t *h = c->seg;
+    int n = 0;
+
+    for (;;) {
+        uint32_t head = atomic_load_explicit(&h->cq_head, memory_order_relaxed);
+        uint32_t tail = atomic_load_explicit(&h->cq_tail, memory_order_acquire);
+
+        while (head != tail && n < max) {
+            gf2x_shm_cqe_t e = shm_cq(h, c->depth)[head % c->depth];
+            head++;
+
+            // A completion of a slot which is not in flight is dropped
+            if (e.slot < c->depth && c->busy[e.slot] == e.seq) {
+                c->busy[e.slot] = 0;
+                c->inflight--;
+                cqe[n++] = e;
+            }
+        }
+        atomic_store_explicit(&h->cq_head, head, memory_order_release);
+
+        if (n > 0 || !wait || c->inflight == 0) {
+            return n;
+        }
+
+        atomic_store(&h->cq_waiting, 1);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (atomic_load(&h->cq_tail) == tail) {
+            futex_wait(&h->cq_tail, tail);
+        }
+        atomic_store(&h->cq_waiting, 0);
+    }
+}
+
+#else /* not Linux */
+
+int gf2x_shm_serve(INPLACE ctx_t *ctx, IN const char *path, IN int num_workers, IN int flags, IN int numa) {
+    (void) ctx; (void) path; (void) num_workers; (void) flags; (void) numa;
+    return -1;
+}
+
+gf2x_shm_client_t *gf2x_shm_connect(IN const char *path, IN int depth) {
+    (void) path; (void) depth;
+    return NULL;
+}
+
+void gf2x_shm_close(INPLACE gf2x_shm_client_t *c) {
+    (void) c;
+}
+
+int gf2x_shm_depth(IN gf2x_shm_client_t *c) {
+    (void) c;
+    return 0;
+}
+
+int gf2x_shm_worker(IN gf2x_shm_client_t *c) {
+    (void) c;
+    return -1;
+}
+
+poly_t *gf2x_shm_poly(INPLACE gf2x_shm_client_t *c, IN int slot, IN int which) {
+    (void) c; (void) slot; (void) which;
+    return NULL;
+}
+
+int gf2x_shm_submit(INPLACE gf2x_shm_client_t *c, IN int op, IN int slot, IN uint64_t user_data) {
+    (void) c; (void) op; (void) slot; (void) user_data;
+    return 0;
+}
+
+int gf2x_shm_reap(INPLACE gf2x_shm_client_t *c, OUT gf2x_shm_cqe_t *cqe, IN int max, IN int wait) {
+    (void) c; (void) cqe; (void) max; (void) wait;
+    return 0;
+}
+
+#endif
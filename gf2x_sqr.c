@@ -67,46 +67,150 @@
     #error "Unsupported architecture"
 #endif
 
+// Block squaring by depositing the bits of each 32-bit half on the
+// even bits, which is faster than PCLMULQDQ on some CPUs. PDEP is
+// microcoded, i.e. its time depends on the data, on AMD before Zen 3.
+#if defined(__BMI2__)
+#include <cpuid.h>
+    static inline void sqr64_pdep (
+        uint64_t *in,
+        uint64_t *out
+    ) {
+        PRINT_FUNCTION_NAME("sqr");
+        *(out + 0) = _pdep_u64(*in, 0x5555555555555555ULL);
+        *(out + 1) = _pdep_u64(*in >> 32, 0x5555555555555555ULL);
+    }
+#endif
+
+// Whether the block squaring kernel is available (and in constant time)
+int gf2x_sqr_kernel_ok(IN int kernel) {
+    if (kernel == GF2X_SQR_CLMUL) {
+        return 1;
+    }
+
+    #if defined(__BMI2__)
+    if (kernel == GF2X_SQR_PDEP) {
+        // Not ok if the vendor or the family cannot be read
+        unsigned int a, b, c, d;
+        if (!__get_cpuid(0, &a, &b, &c, &d)) {
+            return 0;
+        }
+        int amd = (b == 0x68747541);    // "Auth"enticAMD
+        if (!__get_cpuid(1, &a, &b, &c, &d)) {
+            return 0;
+        }
+        int family = ((a >> 8) & 0xf) + ((a >> 20) & 0xff);
+        return !amd || family >= 0x19;
+    }
+    #endif
+
+    return 0;
+}
+
+// Block squares of the n blocks of a by kernel, i.e. 2n blocks of out
+static inline void sqr_blocks(
+    IN  uint64_t *a,
+    IN  int n,
+    IN  int kernel,
+    OUT uint64_t *out
+) {
+    #if defined(__BMI2__)
+    if (kernel == GF2X_SQR_PDEP) {
+        for (int i = 0; i < n; i++) {
+            // Required for counting function call
+            PRINT_FUNCTION_NAME("sqr64");
+
+            sqr64_pdep(&a[i], &out[2*i]);
+        }
+        return;
+    }
+    #endif
+
+    for (int i = 0; i < n; i++) {
+        // Required for counting function call
+        PRINT_FUNCTION_NAME("sqr64");
 
-// Modular squarring 
+        sqr64(&a[i], &out[2*i]);
+    }
+}
+
+
+// tmp <- 0, of n blocks, in the scratch ws for dynamic polynomials (if any)
+static inline void sqr_tmp_init(OUT poly_t *tmp, IN int n, uint64_t *ws) {
+    #if !defined(USE_STATIC_POLY)
+    if (ws != NULL) {
+        tmp->deg = 64 * n - 1;
+        tmp->size64 = n;
+        tmp->data = ws;
+        gf2x_poly_zeroize(tmp);
+        return;
+    }
+    #endif
+    (void) ws;
+    gf2x_poly_init(tmp, 64 * n - 1);
+}
+
+static inline void sqr_tmp_free(INPLACE poly_t *tmp, uint64_t *ws) {
+    #if !defined(USE_STATIC_POLY)
+    if (ws != NULL) {
+        return;
+    }
+    #endif
+    (void) ws;
+    gf2x_poly_free(tmp);
+}
+
+
+// Modular squarring by the kernel of tune, in the scratch ws (or an allocated one)
 // Input : a <- polynomial of degree <= (EXT_DEG - 1)
 // Output: c <- a^2 mod (x^EXT_DEG - 1)
-void gf2x_mod_sqr(
+void gf2x_mod_sqr_tune(
+    IN  gf2x_tune_t *tune,
     IN  poly_t *a,
-    OUT poly_t *c
+    OUT poly_t *c,
+    uint64_t *ws
 ) {
     // Required for counting function call
     PRINT_FUNCTION_NAME("gf2x_mod_sqr");
 
-    // tmp <- 0
+    // tmp <- 0, of 2 * size64 blocks for the block squares, which may be
+    // one block more than for the degree 2 * (EXT_DEG - 1)
     poly_t tmp;
-    gf2x_poly_init(&tmp, 2 * (EXT_DEG - 1));
+    sqr_tmp_init(&tmp, 2 * a->size64, ws);
 
     // Block squaring
-    for (int i = 0; i < a->size64; i++) {
-        // Required for counting function call
-        PRINT_FUNCTION_NAME("sqr64");
-
-        sqr64(&a->data[i], &tmp.data[2*i]);
-    }
+    sqr_blocks(a->data, a->size64, tune->sqr_kernel, tmp.data);
 
     // c <- tmp mod (x^EXT_DEG - 1)
     gf2x_red(&tmp, c);
 
     // Free tmp
-    gf2x_poly_free(&tmp);
+    sqr_tmp_free(&tmp, ws);
 }
 
 
-// In-place repeatitive modular squarring 
+// Modular squarring
+// c <- a^2 mod (x^EXT_DEG - 1)
+void gf2x_mod_sqr(
+    IN  poly_t *a,
+    OUT poly_t *c
+) {
+    gf2x_mod_sqr_tune(&gf2x_tune, a, c, NULL);
+}
+
+
+// In-place repeatitive modular squarring by the kernel of tune,
+// in the scratch ws (or an allocated one)
 // c <- c^(2^k) mod (x^EXT_DEG - 1)
 // without calling "mod_sqr" function
-void gf2x_mod_sqr_k_inplace(
+void gf2x_mod_sqr_k_inplace_tune(
+    IN gf2x_tune_t *tune,
     INPLACE poly_t *c,
-    IN int k
+    IN int k,
+    uint64_t *ws
 ) {
     poly_t tmp;
-    gf2x_poly_init(&tmp, 2 * (EXT_DEG - 1));
+    sqr_tmp_init(&tmp, 2 * c->size64, ws);
 
     for(int j = 0; j < k; j++) {
         // Required for counting function call
@@ -116,17 +220,22 @@ void gf2x_mod_sqr_k_inplace(
         gf2x_poly_zeroize(&tmp);
 
         // Block Squarring
-        for (int i = 0; i < c->size64; i++) {
-            // Required for counting function call
-            PRINT_FUNCTION_NAME("sqr64");
-            
-            sqr64(&c->data[i], &tmp.data[2*i]);
-        }
+        sqr_blocks(c->data, c->size64, tune->sqr_kernel, tmp.data);
 
         // c <- tmp mod (x^EXT_DEG - 1)
         gf2x_red(&tmp, c);
     }
 
     // Free tmp
-    gf2x_poly_free(&tmp);
+    sqr_tmp_free(&tmp, ws);
+}
+
+
+// In-place repeatitive modular squarring 
+// c <- c^(2^k) mod (x^EXT_DEG - 1)
+void gf2x_mod_sqr_k_inplace(
+    INPLACE poly_t *c,
+    IN int k
+) {
+    gf2x_mod_sqr_k_inplace_tune(&gf2x_tune, c, k, NULL);
 }
@@ -25,13 +25,6 @@
 #ifndef PARAMS_H
 #define PARAMS_H
 
-#define BYI 1
-#define FLT 2
-#define CEA 3
-#define TYT 4
-#define SAC 5
-
-
 #if defined(EXT_DEG)
     #if EXT_DEG == 10499
         ctx_t ctx = { 
@@ -111,8 +104,12 @@
             .sac_C = {1,    2,    3,    5,   10,   11,   20},
             .sac_A = {    0,0,  0,1,  1,2,  3,3,  0,4,  4,4},
             };
+    // Any other prime, whose parameters are searched on the first 
+    // use of ctx (see gf2x_params.c and make gen_params)
     #else
-        #error "Invalid EXT_DEG value"
+        ctx_t ctx = { 
+            .p = EXT_DEG, 
+            };
     #endif
 #else
     #error "EXT_DEG not defined"    
@@ -0,0 +1,353 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Emrah Karagoz, Pakize Sanal, Abhraneel Dutta, Edoardo Persichetti
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "gf2x.h"
+#include "params.h"
+
+/*********************************************************
+ * Batch inversions of files of packed polynomials, e.g.
+ *     ./polyinv_P12323 --gen 100000 corpus.bin
+ *     ./polyinv_P12323 -t 8 --verify corpus.bin inverses.bin
+ *
+ * A file is a sequence of records of ceil(r/8) bytes, each a
+ * polynomial of degree < r whose coefficient of x^i is the bit 
+ * i % 8 of the byte i / 8 (the BIKE format, little-endian), and 
+ * whose bits from r on are zero (see gf2x_codec.c).
+ *
+ * Both files are mapped. Each thread takes the chunks of
+ * POLYINV_CHUNK records in turn, and runs the stages
+ *     validation   the padding is zero and g(1) = 1, since an even 
+ *                  g is divisible by x + 1, i.e. not invertible
+ *     inversion    the valid records of the chunk together, by 
+ *                  Montgomery's trick in the scratch of its plan
+ *     verification g * g^-1 = 1 (--verify)
+ * on its own polynomials, and packs the inverses straight into 
+ * the output mapping. A record which is invalid, not invertible or
+ * not verified gives a zero record.
+**********************************************************/
+
+#define POLYINV_CHUNK       (16)
+#define POLYINV_MAX_THREADS (256)
+
+#define RECORD_BYTES        GF2X_PACKED_BYTES
+
+typedef struct {
+    gf2x_plan_t     *plan;
+    pthread_t       thread;
+    long            invalid;
+    long            singular;       // valid, but not invertible
+    long            unverified;
+} job_thread_t;
+
+typedef struct {
+    const uint8_t   *in;
+    uint8_t         *out;
+    long            num;            // records
+    int             verify;
+    _Atomic long    next;           // first record not taken by a thread
+} job_t;
+
+static job_t job;
+
+
+static double wall_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+static int is_one(poly_t *a) {
+    uint64_t acc = a->data[0] ^ 1;
+    for (int i = 1; i < a->size64; i++) {
+        acc |= a->data[i];
+    }
+    return acc == 0;
+}
+
+
+static int is_zero(poly_t *a) {
+    uint64_t acc = 0;
+    for (int i = 0; i < a->size64; i++) {
+        acc |= a->data[i];
+    }
+    return acc == 0;
+}
+
+
+static void *job_run(void *arg) {
+    job_thread_t *t = arg;
+
+    poly_t g[POLYINV_CHUNK], ginv[POLYINV_CHUNK], tmp;
+    for (int k = 0; k < POLYINV_CHUNK; k++) {
+        gf2x_poly_init(&g[k], EXT_DEG - 1);
+        gf2x_poly_init(&ginv[k], EXT_DEG - 1);
+    }
+    gf2x_poly_init(&tmp, EXT_DEG - 1);
+
+    for (;;) {
+        long first = atomic_fetch_add(&job.next, POLYINV_CHUNK);
+        if (first >= job.num) {
+            break;
+        }
+        int n = (job.num - first < POLYINV_CHUNK) ? (int) (job.num - first) : POLYINV_CHUNK;
+
+        // Validation, and the valid records at the front (their indices in idx)
+        int idx[POLYINV_CHUNK], m = 0;
+        for (int k = 0; k < n; k++) {
+            const uint8_t *rec = job.in + (first + k) * RECORD_BYTES;
+            if (gf2x_poly_unpack(&g[m], rec)) {
+                int weight = 0;
+                for (int i = 0; i < NUM_BLOCKS; i++) {
+                    weight += count_ones(g[m].data[i]);
+                }
+                if (weight & 1) {
+                    idx[m++] = k;
+                    continue;
+                }
+            }
+            t->invalid++;
+            memset(job.out + (first + k) * RECORD_BYTES, 0, RECORD_BYTES);
+        }
+
+        // Inversion (zero for the non-invertible ones)
+        if (m > 0) {
+            t->singular += m - gf2x_mod_inv_batch_plan(t->plan, m, g, ginv);
+        }
+
+        // Verification, and the output
+        for (int k = 0; k < m; k++) {
+            if (job.verify && !is_zero(&ginv[k])) {
+                gf2x_mod_mul(&g[k], &ginv[k], &tmp);
+                if (!is_one(&tmp)) {
+                    t->unverified++;
+                    gf2x_poly_zeroize(&ginv[k]);
+                }
+            }
+            gf2x_poly_pack(&ginv[k], job.out + (first + idx[k]) * RECORD_BYTES);
+        }
+    }
+
+    for (int k = 0; k < POLYINV_CHUNK; k++) {
+        gf2x_poly_free(&g[k]);
+        gf2x_poly_free(&ginv[k]);
+    }
+    gf2x_poly_free(&tmp);
+    return NULL;
+}
+
+
+// Mapping of a file of size bytes (created for the output), or NULL
+static void *map_file(const char *path, size_t *size, int output) {
+    int fd = output ? open(path, O_RDWR | O_CREAT | O_TRUNC, 0644) : open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat st;
+    if (output) {
+        if (ftruncate(fd, *size) < 0) {
+            close(fd);
+            return NULL;
+        }
+    } else if (fstat(fd, &st) == 0) {
+        *size = st.st_size;
+    } else {
+        close(fd);
+        return NULL;
+    }
+
+    // An empty file is not mapped
+    void *p = (*size > 0) ? mmap(NULL, *size, output ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0)
+                          : (void *) "";
+    close(fd);
+    if (p == MAP_FAILED) {
+        return NULL;
+    }
+    if (!output && *size > 0) {
+        madvise(p, *size, MADV_SEQUENTIAL);
+    }
+    return p;
+}
+
+
+static void unmap_file(void *p, size_t size) {
+    if (size > 0) {
+        munmap(p, size);
+    }
+}
+
+
+// num random records of g(1) = 1 (by rand(), i.e. test corpora only)
+static int generate(const char *path, long num) {
+    size_t size = num * RECORD_BYTES;
+    uint8_t *out = map_file(path, &size, 1);
+    if (out == NULL) {
+        return 1;
+    }
+
+    poly_t g;
+    gf2x_poly_init(&g, EXT_DEG - 1);
+    srand(time(NULL));
+    for (long j = 0; j < num; j++) {
+        gf2x_poly_random_coprime(&g);
+        gf2x_poly_pack(&g, out + j * RECORD_BYTES);
+    }
+    gf2x_poly_free(&g);
+
+    unmap_file(out, size);
+    printf("Generated %ld records of %d bytes in %s\n", num, RECORD_BYTES, path);
+    return 0;
+}
+
+
+static void usage(char *name) {
+    printf("Usage: %s [-t threads] [--verify] [--measure] input output\n", name);
+    printf("       %s --gen num output\n", name);
+    printf("  Records of %d bytes, i.e. polynomials of degree < %d (little-endian)\n", RECORD_BYTES, EXT_DEG);
+    printf("  -t threads  : number of threads (default: the CPUs)\n");
+    printf("  --verify    : check g * g^-1 = 1 for each record\n");
+    printf("  --measure   : measure the plan of the threads, instead of estimating it\n");
+    printf("  --gen num   : write num random invertible records (test corpora)\n");
+}
+
+
+int main(int argc, char *argv[])
+{
+    long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int num_threads = (num_cpus > 0) ? (int) num_cpus : 1;
+    int flags = GF2X_PLAN_ESTIMATE;
+    long gen = -1;
+    char *path[2];
+    int num_paths = 0;
+
+    job.verify = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            num_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--verify") == 0) {
+            job.verify = 1;
+        } else if (strcmp(argv[i], "--measure") == 0) {
+            flags = GF2X_PLAN_MEASURE;
+        } else if (strcmp(argv[i], "--gen") == 0 && i + 1 < argc) {
+            gen = atol(argv[++i]);
+        } else if (argv[i][0] != '-' && num_paths < 2) {
+            path[num_paths++] = argv[i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (gen >= 0 && num_paths == 1) {
+        return generate(path[0], gen);
+    }
+    if (gen >= 0 || num_paths != 2 || num_threads < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+    num_threads = (num_threads < POLYINV_MAX_THREADS) ? num_threads : POLYINV_MAX_THREADS;
+
+    // The mappings
+    size_t in_size = 0;
+    const uint8_t *in = map_file(path[0], &in_size, 0);
+    if (in == NULL || in_size % RECORD_BYTES != 0) {
+        fprintf(stderr, "%s: %s is not a file of %d-byte records\n", argv[0], path[0], RECORD_BYTES);
+        return 1;
+    }
+    size_t out_size = in_size;
+    uint8_t *out = map_file(path[1], &out_size, 1);
+    if (out == NULL) {
+        fprintf(stderr, "%s: cannot write %s\n", argv[0], path[1]);
+        return 1;
+    }
+
+    job.in = in;
+    job.out = out;
+    job.num = in_size / RECORD_BYTES;
+    atomic_store(&job.next, 0);
+
+    // The plans are created before the threads (see gf2x_plan_create)
+    job_thread_t *t = calloc(num_threads, sizeof(job_thread_t));
+    for (int k = 0; k < num_threads; k++) {
+        t[k].plan = gf2x_plan_create(&ctx, flags | GF2X_PLAN_WORKER);
+        if (t[k].plan == NULL) {
+            fprintf(stderr, "%s: cannot create the plan of thread %d\n", argv[0], k);
+            for (int j = 0; j < k; j++) {
+                gf2x_plan_destroy(t[j].plan);
+            }
+            free(t);
+            unmap_file((void *) in, in_size);
+            unmap_file(out, out_size);
+            return 1;
+        }
+    }
+
+    double start = wall_time();
+    for (int k = 0; k < num_threads; k++) {
+        pthread_create(&t[k].thread, NULL, job_run, &t[k]);
+    }
+    long invalid = 0, singular = 0, unverified = 0;
+    for (int k = 0; k < num_threads; k++) {
+        pthread_join(t[k].thread, NULL);
+        invalid += t[k].invalid;
+        singular += t[k].singular;
+        unverified += t[k].unverified;
+    }
+    double time = wall_time() - start;
+
+    unmap_file((void *) in, in_size);
+    unmap_file(out, out_size);
+
+    printf("Inverted %s into %s:\n", path[0], path[1]);
+    printf("  EXT_DEG       : %d\n", EXT_DEG);
+    printf("  METHOD        : %s\n", gf2x_inv_name(t[0].plan->inv_method));
+    printf("  NUM_THREADS   : %d\n", num_threads);
+    printf("  RECORDS       : %ld\n", job.num);
+    printf("  INVALID       : %ld\n", invalid);
+    printf("  SINGULAR      : %ld\n", singular);
+    if (job.verify) {
+        printf("  UNVERIFIED    : %ld\n", unverified);
+    }
+    printf("  INV / SEC     : %.1f\n", (time > 0) ? job.num / time : 0.0);
+
+    for (int k = 0; k < num_threads; k++) {
+        gf2x_plan_destroy(t[k].plan);
+    }
+    free(t);
+
+    return (unverified > 0) ? 2 : 0;
+}
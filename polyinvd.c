@@ -0,0 +1,81 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Emrah Karagoz, Pakize Sanal, Abhraneel Dutta, Edoardo Persichetti
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "gf2x.h"
+#include "params.h"
+
+// Inversion daemon of EXT_DEG (see gf2x_shm.c), e.g.
+//     ./polyinvd_P12323 -s /tmp/polyinv.sock -w 4 --numa
+static void usage(char *name) {
+    printf("Usage: %s [-s socket] [-w workers] [--numa] [--measure]\n", name);
+    printf("  -s socket   : path of the Unix socket (default /tmp/polyinv_P%d.sock)\n", EXT_DEG);
+    printf("  -w workers  : number of worker processes (default: the CPUs)\n");
+    printf("  --numa      : pin each worker to a NUMA node, instead of a CPU\n");
+    printf("  --measure   : measure the plan of the workers, instead of estimating it\n");
+}
+
+
+int main(int argc, char *argv[])
+{
+    char path[108];
+    snprintf(path, sizeof(path), "/tmp/polyinv_P%d.sock", EXT_DEG);
+
+    long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int num_workers = (num_cpus > 0) ? (int) num_cpus : 1;
+    int numa = 0;
+    int flags = GF2X_PLAN_ESTIMATE;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            snprintf(path, sizeof(path), "%s", argv[++i]);
+        } else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+            num_workers = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--numa") == 0) {
+            numa = 1;
+        } else if (strcmp(argv[i], "--measure") == 0) {
+            flags = GF2X_PLAN_MEASURE;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    printf("Serving on %s:\n", path);
+    printf("  EXT_DEG       : %d\n", EXT_DEG);
+    printf("  NUM_WORKERS   : %d\n", num_workers);
+    printf("  PINNING       : %s\n", numa ? "NUMA nodes" : "CPUs");
+    fflush(stdout);
+
+    if (gf2x_shm_serve(&ctx, path, num_workers, flags, numa) != 0) {
+        fprintf(stderr, "%s: cannot serve on %s\n", argv[0], path);
+        return 1;
+    }
+    return 0;
+}
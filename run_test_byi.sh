@@ -0,0 +1,14 @@
+#!/bin/bash
+
+# List of Extension Degrees
+EXT_DEGS=("10499" "12323" "24659" "24781" "27067" "27581" "40973")
+
+# Clean the previous executables
+echo "Cleaning the previous executables (test_byi_P*)..."
+rm -f test_byi_P* 
+
+for EXT_DEG in "${EXT_DEGS[@]}"
+do    
+    echo "Running make test_byi with EXT_DEG=${EXT_DEG} for BYI"
+    make test_byi EXT_DEG=${EXT_DEG} INVERSE_METHOD=BYI
+done
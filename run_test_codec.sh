@@ -0,0 +1,13 @@
+#!/bin/bash
+
+EXT_DEGS=("10499" "12323" "24659" "24781" "27067" "27581" "40973")
+
+# Clean the previous executables
+echo "Cleaning the previous executables (test_codec_P*)..."
+rm -f test_codec_P* 
+
+for EXT_DEG in "${EXT_DEGS[@]}"
+do
+    echo "Running make test_codec with EXT_DEG=${EXT_DEG}"
+    make test_codec EXT_DEG=${EXT_DEG}
+done
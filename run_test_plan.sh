@@ -0,0 +1,13 @@
+#!/bin/bash
+
+EXT_DEGS=("10499" "12323" "24659" "24781" "27067" "27581" "40973")
+
+# Clean the previous executables
+echo "Cleaning the previous executables (test_plan_P*)..."
+rm -f test_plan_P* 
+
+for EXT_DEG in "${EXT_DEGS[@]}"
+do
+    echo "Running make test_plan with EXT_DEG=${EXT_DEG}"
+    make test_plan EXT_DEG=${EXT_DEG}
+done
@@ -0,0 +1,13 @@
+#!/bin/bash
+
+EXT_DEGS=("10499" "12323" "24659" "24781" "27067" "27581" "40973")
+
+# Clean the previous executables
+echo "Cleaning the previous executables (test_shm_P*)..."
+rm -f test_shm_P* 
+
+for EXT_DEG in "${EXT_DEGS[@]}"
+do
+    echo "Running make test_shm with EXT_DEG=${EXT_DEG}"
+    make test_shm EXT_DEG=${EXT_DEG}
+done
@@ -0,0 +1,168 @@
+/* 
+ * MIT License
+ *
+ * Copyright (c) 2024 Emrah Karagoz, Pakize Sanal, Abhraneel Dutta, Edoardo Persichetti
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+
+#include "gf2x.h"
+#include "params.h"
+
+/*********************************************************
+ * Verification of the number of divsteps in BYI
+ * 
+ * For random g, the plain (variable-time) divsteps on 
+ * f = x^p - 1 and g find the last divstep that swaps f and g,
+ * after which the inverse does not change anymore. Then
+ *  - BYI with BYI_DIVSTEPS(p) divsteps is correct,
+ *  - BYI with that last divstep is correct, and
+ *  - BYI with one fewer divstep is not,
+ * and the maximum of the last divsteps is reported, 
+ * which is at most BYI_DIVSTEPS(p).
+**********************************************************/
+
+#if !defined(TEST_BYI_NUM_TESTS)
+    #define TEST_BYI_NUM_TESTS  (100)
+#endif
+
+
+static int isOnePoly(poly_t *a) {
+    if (a->data[0] != 1) return 0;
+
+    for (int i = 1; i < a->size64; i++) {
+        if (a->data[i] != 0) return 0;
+    }
+
+    return 1;
+}
+
+
+// The last divstep that swaps f and g, on f = x^p - 1 
+// and g.reverse(p-1), i.e. the inputs of BYI
+static int last_swap(poly_t *g) {
+    int p = EXT_DEG;
+    int s = (p + 1 + 63) / 64;
+
+    uint64_t *f  = calloc(s, sizeof(uint64_t));
+    uint64_t *gr = calloc(s, sizeof(uint64_t));
+    f[p / 64] |= 1ULL << (p % 64);
+    f[0] |= 1;
+    for (int i = 0; i < p; i++) {
+        if (gf2x_poly_getcoef(g, p - 1 - i)) {
+            gr[i / 64] |= 1ULL << (i % 64);
+        }
+    }
+
+    int delta = 1, last = 0, nonzero = 1;
+    for (int i = 0; nonzero; i++) {
+        if (delta > 0 && (gr[0] & 1)) {
+            uint64_t *t = f; f = gr; gr = t;
+            delta = -delta;
+            last = i + 1;
+        }
+        delta += 1;
+
+        // g <- (g + g0 * f) / x
+        uint64_t m = 0 - (gr[0] & 1);
+        nonzero = 0;
+        for (int k = 0; k < s; k++) {
+            uint64_t hi = (k + 1 < s) ? ((gr[k + 1] ^ (m & f[k + 1])) << 63) : 0;
+            gr[k] = ((gr[k] ^ (m & f[k])) >> 1) | hi;
+            nonzero |= (gr[k] != 0);
+        }
+    }
+
+    free(f);
+    free(gr);
+
+    return last;
+}
+
+
+int main(void)
+{
+    // Print the test info
+    printf("Testing BYI Divsteps:\n");
+    printf("  EXT_DEG       : %d\n", EXT_DEG);
+    printf("  BYI_DIVSTEPS  : %d\n", BYI_DIVSTEPS(EXT_DEG));
+    printf("  NUM_TESTS     : %d\n", TEST_BYI_NUM_TESTS);
+
+    // Variables
+    int p = EXT_DEG;
+
+    poly_t g, ginv, tmp;
+    gf2x_poly_init(&g, p-1);
+    gf2x_poly_init(&ginv, p-1);
+    gf2x_poly_init(&tmp, p-1);
+
+    int correct_full = 0;
+    int correct_last = 0;
+    int wrong_before = 0;
+    int max_last = 0;
+    int num_at_bound = 0;
+
+    // Required for randomization
+    srand(time(NULL));
+
+    for (int i = 0; i < TEST_BYI_NUM_TESTS; i++) {
+        // Choose a random input
+        gf2x_poly_random_coprime(&g);
+
+        int last = last_swap(&g);
+        if (last > max_last) max_last = last;
+        if (last == BYI_DIVSTEPS(p)) num_at_bound++;
+
+        // BYI_DIVSTEPS(p) divsteps
+        gf2x_mod_inv_byi(&ctx, &g, &ginv);
+        gf2x_mod_mul(&g, &ginv, &tmp);
+        if (isOnePoly(&tmp)) correct_full++;
+
+        // Up to the last swap
+        gf2x_mod_inv_byi_steps(&ctx, last, &g, &ginv);
+        gf2x_mod_mul(&g, &ginv, &tmp);
+        if (isOnePoly(&tmp)) correct_last++;
+
+        // One fewer divstep
+        gf2x_mod_inv_byi_steps(&ctx, last - 1, &g, &ginv);
+        gf2x_mod_mul(&g, &ginv, &tmp);
+        if (!isOnePoly(&tmp)) wrong_before++;
+    }
+
+    // Print the results
+    printf("\nResults (Number of Inputs / Number of Tests):\n");
+    printf("  Correct with BYI_DIVSTEPS         : %d / %d \n", correct_full, TEST_BYI_NUM_TESTS);
+    printf("  Correct up to the last swap       : %d / %d \n", correct_last, TEST_BYI_NUM_TESTS);
+    printf("  Wrong before the last swap        : %d / %d \n", wrong_before, TEST_BYI_NUM_TESTS);
+    printf("  Last swap at BYI_DIVSTEPS         : %d / %d \n", num_at_bound, TEST_BYI_NUM_TESTS);
+    printf("  Maximum last swap                 : %d (BYI_DIVSTEPS = %d)\n", max_last, BYI_DIVSTEPS(p));
+    printf("\n\n");
+
+    gf2x_poly_free(&g);
+    gf2x_poly_free(&ginv);
+    gf2x_poly_free(&tmp);
+
+    return (correct_full == TEST_BYI_NUM_TESTS && max_last <= BYI_DIVSTEPS(p)) ? 0 : 1;
+}
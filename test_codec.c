@@ -0,0 +1,252 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Emrah Karagoz, Pakize Sanal, Abhraneel Dutta, Edoardo Persichetti
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <ctype.h>
+#include <time.h>
+
+#include "gf2x.h"
+#include "params.h"
+
+// Number of Tests
+#define TEST_CODEC_NUM_TESTS    (100)
+
+// Bytes of the tests of the hex codecs, and of the benchmarks
+#define TEST_CODEC_MAX_BYTES    (256)
+#define TEST_CODEC_BENCH_BYTES  (1 << 20)
+#define TEST_CODEC_BENCH_REPS   (16)
+
+
+static int isEqualPoly(poly_t *a, poly_t *b) {
+    for (int i = 0; i < a->size64; i++) {
+        if (a->data[i] != b->data[i]) return 0;
+    }
+    return 1;
+}
+
+
+static double wall_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+// The packed form, by the coefficients
+static void pack_ref(poly_t *f, uint8_t *bytes) {
+    memset(bytes, 0, GF2X_PACKED_BYTES);
+    for (int i = 0; i < EXT_DEG; i++) {
+        bytes[i / 8] |= gf2x_poly_getcoef(f, i) << (i % 8);
+    }
+}
+
+
+static void hex_encode_ref(const uint8_t *in, size_t n, char *hex) {
+    for (size_t j = 0; j < n; j++) {
+        snprintf(hex + 2 * j, 3, "%02x", in[j]);
+    }
+}
+
+
+static int hex_decode_ref(const char *hex, size_t n, uint8_t *out) {
+    for (size_t j = 0; j < n; j++) {
+        unsigned v;
+        char digits[3] = { hex[2 * j], hex[2 * j + 1], 0 };
+        if (strspn(digits, "0123456789abcdefABCDEF") != 2 || sscanf(digits, "%2x", &v) != 1) return 0;
+        out[j] = (uint8_t) v;
+    }
+    return 1;
+}
+
+
+void print_table_row(char *name, double bytes, double time) {
+    printf("| %-15d | %-15s | %-15.3f |\n", EXT_DEG, name, bytes / time / 1e9);
+    printf("+-----------------+-----------------+-----------------+\n");
+}
+
+
+int main(void)
+{
+    // Print the test info
+    printf("Testing Codecs:\n");
+    printf("  EXT_DEG       : %d\n", EXT_DEG);
+    printf("  NUM_BLOCKS    : %d\n", NUM_BLOCKS);
+    printf("  PACKED_BYTES  : %d\n", GF2X_PACKED_BYTES);
+    printf("  NUM_TESTS     : %d\n", TEST_CODEC_NUM_TESTS);
+
+    // Variables
+    poly_t f, g;
+    gf2x_poly_init(&f, EXT_DEG-1);
+    gf2x_poly_init(&g, EXT_DEG-1);
+
+    uint8_t bytes[GF2X_PACKED_BYTES], ref[GF2X_PACKED_BYTES];
+    char hex[GF2X_HEX_CHARS + 1];
+    uint8_t in[TEST_CODEC_MAX_BYTES], out[TEST_CODEC_MAX_BYTES];
+    char hex_in[2 * TEST_CODEC_MAX_BYTES + 1], hex_ref[2 * TEST_CODEC_MAX_BYTES + 1];
+
+    // Required for randomization
+    srand(time(NULL));
+
+    // Packed form, and a padding bit (if any)
+    int correct_pack = 0, correct_pad = 0;
+    for (int i = 0; i < TEST_CODEC_NUM_TESTS; i++) {
+        gf2x_poly_random(&f);
+        gf2x_poly_pack(&f, bytes);
+        pack_ref(&f, ref);
+        if (memcmp(bytes, ref, GF2X_PACKED_BYTES) == 0 && gf2x_poly_unpack(&g, bytes) && isEqualPoly(&f, &g)) {
+            correct_pack++;
+        }
+
+        if (EXT_DEG % 8 != 0) {
+            bytes[GF2X_PACKED_BYTES - 1] |= 0x80;
+            if (!gf2x_poly_unpack(&g, bytes) && isEqualPoly(&f, &g)) correct_pad++;
+        } else {
+            correct_pad++;
+        }
+    }
+
+    // Hex codecs of any length and case, and an invalid digit
+    int correct_hex = 0, correct_invalid = 0;
+    static const char invalid[] = { 'g', 'G', '/', ':', '@', '`', ' ', '\0', (char) 0x80, (char) 0xb0 };
+    for (int i = 0; i < TEST_CODEC_NUM_TESTS; i++) {
+        size_t n = 1 + rand() % TEST_CODEC_MAX_BYTES;
+        for (size_t j = 0; j < n; j++) {
+            in[j] = (uint8_t) rand();
+        }
+
+        gf2x_hex_encode(in, n, hex_in);
+        hex_encode_ref(in, n, hex_ref);
+        int ok = (memcmp(hex_in, hex_ref, 2 * n) == 0);
+
+        for (size_t j = 0; j < 2 * n; j++) {
+            if (rand() & 1) hex_in[j] = (char) toupper((unsigned char) hex_in[j]);
+        }
+        if (ok && gf2x_hex_decode(hex_in, n, out) && memcmp(in, out, n) == 0) {
+            correct_hex++;
+        }
+
+        hex_in[rand() % (2 * n)] = invalid[rand() % sizeof(invalid)];
+        if (!gf2x_hex_decode(hex_in, n, out) && !hex_decode_ref(hex_in, n, out)) {
+            correct_invalid++;
+        }
+    }
+
+    // Hex form of polynomials, and of 1 + x^9
+    int correct_poly = 0;
+    for (int i = 0; i < TEST_CODEC_NUM_TESTS; i++) {
+        gf2x_poly_random(&f);
+        gf2x_poly_to_hex(&f, hex);
+        if (strlen(hex) == GF2X_HEX_CHARS && gf2x_poly_from_hex(&g, hex) && isEqualPoly(&f, &g)) {
+            correct_poly++;
+        }
+    }
+    gf2x_poly_zeroize(&f);
+    gf2x_poly_setcoef(&f, 0, 1);
+    gf2x_poly_setcoef(&f, 9, 1);
+    gf2x_poly_to_hex(&f, hex);
+    int correct_vector = (strncmp(hex, "0102", 4) == 0 && strspn(hex + 4, "0") == GF2X_HEX_CHARS - 4);
+
+    printf("\nResults (Number of Correct Computations / Number of Tests):\n");
+    printf("  PACK : %d / %d \n", correct_pack, TEST_CODEC_NUM_TESTS);
+    printf("  PADDING : %d / %d \n", correct_pad, TEST_CODEC_NUM_TESTS);
+    printf("  HEX : %d / %d \n", correct_hex, TEST_CODEC_NUM_TESTS);
+    printf("  INVALID : %d / %d \n", correct_invalid, TEST_CODEC_NUM_TESTS);
+    printf("  POLY HEX : %d / %d \n", correct_poly, TEST_CODEC_NUM_TESTS);
+    printf("  VECTOR : %d / %d \n", correct_vector, 1);
+
+    // Throughput of the codecs (of the packed bytes), and of printf and sscanf
+    int reps = TEST_CODEC_BENCH_BYTES / GF2X_PACKED_BYTES + 1;
+    double total = (double) reps * GF2X_PACKED_BYTES;
+    uint8_t *big = malloc(TEST_CODEC_BENCH_BYTES);
+    char *big_hex = malloc(2 * TEST_CODEC_BENCH_BYTES);
+    for (int j = 0; j < TEST_CODEC_BENCH_BYTES; j++) {
+        big[j] = (uint8_t) rand();
+    }
+    gf2x_poly_random(&f);
+
+    printf("\n");
+    printf("+-----------------+-----------------+-----------------+\n");
+    printf("|     Ext Deg     |      Codec      |  GB/s (packed)  |\n");
+    printf("+-----------------+-----------------+-----------------+\n");
+
+    double t = wall_time();
+    for (int i = 0; i < reps; i++) {
+        gf2x_poly_pack(&f, bytes);
+        f.data[0] ^= bytes[i % GF2X_PACKED_BYTES];
+    }
+    print_table_row("pack", total, wall_time() - t);
+
+    t = wall_time();
+    for (int i = 0; i < reps; i++) {
+        gf2x_poly_unpack(&f, bytes);
+        bytes[0] ^= (uint8_t) f.data[i % NUM_BLOCKS];
+    }
+    print_table_row("unpack", total, wall_time() - t);
+
+    // The buffers are touched first, and coded TEST_CODEC_BENCH_REPS times
+    gf2x_hex_encode(big, TEST_CODEC_BENCH_BYTES, big_hex);
+    t = wall_time();
+    for (int i = 0; i < TEST_CODEC_BENCH_REPS; i++) {
+        gf2x_hex_encode(big, TEST_CODEC_BENCH_BYTES, big_hex);
+    }
+    print_table_row("hex encode", (double) TEST_CODEC_BENCH_REPS * TEST_CODEC_BENCH_BYTES, wall_time() - t);
+
+    int ok = 1;
+    t = wall_time();
+    for (int i = 0; i < TEST_CODEC_BENCH_REPS; i++) {
+        ok &= gf2x_hex_decode(big_hex, TEST_CODEC_BENCH_BYTES, big);
+    }
+    print_table_row(ok ? "hex decode" : "hex decode (!)", (double) TEST_CODEC_BENCH_REPS * TEST_CODEC_BENCH_BYTES, wall_time() - t);
+
+    t = wall_time();
+    for (int i = 0; i < reps; i++) {
+        gf2x_poly_to_hex(&f, hex);
+    }
+    print_table_row("poly to hex", total, wall_time() - t);
+
+    t = wall_time();
+    for (int i = 0; i < reps; i++) {
+        gf2x_poly_from_hex(&f, hex);
+    }
+    print_table_row("poly from hex", total, wall_time() - t);
+
+    t = wall_time();
+    hex_encode_ref(big, TEST_CODEC_BENCH_BYTES / 16, big_hex);
+    print_table_row("printf", TEST_CODEC_BENCH_BYTES / 16, wall_time() - t);
+
+    t = wall_time();
+    hex_decode_ref(big_hex, TEST_CODEC_BENCH_BYTES / 16, big);
+    print_table_row("sscanf", TEST_CODEC_BENCH_BYTES / 16, wall_time() - t);
+
+    free(big);
+    free(big_hex);
+    gf2x_poly_free(&f);
+    gf2x_poly_free(&g);
+
+    return 0;
+}
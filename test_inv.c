@@ -28,22 +28,30 @@
 #include <assert.h>
 #include <time.h>
 
+#include "bench.h"
 #include "gf2x.h"
 #include "params.h"
 
-#if defined(USE_STATIC_POLY)
-    #define TEST_INV_BYI    0
-    #define TEST_INV_FLT    1
-    #define TEST_INV_CEA    1
-    #define TEST_INV_TYT    1
-    #define TEST_INV_SAC    1
-#else
-    #define TEST_INV_BYI    1
-    #define TEST_INV_FLT    0
-    #define TEST_INV_CEA    0
-    #define TEST_INV_TYT    0
-    #define TEST_INV_SAC    0
-#endif
+// All the algorithms are built with both static and dynamic polynomials
+#define TEST_INV_BYI    1
+#define TEST_INV_EEA    1
+#define TEST_INV_FLT    1
+#define TEST_INV_CEA    1
+#define TEST_INV_TYT    1
+#define TEST_INV_SAC    1
+#define TEST_INV_AUTO   1
+#define TEST_INV_STEP   1
+#define TEST_INV_BATCH  1
+#define TEST_INV_LANES  1
+
+// Size of the batches, where the last two inputs are not invertible
+#define TEST_INV_BATCH_SIZE     (8)
+
+// Number of inputs inverted in the lanes, i.e. with a partial last group
+#define TEST_INV_LANES_SIZE     (2 * GF2X_BYI_LANES + 1)
+
+// Budget of each slice of the resumable inversions (in cycles)
+#define TEST_INV_STEP_BUDGET    (1000000ULL)
 
 
 static int isZeroPoly(poly_t *a) {
@@ -65,6 +73,14 @@ static int isOnePoly(poly_t *a) {
 }
 
 
+static int isEqualPoly(poly_t *a, poly_t *b) {
+    for (int i = 0; i < a->size64; i++) {
+        if (a->data[i] != b->data[i]) return 0;
+    }
+    return 1;
+}
+
+
 int main(void)
 {
     // Print the test info
@@ -89,12 +105,33 @@ int main(void)
     poly_t tmp;
     gf2x_poly_init(&tmp, p-1);
 
+    // Dividend h for testing the division h * g^-1
+    poly_t h;
+    gf2x_poly_init(&h, p-1);
+
     // Number of correct inversion computations 
     int correct_byi = 0;
+    int correct_eea = 0;
     int correct_flt = 0;
     int correct_cea = 0;
     int correct_tyt = 0;
     int correct_sac = 0;
+    int correct_byi_div = 0;
+    int correct_eea_div = 0;
+    int correct_eea_singular = 0;
+    int correct_flt_div = 0;
+    int correct_cea_div = 0;
+    int correct_tyt_div = 0;
+    int correct_sac_div = 0;
+    int correct_auto = 0;
+    int correct_auto_div = 0;
+    int correct_step = 0;
+    int correct_batch = 0;
+    int correct_lanes = 0;
+
+    // Slices of the resumable inversions, and the longest one
+    int slices[SAC + 1] = {0};
+    unsigned long long max_slice[SAC + 1] = {0};
 
     // Required for randomization
     srand(time(NULL));
@@ -103,12 +140,34 @@ int main(void)
     for (int i = 0; i < TEST_INV_NUM_TESTS; i++) {   
         // Choose a random input
         gf2x_poly_random_coprime(&g);
+        gf2x_poly_random(&h);
         
         // Test BYI
         #if TEST_INV_BYI
             gf2x_mod_inv_byi(&ctx, &g, &ginv);
             gf2x_mod_mul(&g, &ginv, &tmp);
             if(isOnePoly(&tmp)) correct_byi++;
+
+            gf2x_mod_div_byi(&ctx, &h, &g, &ginv);
+            gf2x_mod_mul(&g, &ginv, &tmp);
+            if(isEqualPoly(&tmp, &h)) correct_byi_div++;
+        #endif
+
+        // Test EEA (variable time)
+        #if TEST_INV_EEA
+            int ok = gf2x_mod_inv_public(&ctx, &g, &ginv);
+            gf2x_mod_mul(&g, &ginv, &tmp);
+            if(ok && isOnePoly(&tmp)) correct_eea++;
+
+            ok = gf2x_mod_div_public(&ctx, &h, &g, &ginv);
+            gf2x_mod_mul(&g, &ginv, &tmp);
+            if(ok && isEqualPoly(&tmp, &h)) correct_eea_div++;
+
+            // A non-invertible input, i.e. of even weight
+            gf2x_poly_copy(&tmp, &g);
+            tmp.data[0] ^= 1;
+            ok = gf2x_mod_inv_public(&ctx, &tmp, &ginv);
+            if(!ok && isZeroPoly(&ginv)) correct_eea_singular++;
         #endif
 
         // Test FLT
@@ -116,6 +175,10 @@ int main(void)
             gf2x_mod_inv_flt(&ctx, &g, &ginv);
             gf2x_mod_mul(&g, &ginv, &tmp);
             if(isOnePoly(&tmp)) correct_flt++;
+
+            gf2x_mod_div_flt(&ctx, &h, &g, &ginv);
+            gf2x_mod_mul(&g, &ginv, &tmp);
+            if(isEqualPoly(&tmp, &h)) correct_flt_div++;
         #endif
         
         // Test CEA
@@ -123,6 +186,10 @@ int main(void)
             gf2x_mod_inv_cea(&ctx, &g, &ginv);
             gf2x_mod_mul(&g, &ginv, &tmp);
             if(isOnePoly(&tmp)) correct_cea++;
+
+            gf2x_mod_div_cea(&ctx, &h, &g, &ginv);
+            gf2x_mod_mul(&g, &ginv, &tmp);
+            if(isEqualPoly(&tmp, &h)) correct_cea_div++;
         #endif
 
         // Test TYT
@@ -130,6 +197,10 @@ int main(void)
             gf2x_mod_inv_tyt(&ctx, &g, &ginv);
             gf2x_mod_mul(&g, &ginv, &tmp);
             if(isOnePoly(&tmp)) correct_tyt++;
+
+            gf2x_mod_div_tyt(&ctx, &h, &g, &ginv);
+            gf2x_mod_mul(&g, &ginv, &tmp);
+            if(isEqualPoly(&tmp, &h)) correct_tyt_div++;
         #endif
 
         // Test SAC
@@ -137,6 +208,122 @@ int main(void)
             gf2x_mod_inv_sac(&ctx, &g, &ginv);
             gf2x_mod_mul(&g, &ginv, &tmp);
             if(isOnePoly(&tmp)) correct_sac++;
+
+            gf2x_mod_div_sac(&ctx, &h, &g, &ginv);
+            gf2x_mod_mul(&g, &ginv, &tmp);
+            if(isEqualPoly(&tmp, &h)) correct_sac_div++;
+        #endif
+
+        // Test the fastest method (selected on the first use of ctx)
+        #if TEST_INV_AUTO
+            gf2x_mod_inv(&ctx, &g, &ginv);
+            gf2x_mod_mul(&g, &ginv, &tmp);
+            if(isOnePoly(&tmp)) correct_auto++;
+
+            gf2x_mod_div(&ctx, &h, &g, &ginv);
+            gf2x_mod_mul(&g, &ginv, &tmp);
+            if(isEqualPoly(&tmp, &h)) correct_auto_div++;
+        #endif
+
+        // Test the resumable inversion of each method, in slices
+        #if TEST_INV_STEP
+            int step_ok = 1;
+            for (int m = BYI; m <= SAC; m++) {
+                gf2x_inv_state_t st;
+                gf2x_inv_begin(&st, &ctx, m, &g);
+
+                int done = 0;
+                gf2x_tune_t saved = gf2x_tune;
+                while (!done) {
+                    unsigned long long t0 = cpucycles();
+                    done = gf2x_inv_step(&st, TEST_INV_STEP_BUDGET);
+                    unsigned long long t1 = cpucycles();
+                    if (t1 - t0 > max_slice[m]) max_slice[m] = t1 - t0;
+                    slices[m]++;
+
+                    // Another schedule of ctx, which the run does not see
+                    if (m == BYI && memcmp(&gf2x_tune, &saved, sizeof(gf2x_tune_t)) == 0) {
+                        gf2x_tune.byi_split = (saved.byi_split == 8) ? 12 : 8;
+                        gf2x_tune.byi_base_blocks = (saved.byi_base_blocks == 1) ? 4 : 1;
+                        gf2x_ctx_init(&ctx);
+                    }
+                }
+                if (m == BYI) {
+                    gf2x_tune = saved;
+                    gf2x_ctx_init(&ctx);
+                }
+
+                gf2x_inv_finish(&st, &ginv);
+                gf2x_mod_mul(&g, &ginv, &tmp);
+                step_ok &= isOnePoly(&tmp);
+            }
+            if (step_ok) correct_step++;
+        #endif
+
+        // Test the batch inversion with each method, where the last two
+        // inputs are of even weight, and 1 + x + ... + x^(p-1), which is
+        // only seen by the masks if 2 is primitive modulo p (otherwise, 
+        // each input is inverted alone, see gf2x_inv_batch.c, and the
+        // inputs of odd weight may not be invertible either, see EEA)
+        #if TEST_INV_BATCH
+            poly_t gb[TEST_INV_BATCH_SIZE], gbinv[TEST_INV_BATCH_SIZE];
+            for (int j = 0; j < TEST_INV_BATCH_SIZE; j++) {
+                gf2x_poly_init(&gb[j], p-1);
+                gf2x_poly_init(&gbinv[j], p-1);
+                gf2x_poly_random_coprime(&gb[j]);
+            }
+            gb[TEST_INV_BATCH_SIZE - 2].data[0] ^= 1;
+            for (int k = 0; k < p; k++) {
+                gf2x_poly_setcoef(&gb[TEST_INV_BATCH_SIZE - 1], k, 1);
+            }
+
+            int expected = 0, invertible[TEST_INV_BATCH_SIZE];
+            for (int j = 0; j < TEST_INV_BATCH_SIZE; j++) {
+                invertible[j] = gf2x_mod_inv_eea(&ctx, &gb[j], &gbinv[j]);
+                expected += invertible[j];
+            }
+
+            int batch_ok = 1;
+            for (int m = BYI; m <= SAC; m++) {
+                int count = gf2x_mod_inv_batch_method(&ctx, m, TEST_INV_BATCH_SIZE, gb, gbinv);
+                batch_ok &= (count == expected);
+                for (int j = 0; j < TEST_INV_BATCH_SIZE; j++) {
+                    gf2x_mod_mul(&gb[j], &gbinv[j], &tmp);
+                    batch_ok &= invertible[j] ? isOnePoly(&tmp) : isZeroPoly(&gbinv[j]);
+                }
+            }
+            if (batch_ok) correct_batch++;
+
+            for (int j = 0; j < TEST_INV_BATCH_SIZE; j++) {
+                gf2x_poly_free(&gb[j]);
+                gf2x_poly_free(&gbinv[j]);
+            }
+        #endif
+
+        // The lanes vs the single inversions of each chain method
+        #if TEST_INV_LANES
+            poly_t gl[TEST_INV_LANES_SIZE], glinv[TEST_INV_LANES_SIZE];
+            for (int j = 0; j < TEST_INV_LANES_SIZE; j++) {
+                gf2x_poly_init(&gl[j], p-1);
+                gf2x_poly_init(&glinv[j], p-1);
+                gf2x_poly_random_coprime(&gl[j]);
+            }
+
+            int lanes_ok = 1;
+            for (int m = BYI; m <= SAC; m++) {
+                gf2x_mod_inv_lanes(&ctx, m, TEST_INV_LANES_SIZE, gl, glinv);
+                for (int j = 0; j < TEST_INV_LANES_SIZE; j++) {
+                    gf2x_mod_inv_method(&ctx, m, &gl[j], &ginv);
+                    gf2x_mod_mul(&gl[j], &glinv[j], &tmp);
+                    lanes_ok &= isOnePoly(&tmp) && isEqualPoly(&ginv, &glinv[j]);
+                }
+            }
+            if (lanes_ok) correct_lanes++;
+
+            for (int j = 0; j < TEST_INV_LANES_SIZE; j++) {
+                gf2x_poly_free(&gl[j]);
+                gf2x_poly_free(&glinv[j]);
+            }
         #endif
     }
 
@@ -144,22 +331,56 @@ int main(void)
     printf("\nResults (Number of Correct Computations / Number of Tests):\n");
     #if TEST_INV_BYI
         printf("  BYI : %d / %d \n", correct_byi, TEST_INV_NUM_TESTS);
+        printf("  BYI/div : %d / %d \n", correct_byi_div, TEST_INV_NUM_TESTS);
+    #endif
+
+    #if TEST_INV_EEA
+        printf("  EEA : %d / %d \n", correct_eea, TEST_INV_NUM_TESTS);
+        printf("  EEA/div : %d / %d \n", correct_eea_div, TEST_INV_NUM_TESTS);
+        printf("  EEA/singular : %d / %d \n", correct_eea_singular, TEST_INV_NUM_TESTS);
     #endif
 
     #if TEST_INV_FLT
         printf("  FLT : %d / %d \n", correct_flt, TEST_INV_NUM_TESTS);
+        printf("  FLT/div : %d / %d \n", correct_flt_div, TEST_INV_NUM_TESTS);
     #endif
     
     #if TEST_INV_CEA
         printf("  CEA : %d / %d \n", correct_cea, TEST_INV_NUM_TESTS);
+        printf("  CEA/div : %d / %d \n", correct_cea_div, TEST_INV_NUM_TESTS);
     #endif
     
     #if TEST_INV_TYT
         printf("  TYT : %d / %d \n", correct_tyt, TEST_INV_NUM_TESTS);
+        printf("  TYT/div : %d / %d \n", correct_tyt_div, TEST_INV_NUM_TESTS);
     #endif
     
     #if TEST_INV_SAC
         printf("  SAC : %d / %d \n", correct_sac, TEST_INV_NUM_TESTS);
+        printf("  SAC/div : %d / %d \n", correct_sac_div, TEST_INV_NUM_TESTS);
+    #endif
+
+    #if TEST_INV_AUTO
+        printf("  AUTO : %d / %d \n", correct_auto, TEST_INV_NUM_TESTS);
+        printf("  AUTO/div : %d / %d \n", correct_auto_div, TEST_INV_NUM_TESTS);
+        printf("  (AUTO = %s)\n", gf2x_inv_name(ctx.inv_method));
+    #endif
+
+    #if TEST_INV_BATCH
+        printf("  BATCH : %d / %d \n", correct_batch, TEST_INV_NUM_TESTS);
+    #endif
+
+    #if TEST_INV_LANES
+        printf("  LANES : %d / %d \n", correct_lanes, TEST_INV_NUM_TESTS);
+        printf("  (LANES = %d, BYI = %d)\n", GF2X_LANES, GF2X_BYI_LANES);
+    #endif
+
+    #if TEST_INV_STEP
+        printf("  STEP : %d / %d \n", correct_step, TEST_INV_NUM_TESTS);
+        for (int m = BYI; m <= SAC; m++) {
+            printf("  (STEP %s = %d slices of %.2f Mcc, at most %.2f Mcc)\n", gf2x_inv_name(m),
+                   slices[m] / TEST_INV_NUM_TESTS, TEST_INV_STEP_BUDGET / 1e6, max_slice[m] / 1e6);
+        }
     #endif
     printf("\n\n");
 
@@ -167,6 +388,7 @@ int main(void)
     gf2x_poly_free(&g);
     gf2x_poly_free(&ginv);
     gf2x_poly_free(&tmp);
+    gf2x_poly_free(&h);
 
     return 0;
 }
\ No newline at end of file
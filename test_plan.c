@@ -0,0 +1,231 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Emrah Karagoz, Pakize Sanal, Abhraneel Dutta, Edoardo Persichetti
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+
+#include "bench.h"
+#include "gf2x.h"
+#include "params.h"
+
+// Number of Tests
+#define TEST_PLAN_NUM_TESTS     (10)
+
+
+static int isOnePoly(poly_t *a) {
+    if (a->data[0] != 1) return 0;
+
+    for (int i = 1; i < a->size64; i++) {
+        if (a->data[i] != 0) return 0;
+    }
+
+    return 1;
+}
+
+
+static int isEqualPoly(poly_t *a, poly_t *b) {
+    for (int i = 0; i < a->size64; i++) {
+        if (a->data[i] != b->data[i]) return 0;
+    }
+    return 1;
+}
+
+
+// Number of correct inversions of the plan on random inputs
+static int test_plan_inv(gf2x_plan_t *plan, poly_t *g, poly_t *ginv, poly_t *tmp) {
+    int correct = 0;
+    for (int i = 0; i < TEST_PLAN_NUM_TESTS; i++) {
+        gf2x_poly_random_coprime(g);
+        gf2x_plan_inv(plan, g, ginv);
+        gf2x_mod_mul(g, ginv, tmp);
+        if (isOnePoly(tmp)) correct++;
+    }
+    return correct;
+}
+
+
+static void print_tune(char *name, gf2x_plan_t *plan) {
+    gf2x_tune_t *t = &plan->tune;
+    printf("  %-9s: kara=%d sqr=%s frob=%d byi_base=%d byi_split=%d inv=%s\n", name,
+           t->kara_threshold, (t->sqr_kernel == GF2X_SQR_PDEP) ? "PDEP" : "CLMUL",
+           t->frob_min_k, t->byi_base_blocks, t->byi_split, gf2x_inv_name(plan->inv_method));
+}
+
+
+void print_table_row(bench_t *bench, char *name) {
+    printf("| %-15d | %-15s | %-15.2f | %-15.4f |\n", EXT_DEG, name, bench->result / 1e3, bench->stats.med / 1e6);
+    printf("+-----------------+-----------------+-----------------+-----------------+\n");
+}
+
+
+int main(void)
+{
+    // Print the test info
+    printf("Testing Plans:\n");
+    printf("  EXT_DEG       : %d\n", EXT_DEG);
+    printf("  NUM_BLOCKS    : %d\n", NUM_BLOCKS);
+    printf("  NUM_TESTS     : %d\n", TEST_PLAN_NUM_TESTS);
+
+    // Variables
+    int p = EXT_DEG;
+    char wisdom_path[64];
+    snprintf(wisdom_path, sizeof(wisdom_path), "test_plan_P%d.wisdom", p);
+
+    poly_t g, ginv, tmp, c, d;
+    gf2x_poly_init(&g, p-1);
+    gf2x_poly_init(&ginv, p-1);
+    gf2x_poly_init(&tmp, p-1);
+    gf2x_poly_init(&c, p-1);
+    gf2x_poly_init(&d, p-1);
+
+    // Required for randomization
+    srand(time(NULL));
+
+    // BYI for the corners of the tunables
+    static const int karas[]  = { 2, 8, 32 };
+    static const int bases[]  = { 1, 2, 4 };
+    static const int splits[] = { 8, 11, 15 };
+    int correct_tune = 0, num_tune = 0;
+
+    for (int k = 0; k < 3; k++) {
+        for (int b = 0; b < 3; b++) {
+            for (int s = 0; s < 3; s++) {
+                gf2x_tune.kara_threshold = karas[k];
+                gf2x_tune.byi_base_blocks = bases[b];
+                gf2x_tune.byi_split = splits[s];
+
+                gf2x_poly_random_coprime(&g);
+                gf2x_mod_inv_byi(&ctx, &g, &ginv);
+                gf2x_mod_mul_kara(&g, &ginv, &tmp);
+                if (isOnePoly(&tmp)) correct_tune++;
+                num_tune++;
+            }
+        }
+    }
+
+    // Squaring kernels, and gf2x_mod_sqr_k on both sides of frob_min_k
+    int correct_sqr = 0;
+    for (int i = 0; i < TEST_PLAN_NUM_TESTS; i++) {
+        gf2x_poly_random(&g);
+        gf2x_tune.sqr_kernel = GF2X_SQR_CLMUL;
+        gf2x_mod_sqr(&g, &c);
+        gf2x_tune.sqr_kernel = gf2x_sqr_kernel_ok(GF2X_SQR_PDEP) ? GF2X_SQR_PDEP : GF2X_SQR_CLMUL;
+        gf2x_mod_sqr(&g, &d);
+
+        int k = 1 + rand() % 32;
+        gf2x_tune.frob_min_k = 1;
+        gf2x_mod_sqr_k(&g, k, &tmp);
+        gf2x_tune.frob_min_k = 1000;
+        gf2x_mod_sqr_k(&g, k, &ginv);
+        if (isEqualPoly(&c, &d) && isEqualPoly(&tmp, &ginv)) correct_sqr++;
+    }
+
+    // Plans without and with measuring (and a fresh wisdom)
+    gf2x_wisdom_forget();
+    gf2x_plan_t *estimate = gf2x_plan_create(&ctx, GF2X_PLAN_ESTIMATE);
+    int correct_estimate = test_plan_inv(estimate, &g, &ginv, &tmp);
+    gf2x_tune_t before = gf2x_tune;
+    int method_before = ctx.inv_method;
+    gf2x_plan_t *measure = gf2x_plan_create(&ctx, GF2X_PLAN_MEASURE);
+    int untouched = memcmp(&gf2x_tune, &before, sizeof(gf2x_tune_t)) == 0 &&
+                    ctx.inv_method == method_before;
+    int correct_measure = test_plan_inv(measure, &g, &ginv, &tmp);
+
+    // The wisdom back, and the same plan without measuring
+    int correct_wisdom = 0;
+    if (gf2x_wisdom_export(wisdom_path) == 1) {
+        gf2x_wisdom_forget();
+        gf2x_plan_t *none = gf2x_plan_create(&ctx, GF2X_PLAN_WISDOM_ONLY);
+        if (none == NULL && gf2x_wisdom_import(wisdom_path) == 1) {
+            gf2x_plan_t *wisdom = gf2x_plan_create(&ctx, GF2X_PLAN_WISDOM_ONLY);
+            if (wisdom != NULL &&
+                memcmp(&wisdom->tune, &measure->tune, sizeof(gf2x_tune_t)) == 0 &&
+                wisdom->inv_method == measure->inv_method &&
+                gf2x_wisdom_method(ctx.p) == measure->inv_method) {
+                correct_wisdom = test_plan_inv(wisdom, &g, &ginv, &tmp);
+            }
+            gf2x_plan_destroy(wisdom);
+        }
+    }
+    remove(wisdom_path);
+
+    // The plans by their own tunables and schedule, whatever gf2x_tune is,
+    // which the plans do not change either
+    gf2x_tune_t other = {
+        .kara_threshold = 2, .sqr_kernel = GF2X_SQR_CLMUL, .frob_min_k = 1,
+        .byi_base_blocks = 1, .byi_split = 15
+    };
+    gf2x_tune = other;
+    int correct_own = test_plan_inv(measure, &g, &ginv, &tmp);
+    if (!untouched || memcmp(&gf2x_tune, &other, sizeof(gf2x_tune_t)) != 0) {
+        correct_own = 0;
+    }
+
+    // Print the results
+    printf("\nPlans:\n");
+    print_tune("ESTIMATE", estimate);
+    print_tune("MEASURE", measure);
+
+    printf("\nResults (Number of Correct Computations / Number of Tests):\n");
+    printf("  TUNE/BYI : %d / %d \n", correct_tune, num_tune);
+    printf("  TUNE/SQR : %d / %d \n", correct_sqr, TEST_PLAN_NUM_TESTS);
+    printf("  ESTIMATE : %d / %d \n", correct_estimate, TEST_PLAN_NUM_TESTS);
+    printf("  MEASURE : %d / %d \n", correct_measure, TEST_PLAN_NUM_TESTS);
+    printf("  WISDOM : %d / %d \n", correct_wisdom, TEST_PLAN_NUM_TESTS);
+    printf("  PLAN/OWN : %d / %d \n", correct_own, TEST_PLAN_NUM_TESTS);
+
+    // Benchmarks
+    bench_t bench;
+    bench_init(&bench, TEST_SPEED_NUM_TESTS, NULL);
+    gf2x_poly_random_coprime(&g);
+
+    printf("\n");
+    printf("+-----------------+-----------------+-----------------+-----------------+\n");
+    printf("|     Ext Deg     |      Plan       |    Ave (msec)   |   Median (Mcc)  |\n");
+    printf("+-----------------+-----------------+-----------------+-----------------+\n");
+
+    gf2x_plan_inv(estimate, &g, &ginv);
+    BENCHFUNC(bench, gf2x_plan_inv(estimate, &g, &ginv));
+    print_table_row(&bench, "estimate");
+
+    gf2x_plan_inv(measure, &g, &ginv);
+    BENCHFUNC(bench, gf2x_plan_inv(measure, &g, &ginv));
+    print_table_row(&bench, "measure");
+
+    bench_free(&bench);
+
+    gf2x_plan_destroy(estimate);
+    gf2x_plan_destroy(measure);
+
+    gf2x_poly_free(&g);
+    gf2x_poly_free(&ginv);
+    gf2x_poly_free(&tmp);
+    gf2x_poly_free(&c);
+    gf2x_poly_free(&d);
+
+    return 0;
+}
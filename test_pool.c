@@ -0,0 +1,218 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Emrah Karagoz, Pakize Sanal, Abhraneel Dutta, Edoardo Persichetti
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "gf2x.h"
+#include "params.h"
+
+// Number of Tests
+#define TEST_POOL_NUM_TESTS     (10)
+
+// Size of the batches, where the input TEST_POOL_ZERO is zero (not invertible)
+#define TEST_POOL_BATCH_SIZE    (64)
+#define TEST_POOL_ZERO          (5)
+
+// Scaling: inversions per worker in each batch, and the number of batches
+#define TEST_POOL_SCALE_SIZE    (64)
+#define TEST_POOL_SCALE_RUNS    (5)
+
+
+static int isOnePoly(poly_t *a) {
+    if (a->data[0] != 1) return 0;
+
+    for (int i = 1; i < a->size64; i++) {
+        if (a->data[i] != 0) return 0;
+    }
+
+    return 1;
+}
+
+
+static int isZeroPoly(poly_t *a) {
+    for (int i = 0; i < a->size64; i++) {
+        if (a->data[i] != 0) return 0;
+    }
+    return 1;
+}
+
+
+static double wall_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+typedef struct {
+    gf2x_pool_t *pool;
+    poly_t      g[TEST_POOL_BATCH_SIZE];
+    poly_t      ginv[TEST_POOL_BATCH_SIZE];
+    int         correct;
+} caller_t;
+
+
+static void caller_init(caller_t *c, gf2x_pool_t *pool) {
+    c->pool = pool;
+    c->correct = 0;
+    for (int j = 0; j < TEST_POOL_BATCH_SIZE; j++) {
+        gf2x_poly_init(&c->g[j], EXT_DEG-1);
+        gf2x_poly_init(&c->ginv[j], EXT_DEG-1);
+    }
+}
+
+
+static void caller_free(caller_t *c) {
+    for (int j = 0; j < TEST_POOL_BATCH_SIZE; j++) {
+        gf2x_poly_free(&c->g[j]);
+        gf2x_poly_free(&c->ginv[j]);
+    }
+}
+
+
+// Number of correct batches of a caller, each with a zero input
+static void *caller_run(void *arg) {
+    caller_t *c = arg;
+    poly_t tmp;
+    gf2x_poly_init(&tmp, EXT_DEG-1);
+
+    for (int i = 0; i < TEST_POOL_NUM_TESTS; i++) {
+        for (int j = 0; j < TEST_POOL_BATCH_SIZE; j++) {
+            if (j == TEST_POOL_ZERO) {
+                memset(c->g[j].data, 0, c->g[j].size64 * sizeof(uint64_t));
+            } else {
+                gf2x_poly_random_coprime(&c->g[j]);
+            }
+        }
+
+        int count = gf2x_pool_inv_batch(c->pool, TEST_POOL_BATCH_SIZE, c->g, c->ginv);
+
+        int ok = (count == TEST_POOL_BATCH_SIZE - 1);
+        for (int j = 0; j < TEST_POOL_BATCH_SIZE; j++) {
+            gf2x_mod_mul(&c->g[j], &c->ginv[j], &tmp);
+            ok &= (j != TEST_POOL_ZERO) ? isOnePoly(&tmp) : isZeroPoly(&c->ginv[j]);
+        }
+        if (ok) c->correct++;
+    }
+
+    gf2x_poly_free(&tmp);
+    return NULL;
+}
+
+
+int main(void)
+{
+    // Required for randomization (before any caller thread)
+    srand(time(NULL));
+
+    // A pool of a worker per CPU
+    gf2x_pool_t *pool = gf2x_pool_create(&ctx, 0, GF2X_PLAN_ESTIMATE);
+    int num_cpus = gf2x_pool_threads(pool);
+
+    // Print the test info
+    printf("Testing Thread Pool:\n");
+    printf("  EXT_DEG       : %d\n", EXT_DEG);
+    printf("  NUM_BLOCKS    : %d\n", NUM_BLOCKS);
+    printf("  NUM_TESTS     : %d\n", TEST_POOL_NUM_TESTS);
+    printf("  BATCH_SIZE    : %d\n", TEST_POOL_BATCH_SIZE);
+    printf("  NUM_THREADS   : %d\n", num_cpus);
+    printf("  METHOD        : %s\n", gf2x_inv_name(ctx.inv_method));
+
+    // A single caller, and two callers at a time
+    caller_t *c = malloc(3 * sizeof(caller_t));
+    for (int k = 0; k < 3; k++) {
+        caller_init(&c[k], pool);
+    }
+
+    caller_run(&c[0]);
+
+    pthread_t caller[2];
+    for (int k = 0; k < 2; k++) {
+        pthread_create(&caller[k], NULL, caller_run, &c[1 + k]);
+    }
+    for (int k = 0; k < 2; k++) {
+        pthread_join(caller[k], NULL);
+    }
+
+    printf("\nResults (Number of Correct Batches / Number of Tests):\n");
+    printf("  SINGLE : %d / %d \n", c[0].correct, TEST_POOL_NUM_TESTS);
+    printf("  TWO    : %d / %d \n", c[1].correct + c[2].correct, 2 * TEST_POOL_NUM_TESTS);
+
+    for (int k = 0; k < 3; k++) {
+        caller_free(&c[k]);
+    }
+    free(c);
+    gf2x_pool_destroy(pool);
+
+    // Scaling from 1 to num_cpus workers
+    int max_size = TEST_POOL_SCALE_SIZE * num_cpus;
+    poly_t *g = malloc(max_size * sizeof(poly_t));
+    poly_t *ginv = malloc(max_size * sizeof(poly_t));
+    for (int j = 0; j < max_size; j++) {
+        gf2x_poly_init(&g[j], EXT_DEG-1);
+        gf2x_poly_init(&ginv[j], EXT_DEG-1);
+        gf2x_poly_random_coprime(&g[j]);
+    }
+
+    printf("\n");
+    printf("+-----------------+-----------------+-----------------+-----------------+-----------------+\n");
+    printf("|     Ext Deg     |     Threads     |    Inv / sec    | Inv / sec / core|     Speedup     |\n");
+    printf("+-----------------+-----------------+-----------------+-----------------+-----------------+\n");
+
+    double base = 0;
+    for (int t = 1; t <= num_cpus; t++) {
+        pool = gf2x_pool_create(&ctx, t, GF2X_PLAN_ESTIMATE);
+        int n = TEST_POOL_SCALE_SIZE * t;
+
+        // Warm-up, and the best of the runs
+        gf2x_pool_inv_batch(pool, n, g, ginv);
+        double best = 0;
+        for (int r = 0; r < TEST_POOL_SCALE_RUNS; r++) {
+            double start = wall_time();
+            gf2x_pool_inv_batch(pool, n, g, ginv);
+            double rate = n / (wall_time() - start);
+            best = (rate > best) ? rate : best;
+        }
+        gf2x_pool_destroy(pool);
+
+        if (t == 1) base = best;
+        printf("| %-15d | %-15d | %-15.1f | %-15.1f | %-15.2f |\n", EXT_DEG, t, best, best / t, best / base);
+        printf("+-----------------+-----------------+-----------------+-----------------+-----------------+\n");
+    }
+
+    for (int j = 0; j < max_size; j++) {
+        gf2x_poly_free(&g[j]);
+        gf2x_poly_free(&ginv[j]);
+    }
+    free(g);
+    free(ginv);
+
+    return 0;
+}
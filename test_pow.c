@@ -0,0 +1,195 @@
+/* 
+ * MIT License
+ *
+ * Copyright (c) 2024 Emrah Karagoz, Pakize Sanal, Abhraneel Dutta, Edoardo Persichetti
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+
+#include "bench.h"
+#include "gf2x.h"
+#include "params.h"
+
+// Number of Tests, and bits of the random exponents
+#define TEST_POW_NUM_TESTS      (10)
+#define TEST_POW_EBITS          (1024)
+
+
+static int isOnePoly(poly_t *a) {
+    if (a->data[0] != 1) return 0;
+
+    for (int i = 1; i < a->size64; i++) {
+        if (a->data[i] != 0) return 0;
+    }
+
+    return 1;
+}
+
+
+static int isEqualPoly(poly_t *a, poly_t *b) {
+    for (int i = 0; i < a->size64; i++) {
+        if (a->data[i] != b->data[i]) return 0;
+    }
+    return 1;
+}
+
+
+// Naive (variable-time) square-and-multiply, i.e. the reference of gf2x_mod_pow
+static void pow_naive(poly_t *g, uint64_t *e, int ebits, poly_t *c) {
+    gf2x_poly_zeroize(c);
+    c->data[0] = 1;
+    for (int i = ebits - 1; i >= 0; i--) {
+        gf2x_mod_sqr(c, c);
+        if ((e[i / 64] >> (i % 64)) & 1) {
+            gf2x_mod_mul(c, g, c);
+        }
+    }
+}
+
+
+static void random_exponent(uint64_t *e, int ebits) {
+    for (int i = 0; i < (ebits + 63) / 64; i++) {
+        e[i] = ((uint64_t) rand() << 42) ^ ((uint64_t) rand() << 21) ^ (uint64_t) rand();
+    }
+    if (ebits % 64) {
+        e[ebits / 64] &= (1ULL << (ebits % 64)) - 1;
+    }
+}
+
+
+void print_table_row(bench_t *bench, char *name) {
+    printf("| %-15d | %-15s | %-15.2f | %-15.4f |\n", EXT_DEG, name, bench->result / 1e3, bench->stats.med / 1e6);
+    printf("+-----------------+-----------------+-----------------+-----------------+\n");
+}
+
+
+int main(void)
+{
+    // Print the test info
+    printf("Testing Exponentiation:\n");
+    printf("  EXT_DEG       : %d\n", EXT_DEG);
+    printf("  NUM_BLOCKS    : %d\n", NUM_BLOCKS);
+    printf("  WINDOW        : %d\n", GF2X_POW_WINDOW);
+    printf("  EBITS         : %d\n", TEST_POW_EBITS);
+    printf("  NUM_TESTS     : %d\n", TEST_POW_NUM_TESTS);
+
+    // Variables
+    int p = EXT_DEG;
+
+    poly_t g, c, d, tmp;
+    gf2x_poly_init(&g, p-1);
+    gf2x_poly_init(&c, p-1);
+    gf2x_poly_init(&d, p-1);
+    gf2x_poly_init(&tmp, p-1);
+
+    uint64_t e[(TEST_POW_EBITS + 63) / 64];
+
+    // Exponent of the inverse, 2^(p-1) - 2
+    uint64_t einv[p / 64 + 1];
+    memset(einv, 0, sizeof(einv));
+    for (int i = 1; i < p - 1; i++) {
+        einv[i / 64] |= 1ULL << (i % 64);
+    }
+
+    int correct_pow = 0;
+    int correct_inv = 0;
+    int correct_frob = 0;
+    int correct_sqrt = 0;
+
+    // Required for randomization
+    srand(time(NULL));
+
+    for (int i = 0; i < TEST_POW_NUM_TESTS; i++) {
+        gf2x_poly_random_coprime(&g);
+
+        // g^e vs square-and-multiply
+        random_exponent(e, TEST_POW_EBITS);
+        gf2x_mod_pow(&ctx, &g, e, TEST_POW_EBITS, &c);
+        pow_naive(&g, e, TEST_POW_EBITS, &d);
+        if (isEqualPoly(&c, &d)) correct_pow++;
+
+        // g * g^(2^(p-1) - 2) = 1, only once (i.e. p - 1 bits)
+        if (i == 0) {
+            gf2x_mod_pow(&ctx, &g, einv, p - 1, &c);
+            gf2x_mod_mul(&g, &c, &tmp);
+            if (isOnePoly(&tmp)) correct_inv++;
+        }
+
+        // g^(2^k) vs k squarings, and back by g^(2^-k)
+        int k = rand() % (2 * GF2X_FROB_MIN_K);
+        gf2x_mod_frob(&g, k, &c);
+        gf2x_poly_copy(&d, &g);
+        gf2x_mod_sqr_k_inplace(&d, k);
+        gf2x_mod_frob(&c, -k, &tmp);
+        if (isEqualPoly(&c, &d) && isEqualPoly(&tmp, &g)) correct_frob++;
+
+        // (g^(1/2))^2 = g
+        gf2x_mod_sqrt(&g, &c);
+        gf2x_mod_sqr(&c, &d);
+        if (isEqualPoly(&d, &g)) correct_sqrt++;
+    }
+
+    // Print the results
+    printf("\nResults (Number of Correct Computations / Number of Tests):\n");
+    printf("  POW : %d / %d \n", correct_pow, TEST_POW_NUM_TESTS);
+    printf("  POW/inv : %d / %d \n", correct_inv, 1);
+    printf("  FROB : %d / %d \n", correct_frob, TEST_POW_NUM_TESTS);
+    printf("  SQRT : %d / %d \n", correct_sqrt, TEST_POW_NUM_TESTS);
+
+    // Benchmarks
+    bench_t bench;
+    bench_init(&bench, TEST_SPEED_NUM_TESTS, NULL);
+
+    random_exponent(e, TEST_POW_EBITS);
+
+    printf("\n");
+    printf("+-----------------+-----------------+-----------------+-----------------+\n");
+    printf("|     Ext Deg     |    Operation    |    Ave (msec)   |   Median (Mcc)  |\n");
+    printf("+-----------------+-----------------+-----------------+-----------------+\n");
+
+    BENCHFUNC(bench, gf2x_mod_pow(&ctx, &g, e, TEST_POW_EBITS, &c));
+    print_table_row(&bench, "pow (window)");
+
+    BENCHFUNC(bench, pow_naive(&g, e, TEST_POW_EBITS, &c));
+    print_table_row(&bench, "pow (naive)");
+
+    BENCHFUNC(bench, gf2x_mod_frob(&g, GF2X_FROB_MIN_K, &c));
+    print_table_row(&bench, "frob");
+
+    BENCHFUNC(bench, gf2x_poly_copy(&c, &g); gf2x_mod_sqr_k_inplace(&c, GF2X_FROB_MIN_K));
+    print_table_row(&bench, "sqr^k");
+
+    BENCHFUNC(bench, gf2x_mod_sqrt(&g, &c));
+    print_table_row(&bench, "sqrt");
+
+    bench_free(&bench);
+
+    gf2x_poly_free(&g);
+    gf2x_poly_free(&c);
+    gf2x_poly_free(&d);
+    gf2x_poly_free(&tmp);
+
+    return 0;
+}
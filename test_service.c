@@ -0,0 +1,240 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Emrah Karagoz, Pakize Sanal, Abhraneel Dutta, Edoardo Persichetti
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "gf2x.h"
+#include "params.h"
+
+// Number of requests of each client, where the request TEST_SVC_ZERO is zero
+#define TEST_SVC_NUM_TESTS      (64)
+#define TEST_SVC_ZERO           (5)
+
+// Load generator: clients, requests of each client, and their depths
+#define TEST_SVC_CLIENTS        (2)
+#define TEST_SVC_REQUESTS       (256)
+static const int depths[] = { 1, 4, 16, 64 };
+
+
+static int isOnePoly(poly_t *a) {
+    if (a->data[0] != 1) return 0;
+
+    for (int i = 1; i < a->size64; i++) {
+        if (a->data[i] != 0) return 0;
+    }
+
+    return 1;
+}
+
+
+static int isZeroPoly(poly_t *a) {
+    for (int i = 0; i < a->size64; i++) {
+        if (a->data[i] != 0) return 0;
+    }
+    return 1;
+}
+
+
+static double wall_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+    return (x > y) - (x < y);
+}
+
+
+typedef struct {
+    gf2x_svc_t  *svc;
+    int         depth;
+    int         num;            // requests
+    poly_t      *g;
+    poly_t      *ginv;
+    uint64_t    *latency;       // of each request (ns)
+    int         correct;
+} client_t;
+
+
+static void client_init(client_t *c, gf2x_svc_t *svc, int num) {
+    c->svc = svc;
+    c->num = num;
+    c->g = malloc(num * sizeof(poly_t));
+    c->ginv = malloc(num * sizeof(poly_t));
+    c->latency = malloc(num * sizeof(uint64_t));
+    for (int j = 0; j < num; j++) {
+        gf2x_poly_init(&c->g[j], EXT_DEG-1);
+        gf2x_poly_init(&c->ginv[j], EXT_DEG-1);
+        gf2x_poly_random_coprime(&c->g[j]);
+    }
+}
+
+
+static void client_free(client_t *c) {
+    for (int j = 0; j < c->num; j++) {
+        gf2x_poly_free(&c->g[j]);
+        gf2x_poly_free(&c->ginv[j]);
+    }
+    free(c->g);
+    free(c->ginv);
+    free(c->latency);
+}
+
+
+// Closed loop of depth requests in flight, i.e. a new request for each
+// completion, and the number of correct completions
+static void *client_run(void *arg) {
+    client_t *c = arg;
+    gf2x_svc_client_t *sc = gf2x_svc_client_create(c->svc, c->depth);
+    gf2x_svc_cqe_t cqe[64];
+    poly_t tmp;
+    gf2x_poly_init(&tmp, EXT_DEG-1);
+
+    int submitted = 0, completed = 0;
+    c->correct = 0;
+
+    while (completed < c->num) {
+        while (submitted < c->num && gf2x_svc_submit(sc, &c->g[submitted], &c->ginv[submitted], submitted)) {
+            submitted++;
+        }
+
+        int n = gf2x_svc_reap(sc, cqe, 64, 1);
+        for (int k = 0; k < n; k++) {
+            int j = (int) cqe[k].user_data;
+            c->latency[completed + k] = cqe[k].t_done - cqe[k].t_submit;
+
+            gf2x_mod_mul(&c->g[j], &c->ginv[j], &tmp);
+            int zero = isZeroPoly(&c->g[j]);
+            if (zero ? (!cqe[k].invertible && isZeroPoly(&c->ginv[j])) 
+                     : (cqe[k].invertible && isOnePoly(&tmp))) {
+                c->correct++;
+            }
+        }
+        completed += n;
+    }
+
+    gf2x_poly_free(&tmp);
+    gf2x_svc_client_destroy(sc);
+    return NULL;
+}
+
+
+// Run the clients together, and return the wall time
+static double run_clients(client_t *c, int num) {
+    pthread_t thread[TEST_SVC_CLIENTS];
+
+    double start = wall_time();
+    for (int k = 0; k < num; k++) {
+        pthread_create(&thread[k], NULL, client_run, &c[k]);
+    }
+    for (int k = 0; k < num; k++) {
+        pthread_join(thread[k], NULL);
+    }
+    return wall_time() - start;
+}
+
+
+int main(void)
+{
+    // Required for randomization (before any client thread)
+    srand(time(NULL));
+
+    long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int num_threads = (num_cpus > 0) ? (int) num_cpus : 1;
+    gf2x_svc_t *svc = gf2x_svc_create(&ctx, num_threads, GF2X_PLAN_ESTIMATE);
+
+    // Print the test info
+    printf("Testing Inversion Service:\n");
+    printf("  EXT_DEG       : %d\n", EXT_DEG);
+    printf("  NUM_BLOCKS    : %d\n", NUM_BLOCKS);
+    printf("  NUM_TESTS     : %d\n", TEST_SVC_NUM_TESTS);
+    printf("  NUM_THREADS   : %d\n", num_threads);
+    printf("  METHOD        : %s\n", gf2x_inv_name(ctx.inv_method));
+
+    // A single client, and two clients at a time, with a zero request each
+    client_t c[TEST_SVC_CLIENTS];
+    for (int k = 0; k < TEST_SVC_CLIENTS; k++) {
+        client_init(&c[k], svc, TEST_SVC_NUM_TESTS);
+        memset(c[k].g[TEST_SVC_ZERO].data, 0, c[k].g[TEST_SVC_ZERO].size64 * sizeof(uint64_t));
+        c[k].depth = 16;
+    }
+
+    run_clients(c, 1);
+    int correct_single = c[0].correct;
+    run_clients(c, TEST_SVC_CLIENTS);
+    int correct_multi = 0;
+    for (int k = 0; k < TEST_SVC_CLIENTS; k++) {
+        correct_multi += c[k].correct;
+        client_free(&c[k]);
+    }
+
+    printf("\nResults (Number of Correct Completions / Number of Requests):\n");
+    printf("  SINGLE : %d / %d \n", correct_single, TEST_SVC_NUM_TESTS);
+    printf("  MULTI : %d / %d \n", correct_multi, TEST_SVC_CLIENTS * TEST_SVC_NUM_TESTS);
+
+    // Throughput vs latency of the load generator, for each depth
+    printf("\n");
+    printf("+-----------------+-----------------+-----------------+-----------------+-----------------+\n");
+    printf("|     Ext Deg     |  Clients x Depth|    Inv / sec    |    p50 (usec)   |    p99 (usec)   |\n");
+    printf("+-----------------+-----------------+-----------------+-----------------+-----------------+\n");
+
+    int num_lat = TEST_SVC_CLIENTS * TEST_SVC_REQUESTS;
+    uint64_t *lat = malloc(num_lat * sizeof(uint64_t));
+
+    for (int d = 0; d < (int) (sizeof(depths) / sizeof(depths[0])); d++) {
+        for (int k = 0; k < TEST_SVC_CLIENTS; k++) {
+            client_init(&c[k], svc, TEST_SVC_REQUESTS);
+            c[k].depth = depths[d];
+        }
+
+        double t = run_clients(c, TEST_SVC_CLIENTS);
+
+        for (int k = 0; k < TEST_SVC_CLIENTS; k++) {
+            memcpy(&lat[k * TEST_SVC_REQUESTS], c[k].latency, TEST_SVC_REQUESTS * sizeof(uint64_t));
+            client_free(&c[k]);
+        }
+        qsort(lat, num_lat, sizeof(uint64_t), cmp_u64);
+
+        char name[32];
+        snprintf(name, sizeof(name), "%d x %d", TEST_SVC_CLIENTS, depths[d]);
+        printf("| %-15d | %-15s | %-15.1f | %-15.1f | %-15.1f |\n", EXT_DEG, name, num_lat / t,
+               lat[num_lat / 2] / 1e3, lat[(num_lat * 99) / 100] / 1e3);
+        printf("+-----------------+-----------------+-----------------+-----------------+-----------------+\n");
+    }
+
+    free(lat);
+    gf2x_svc_destroy(svc);
+
+    return 0;
+}
@@ -0,0 +1,307 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Emrah Karagoz, Pakize Sanal, Abhraneel Dutta, Edoardo Persichetti
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "gf2x.h"
+#include "params.h"
+
+// Number of requests of each test, and the depth of their clients, where 
+// the inversion TEST_SHM_ZERO is zero (not invertible)
+#define TEST_SHM_NUM_TESTS      (64)
+#define TEST_SHM_DEPTH          (16)
+#define TEST_SHM_ZERO           (5)
+
+// Load generator: client processes, requests of each client, and their depths
+#define TEST_SHM_CLIENTS        (2)
+#define TEST_SHM_REQUESTS       (256)
+static const int depths[] = { 1, 4, 16, 64 };
+
+
+static int isOnePoly(poly_t *a) {
+    if (a->data[0] != 1) return 0;
+
+    for (int i = 1; i < a->size64; i++) {
+        if (a->data[i] != 0) return 0;
+    }
+
+    return 1;
+}
+
+
+static int isZeroPoly(poly_t *a) {
+    for (int i = 0; i < a->size64; i++) {
+        if (a->data[i] != 0) return 0;
+    }
+    return 1;
+}
+
+
+static int isEqualPoly(poly_t *a, poly_t *b) {
+    for (int i = 0; i < a->size64; i++) {
+        if (a->data[i] != b->data[i]) return 0;
+    }
+    return 1;
+}
+
+
+static double wall_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+    return (x > y) - (x < y);
+}
+
+
+// Closed loop of num requests of op on random inputs (a new request for 
+// each completion), with their latencies (if any), and the number of 
+// correct completions. The worker is killed after the first submissions
+// if kill_worker is set.
+static int client_run(gf2x_shm_client_t *c, int op, int num, uint64_t *latency, int kill_worker) {
+    int depth = gf2x_shm_depth(c);
+    gf2x_shm_cqe_t cqe[64];
+    poly_t tmp;
+    gf2x_poly_init(&tmp, EXT_DEG-1);
+
+    // Free slots
+    int free_slots[64], num_free = 0;
+    assert(depth <= 64);
+    for (int slot = depth - 1; slot >= 0; slot--) {
+        free_slots[num_free++] = slot;
+    }
+
+    int submitted = 0, completed = 0, correct = 0;
+
+    while (completed < num) {
+        while (num_free > 0 && submitted < num) {
+            int slot = free_slots[num_free - 1];
+            poly_t *a = gf2x_shm_poly(c, slot, 0);
+            gf2x_poly_random_coprime(a);
+            gf2x_poly_random(gf2x_shm_poly(c, slot, 1));
+            if (op == GF2X_SHM_INV && submitted == TEST_SHM_ZERO) {
+                memset(a->data, 0, a->size64 * sizeof(uint64_t));
+            }
+            if (!gf2x_shm_submit(c, op, slot, submitted)) {
+                break;
+            }
+            num_free--;
+            submitted++;
+        }
+
+        if (kill_worker) {
+            kill(gf2x_shm_worker(c), SIGKILL);
+            kill_worker = 0;
+        }
+
+        int n = gf2x_shm_reap(c, cqe, 64, 1);
+        for (int k = 0; k < n; k++) {
+            poly_t *a = gf2x_shm_poly(c, cqe[k].slot, 0);
+            poly_t *b = gf2x_shm_poly(c, cqe[k].slot, 1);
+            poly_t *out = gf2x_shm_poly(c, cqe[k].slot, 2);
+            if (latency != NULL) {
+                latency[completed + k] = cqe[k].t_done - cqe[k].t_submit;
+            }
+
+            if (op == GF2X_SHM_INV && cqe[k].user_data == TEST_SHM_ZERO) {
+                if (cqe[k].status == 1 && isZeroPoly(out)) correct++;
+            } else if (cqe[k].status == 0 && op == GF2X_SHM_INV) {
+                gf2x_mod_mul(a, out, &tmp);
+                if (isOnePoly(&tmp)) correct++;
+            } else if (cqe[k].status == 0) {
+                gf2x_mod_mul(a, b, &tmp);
+                if (isEqualPoly(&tmp, out)) correct++;
+            }
+            free_slots[num_free++] = cqe[k].slot;
+        }
+        completed += n;
+    }
+
+    gf2x_poly_free(&tmp);
+    return correct;
+}
+
+
+// Fork the client processes, each writing its latencies into a pipe, and
+// return the wall time
+static double run_clients(char *path, int num, int depth, int requests, uint64_t *latency) {
+    int fd[TEST_SHM_CLIENTS][2];
+
+    double start = wall_time();
+    for (int k = 0; k < num; k++) {
+        assert(pipe(fd[k]) == 0);
+        if (fork() == 0) {
+            srand(time(NULL) ^ getpid());
+            uint64_t *lat = calloc(requests, sizeof(uint64_t));
+            gf2x_shm_client_t *c = gf2x_shm_connect(path, depth);
+            if (c != NULL) {
+                client_run(c, GF2X_SHM_INV, requests, lat, 0);
+                gf2x_shm_close(c);
+            }
+            ssize_t r = write(fd[k][1], lat, requests * sizeof(uint64_t));
+            _exit(r == (ssize_t) (requests * sizeof(uint64_t)) ? 0 : 1);
+        }
+        close(fd[k][1]);
+    }
+
+    for (int k = 0; k < num; k++) {
+        size_t size = requests * sizeof(uint64_t), done = 0;
+        while (done < size) {
+            ssize_t r = read(fd[k][0], (uint8_t *) &latency[k * requests] + done, size - done);
+            if (r <= 0) break;
+            done += r;
+        }
+        close(fd[k][0]);
+        wait(NULL);
+    }
+    return wall_time() - start;
+}
+
+
+// Correct completions of the client processes together
+static int run_multi(char *path) {
+    int fd[TEST_SHM_CLIENTS][2];
+    int correct = 0;
+
+    for (int k = 0; k < TEST_SHM_CLIENTS; k++) {
+        assert(pipe(fd[k]) == 0);
+        if (fork() == 0) {
+            srand(time(NULL) ^ getpid());
+            int n = 0;
+            gf2x_shm_client_t *c = gf2x_shm_connect(path, TEST_SHM_DEPTH);
+            if (c != NULL) {
+                n = client_run(c, GF2X_SHM_INV, TEST_SHM_NUM_TESTS, NULL, 0);
+                gf2x_shm_close(c);
+            }
+            _exit(write(fd[k][1], &n, sizeof(n)) == sizeof(n) ? 0 : 1);
+        }
+        close(fd[k][1]);
+    }
+    for (int k = 0; k < TEST_SHM_CLIENTS; k++) {
+        int n = 0;
+        if (read(fd[k][0], &n, sizeof(n)) == sizeof(n)) correct += n;
+        close(fd[k][0]);
+        wait(NULL);
+    }
+    return correct;
+}
+
+
+int main(void)
+{
+    long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int num_workers = (num_cpus > 1) ? (int) num_cpus : 2;
+
+    char path[108];
+    snprintf(path, sizeof(path), "/tmp/test_shm_P%d_%d.sock", EXT_DEG, (int) getpid());
+
+    // Print the test info
+    printf("Testing Inversion Daemon:\n");
+    printf("  EXT_DEG       : %d\n", EXT_DEG);
+    printf("  NUM_BLOCKS    : %d\n", NUM_BLOCKS);
+    printf("  NUM_TESTS     : %d\n", TEST_SHM_NUM_TESTS);
+    printf("  NUM_WORKERS   : %d\n", num_workers);
+    printf("  SOCKET        : %s\n", path);
+    fflush(stdout);
+
+    // The daemon
+    pid_t daemon = fork();
+    if (daemon == 0) {
+        _exit(gf2x_shm_serve(&ctx, path, num_workers, GF2X_PLAN_ESTIMATE, 0) == 0 ? 0 : 1);
+    }
+
+    gf2x_shm_client_t *c = NULL;
+    for (int i = 0; i < 500 && c == NULL; i++) {
+        c = gf2x_shm_connect(path, TEST_SHM_DEPTH);
+        if (c == NULL) usleep(10000);
+    }
+    if (c == NULL) {
+        printf("\nNo daemon on %s\n", path);
+        kill(daemon, SIGTERM);
+        waitpid(daemon, NULL, 0);
+        return 1;
+    }
+
+    // Required for randomization
+    srand(time(NULL));
+
+    // A single client, for each operation
+    int correct_inv = client_run(c, GF2X_SHM_INV, TEST_SHM_NUM_TESTS, NULL, 0);
+    int correct_mul = client_run(c, GF2X_SHM_MUL, TEST_SHM_NUM_TESTS, NULL, 0);
+
+    // A crashed worker, whose requests are redone by its replacement
+    int worker = gf2x_shm_worker(c);
+    int correct_respawn = client_run(c, GF2X_SHM_INV, TEST_SHM_NUM_TESTS, NULL, 1);
+    if (gf2x_shm_worker(c) == worker) {
+        correct_respawn = 0;
+    }
+    gf2x_shm_close(c);
+
+    // Client processes at a time
+    int correct_multi = run_multi(path);
+
+    printf("\nResults (Number of Correct Completions / Number of Requests):\n");
+    printf("  INV : %d / %d \n", correct_inv, TEST_SHM_NUM_TESTS);
+    printf("  MUL : %d / %d \n", correct_mul, TEST_SHM_NUM_TESTS);
+    printf("  RESPAWN : %d / %d \n", correct_respawn, TEST_SHM_NUM_TESTS);
+    printf("  MULTI : %d / %d \n", correct_multi, TEST_SHM_CLIENTS * TEST_SHM_NUM_TESTS);
+
+    // Throughput vs latency of the load generator, for each depth
+    printf("\n");
+    printf("+-----------------+-----------------+-----------------+-----------------+-----------------+\n");
+    printf("|     Ext Deg     |  Clients x Depth|    Inv / sec    |    p50 (usec)   |    p99 (usec)   |\n");
+    printf("+-----------------+-----------------+-----------------+-----------------+-----------------+\n");
+
+    int num_lat = TEST_SHM_CLIENTS * TEST_SHM_REQUESTS;
+    uint64_t *lat = calloc(num_lat, sizeof(uint64_t));
+
+    for (int d = 0; d < (int) (sizeof(depths) / sizeof(depths[0])); d++) {
+        double t = run_clients(path, TEST_SHM_CLIENTS, depths[d], TEST_SHM_REQUESTS, lat);
+        qsort(lat, num_lat, sizeof(uint64_t), cmp_u64);
+
+        char name[32];
+        snprintf(name, sizeof(name), "%d x %d", TEST_SHM_CLIENTS, depths[d]);
+        printf("| %-15d | %-15s | %-15.1f | %-15.1f | %-15.1f |\n", EXT_DEG, name, num_lat / t,
+               lat[num_lat / 2] / 1e3, lat[(num_lat * 99) / 100] / 1e3);
+        printf("+-----------------+-----------------+-----------------+-----------------+-----------------+\n");
+    }
+
+    free(lat);
+    kill(daemon, SIGTERM);
+    waitpid(daemon, NULL, 0);
+
+    return 0;
+}
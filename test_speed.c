@@ -23,6 +23,7 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 #include <time.h>
 
 #include "bench.h"
@@ -32,19 +33,19 @@
 #define TEST_SPEED_FIXED_INPUT              1
 #define TEST_SPEED_RANDOM_INPUT             0
 
-#if defined(USE_STATIC_POLY)
-    #define TEST_SPEED_BYI    0
-    #define TEST_SPEED_FLT    1
-    #define TEST_SPEED_CEA    1
-    #define TEST_SPEED_TYT    1
-    #define TEST_SPEED_SAC    1
-#else
-    #define TEST_SPEED_BYI    1
-    #define TEST_SPEED_FLT    0
-    #define TEST_SPEED_CEA    0
-    #define TEST_SPEED_TYT    0
-    #define TEST_SPEED_SAC    0
-#endif
+// All the algorithms are built with both static and dynamic polynomials
+#define TEST_SPEED_BYI    1
+#define TEST_SPEED_EEA    1
+#define TEST_SPEED_FLT    1
+#define TEST_SPEED_CEA    1
+#define TEST_SPEED_TYT    1
+#define TEST_SPEED_SAC    1
+#define TEST_SPEED_AUTO   1
+#define TEST_SPEED_BATCH  1
+#define TEST_SPEED_LANES  1
+
+// Size of the batch of inversions, vs as many single inversions
+#define TEST_SPEED_BATCH_SIZE   (16)
 
 
 void print_table_head() {
@@ -55,9 +56,57 @@ void print_table_head() {
 }
 
 
+// Rows of the counters (if any), printed after the table
+#define TEST_SPEED_MAX_ROWS     (32)
+static char counter_rows[TEST_SPEED_MAX_ROWS][32];
+static double counter_values[TEST_SPEED_MAX_ROWS][BENCH_NUM_COUNTERS];
+static int num_counter_rows = 0;
+
+
 void print_table_row(bench_t *bench, char *name) {
     printf("| %-15d | %-15s | %-15.2f | %-15.2f |\n", EXT_DEG, name, bench->result / 1e3, bench->stats.med / 1e6);
     printf("+-----------------+-----------------+-----------------+-----------------+\n");
+
+    if (bench->counters.num > 0 && num_counter_rows < TEST_SPEED_MAX_ROWS) {
+        snprintf(counter_rows[num_counter_rows], 32, "%s", name);
+        memcpy(counter_values[num_counter_rows], bench->counters.per_call, sizeof(counter_values[0]));
+        num_counter_rows++;
+    }
+}
+
+
+static void print_counter(double v, double unit, int width, int prec) {
+    if (v >= 0) {
+        printf(" %-*.*f |", width, prec, v / unit);
+    } else {
+        printf(" %-*s |", width, "n/a");
+    }
+}
+
+
+// Counters per call (-1 if not counted): Mcycles, Minstructions, IPC,
+// and the thousands of L1D, L2 and branch misses
+void print_counters_table() {
+    if (num_counter_rows == 0) {
+        return;
+    }
+    printf("\n");
+    printf("+-----------------+-----------------+----------+----------+-------+------------+------------+------------+\n");
+    printf("|     Ext Deg     |    Poly Inv     |  Mcycles |  Minstr  |  IPC  | L1D miss K | L2 miss K  | Br miss K  |\n");
+    printf("+-----------------+-----------------+----------+----------+-------+------------+------------+------------+\n");
+    for (int r = 0; r < num_counter_rows; r++) {
+        double *v = counter_values[r];
+        double ipc = (v[BENCH_CYCLES] > 0 && v[BENCH_INSTRUCTIONS] >= 0) ? v[BENCH_INSTRUCTIONS] / v[BENCH_CYCLES] : -1;
+        printf("| %-15d | %-15s |", EXT_DEG, counter_rows[r]);
+        print_counter(v[BENCH_CYCLES], 1e6, 8, 2);
+        print_counter(v[BENCH_INSTRUCTIONS], 1e6, 8, 2);
+        print_counter(ipc, 1, 5, 2);
+        print_counter(v[BENCH_L1D_MISSES], 1e3, 10, 1);
+        print_counter(v[BENCH_L2_MISSES], 1e3, 10, 1);
+        print_counter(v[BENCH_BRANCH_MISSES], 1e3, 10, 1);
+        printf("\n");
+        printf("+-----------------+-----------------+----------+----------+-------+------------+------------+------------+\n");
+    }
 }
 
 
@@ -73,6 +122,7 @@ int main(void)
     // Benchmarking Parameters
     bench_t bench;
     bench_init(&bench, TEST_SPEED_NUM_TESTS, NULL);    
+    printf("- CYCLES                : %s\n", bench_clock_name(&bench));
 
     // Variables
     int p = EXT_DEG;
@@ -94,6 +144,9 @@ int main(void)
     gf2x_poly_zeroize(&g);
     gf2x_poly_random_coprime(&g);
 
+    // Precomputations (i.e. the BYI schedule), out of the benchmark
+    gf2x_ctx_init(&ctx);
+
     // Print the table head
     print_table_head();
 
@@ -103,6 +156,12 @@ int main(void)
     print_table_row(&bench, "BYI");
     #endif
 
+    // EEA (variable time, for public inputs only)
+    #if TEST_SPEED_EEA
+    BENCHFUNC(bench, gf2x_mod_inv_public(&ctx, &g, &ginv));
+    print_table_row(&bench, "EEA (public)");
+    #endif
+
     // FLT
     #if TEST_SPEED_FLT
     BENCHFUNC(bench, gf2x_mod_inv_flt(&ctx, &g, &ginv));
@@ -126,7 +185,71 @@ int main(void)
     BENCHFUNC(bench, gf2x_mod_inv_sac(&ctx, &g, &ginv));
     print_table_row(&bench, "SAC");
     #endif
+
+    // The fastest method, selected (out of the benchmark) on the first use of ctx
+    #if TEST_SPEED_AUTO
+    char name[32];
+    gf2x_inv_select(&ctx);
+    snprintf(name, sizeof(name), "auto (%s)", gf2x_inv_name(ctx.inv_method));
+    BENCHFUNC(bench, gf2x_mod_inv(&ctx, &g, &ginv));
+    print_table_row(&bench, name);
+    #endif
+
+    // A batch of inversions (by the fastest method), vs single inversions
+    #if TEST_SPEED_BATCH
+    poly_t gb[TEST_SPEED_BATCH_SIZE], gbinv[TEST_SPEED_BATCH_SIZE];
+    for (int j = 0; j < TEST_SPEED_BATCH_SIZE; j++) {
+        gf2x_poly_init(&gb[j], p-1);
+        gf2x_poly_init(&gbinv[j], p-1);
+        gf2x_poly_random_coprime(&gb[j]);
+    }
+
+    snprintf(name, sizeof(name), "%d x auto", TEST_SPEED_BATCH_SIZE);
+    BENCHFUNC(bench, for (int j = 0; j < TEST_SPEED_BATCH_SIZE; j++) gf2x_mod_inv(&ctx, &gb[j], &gbinv[j]));
+    print_table_row(&bench, name);
+
+    snprintf(name, sizeof(name), "batch %d", TEST_SPEED_BATCH_SIZE);
+    BENCHFUNC(bench, gf2x_mod_inv_batch(&ctx, TEST_SPEED_BATCH_SIZE, gb, gbinv));
+    print_table_row(&bench, name);
+
+    for (int j = 0; j < TEST_SPEED_BATCH_SIZE; j++) {
+        gf2x_poly_free(&gb[j]);
+        gf2x_poly_free(&gbinv[j]);
+    }
+    #endif
+
+    // Inversions in the lanes (GF2X_LANES of CEA and SAC, and GF2X_BYI_LANES 
+    // of BYI), vs as many single inversions
+    #if TEST_SPEED_LANES
+    poly_t gl[GF2X_BYI_LANES + GF2X_LANES], glinv[GF2X_BYI_LANES + GF2X_LANES];
+    for (int j = 0; j < GF2X_BYI_LANES + GF2X_LANES; j++) {
+        gf2x_poly_init(&gl[j], p-1);
+        gf2x_poly_init(&glinv[j], p-1);
+        gf2x_poly_random_coprime(&gl[j]);
+    }
+
+    static const int lane_methods[] = { BYI, CEA, SAC };
+    for (int m = 0; m < 3; m++) {
+        int method = lane_methods[m];
+        int num = (method == BYI) ? GF2X_BYI_LANES : GF2X_LANES;
+
+        snprintf(name, sizeof(name), "%d x %s", num, gf2x_inv_name(method));
+        BENCHFUNC(bench, for (int j = 0; j < num; j++) gf2x_mod_inv_method(&ctx, method, &gl[j], &glinv[j]));
+        print_table_row(&bench, name);
+
+        snprintf(name, sizeof(name), "lanes %d %s", num, gf2x_inv_name(method));
+        BENCHFUNC(bench, gf2x_mod_inv_lanes(&ctx, method, num, gl, glinv));
+        print_table_row(&bench, name);
+    }
+
+    for (int j = 0; j < GF2X_BYI_LANES + GF2X_LANES; j++) {
+        gf2x_poly_free(&gl[j]);
+        gf2x_poly_free(&glinv[j]);
+    }
+    #endif
     
+    print_counters_table();
+
     // Free the allocated memory
     printf("\n\n");
     bench_free(&bench);